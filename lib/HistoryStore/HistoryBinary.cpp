@@ -0,0 +1,174 @@
+#include "HistoryBinary.h"
+#include "DerivedMetrics.h"
+
+static_assert(sizeof(float) == 4, "Binary history frames carry IEEE-754 float32 values");
+
+// Column stream positions before the value columns (which use the HistoryField number)
+#define COLUMN_HEADER -3
+#define COLUMN_TIME -2
+#define COLUMN_FLAGS -1
+
+void HistoryBinary::putU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+void HistoryBinary::putU32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = value >> 24;
+}
+
+void HistoryBinary::putF32(uint8_t* out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putU32(out, bits);
+}
+
+float HistoryBinary::getFieldValue(const DataPoint& dp, HistoryField field) {
+    switch (field) {
+        case HISTORY_FIELD_TEMP: return dp.temp_c;
+        case HISTORY_FIELD_ORP: return dp.orp_mv;
+        case HISTORY_FIELD_PH: return dp.ph;
+        case HISTORY_FIELD_EC: return dp.ec_ms_cm;
+        case HISTORY_FIELD_TDS: return dp.tds_ppm;
+        case HISTORY_FIELD_CO2: return dp.co2_ppm;
+        case HISTORY_FIELD_NH3_FRACTION: return dp.toxic_ammonia_ratio;
+        case HISTORY_FIELD_NH3_PPM: return dp.nh3_ppm;
+        case HISTORY_FIELD_MAX_DO: return dp.max_do_mg_l;
+        case HISTORY_FIELD_STOCKING: return dp.stocking_density;
+        default: return NAN;
+    }
+}
+
+float HistoryBinary::getRowFieldValue(const HistoryRow& row, const HistoryDerivedContext& context,
+                                      HistoryField field) {
+    if (!(row.flags & HISTORY_FLAG_VALID)) {
+        return NAN;
+    }
+
+    float temp_c = HistoryStore::decodeChannel(HISTORY_CH_TEMP, row.mean[HISTORY_CH_TEMP]);
+    float ph = HistoryStore::decodeChannel(HISTORY_CH_PH, row.mean[HISTORY_CH_PH]);
+    float ec_ms_cm = HistoryStore::decodeChannel(HISTORY_CH_EC, row.mean[HISTORY_CH_EC]);
+
+    switch (field) {
+        case HISTORY_FIELD_TEMP: return temp_c;
+        case HISTORY_FIELD_ORP: return HistoryStore::decodeChannel(HISTORY_CH_ORP, row.mean[HISTORY_CH_ORP]);
+        case HISTORY_FIELD_PH: return ph;
+        case HISTORY_FIELD_EC: return ec_ms_cm;
+        case HISTORY_FIELD_TDS: return DerivedMetrics::calculateTDS(ec_ms_cm, context.tds_factor);
+        case HISTORY_FIELD_CO2: return DerivedMetrics::calculateCO2(ph, context.kh_dkh);
+        case HISTORY_FIELD_NH3_FRACTION: return DerivedMetrics::calculateToxicAmmoniaRatio(temp_c, ph);
+        case HISTORY_FIELD_NH3_PPM:
+            return DerivedMetrics::calculateActualNH3(context.tan_ppm,
+                                                      DerivedMetrics::calculateToxicAmmoniaRatio(temp_c, ph));
+        case HISTORY_FIELD_MAX_DO: return DerivedMetrics::calculateMaxDO(temp_c);
+        case HISTORY_FIELD_STOCKING: return context.stocking_density;
+        default: return NAN;
+    }
+}
+
+size_t HistoryBinary::encodePointFrame(const DataPoint& dp, uint32_t cursor, uint8_t* buffer, size_t size) {
+    if (size < HISTORY_POINT_FRAME_SIZE) {
+        return 0;
+    }
+
+    buffer[0] = HISTORY_BINARY_VERSION;
+    buffer[1] = HISTORY_FRAME_POINT;
+    putU16(buffer + 2, HistoryStore::packFlags(dp));
+    putU32(buffer + 4, cursor);
+    putU32(buffer + 8, (uint32_t)dp.timestamp);
+
+    uint8_t* out = buffer + HISTORY_POINT_HEADER_SIZE;
+    for (int field = 0; field < HISTORY_FIELD_COUNT; field++) {
+        putF32(out, getFieldValue(dp, (HistoryField)field));
+        out += 4;
+    }
+    return HISTORY_POINT_FRAME_SIZE;
+}
+
+HistoryColumnStream::HistoryColumnStream(const HistoryStore& store, uint32_t first, uint16_t fieldMask,
+                                         uint32_t cursorBase, uint8_t headerOptions)
+    : HistoryExportStream(store),
+      derived(store.getDerivedContext()),
+      firstSequence(first),
+      rowSequence(0),
+      fields(fieldMask & HISTORY_FIELDS_ALL),
+      options(headerOptions),
+      column(COLUMN_HEADER) {
+    uint32_t oldest;
+    store.getSequenceRange(oldest, endSequence);
+    if (endSequence - firstSequence > endSequence - oldest) {
+        firstSequence = oldest;  // Evicted or never issued
+    }
+    cursor = cursorBase + endSequence;
+}
+
+size_t HistoryColumnStream::getLength() const {
+    size_t rows = getRowCount();
+    size_t valueColumns = 0;
+    for (int field = 0; field < HISTORY_FIELD_COUNT; field++) {
+        if (fields & (1 << field)) {
+            valueColumns++;
+        }
+    }
+    return HISTORY_COLUMNS_HEADER_SIZE + 4 * rows + 2 * (rows + (rows & 1)) + 4 * rows * valueColumns;
+}
+
+void HistoryColumnStream::nextColumn() {
+    column++;
+    while (column >= 0 && column < HISTORY_FIELD_COUNT && !(fields & (1 << column))) {
+        column++;
+    }
+    rowSequence = firstSequence;
+}
+
+size_t HistoryColumnStream::formatNext(char* line) {
+    uint8_t* out = (uint8_t*)line;
+
+    if (column == COLUMN_HEADER) {
+        out[0] = HISTORY_BINARY_VERSION;
+        out[1] = HISTORY_FRAME_COLUMNS;
+        HistoryBinary::putU16(out + 2, fields);
+        HistoryBinary::putU32(out + 4, getRowCount());
+        HistoryBinary::putU32(out + 8, cursor);
+        out[12] = options;
+        out[13] = 0;
+        HistoryBinary::putU16(out + 14, HISTORY_INTERVAL_MS / 1000);
+        nextColumn();
+        return HISTORY_COLUMNS_HEADER_SIZE;
+    }
+
+    // Move past finished columns (the flags column is padded to keep the next one aligned)
+    while (column < HISTORY_FIELD_COUNT && rowSequence == endSequence) {
+        bool pad = column == COLUMN_FLAGS && (getRowCount() & 1);
+        nextColumn();
+        if (pad) {
+            HistoryBinary::putU16(out, 0);
+            return 2;
+        }
+    }
+    if (column >= HISTORY_FIELD_COUNT) {
+        return 0;
+    }
+
+    size_t width = column == COLUMN_FLAGS ? 2 : 4;
+    size_t length = 0;
+    HistoryRow row;
+    while (rowSequence != endSequence && length + width <= HISTORY_EXPORT_LINE_SIZE) {
+        if (!store.readRow(rowSequence++, row)) {
+            memset(&row, 0, sizeof(row));  // Evicted mid-stream: flags 0 reads as invalid
+        }
+
+        if (column == COLUMN_TIME) {
+            HistoryBinary::putU32(out + length, row.timestamp);
+        } else if (column == COLUMN_FLAGS) {
+            HistoryBinary::putU16(out + length, row.flags);
+        } else {
+            HistoryBinary::putF32(out + length, HistoryBinary::getRowFieldValue(row, derived, (HistoryField)column));
+        }
+        length += width;
+    }
+    return length;
+}
@@ -0,0 +1,120 @@
+#ifndef HISTORY_BINARY_H
+#define HISTORY_BINARY_H
+
+#include <Arduino.h>
+#include "HistoryQuery.h"
+#include "HistoryExport.h"
+
+// Layout version carried in every binary header (bump on any layout change)
+#define HISTORY_BINARY_VERSION 1
+
+// Frame types
+#define HISTORY_FRAME_POINT 1
+#define HISTORY_FRAME_COLUMNS 2
+
+#define HISTORY_POINT_HEADER_SIZE 12
+#define HISTORY_POINT_FRAME_SIZE (HISTORY_POINT_HEADER_SIZE + 4 * HISTORY_FIELD_COUNT)
+
+#define HISTORY_COLUMNS_HEADER_SIZE 16
+
+// Column block option bits
+#define HISTORY_COLUMNS_NTP_SYNCED 0x01  // Timestamps are wall-clock time
+#define HISTORY_COLUMNS_DELTA 0x02       // Only points after the since= cursor of the request
+
+/**
+ * HistoryBinary - Fixed-layout little-endian encodings of history data
+ *
+ * Point frame (HISTORY_POINT_FRAME_SIZE = 52 bytes), one per new raw point:
+ *
+ *   offset  type     field
+ *   0       uint8    version (HISTORY_BINARY_VERSION)
+ *   1       uint8    type (HISTORY_FRAME_POINT)
+ *   2       uint16   flags (bit 0 valid, then 2-bit warning states, see HistoryStore::packFlags)
+ *   4       uint32   cursor (since= cursor that follows this point)
+ *   8       uint32   timestamp (Unix seconds)
+ *   12      float32  one value per HistoryField, in enum order (NaN = no reading)
+ *
+ * Values are written byte by byte, so the layout does not depend on the
+ * compiler's struct packing or the host's byte order.
+ */
+class HistoryBinary {
+public:
+    /**
+     * Encode a point frame
+     * @return Bytes written, 0 if the buffer is smaller than HISTORY_POINT_FRAME_SIZE
+     */
+    static size_t encodePointFrame(const DataPoint& dp, uint32_t cursor, uint8_t* buffer, size_t size);
+
+    // Value of a field in a decoded point
+    static float getFieldValue(const DataPoint& dp, HistoryField field);
+
+    /**
+     * Value of a field in an encoded row, computing only the derived metric asked for
+     * @return Same value HistoryStore::decodeRow gives, NaN for rows without the valid flag
+     */
+    static float getRowFieldValue(const HistoryRow& row, const HistoryDerivedContext& context, HistoryField field);
+
+    // Little-endian writers
+    static void putU16(uint8_t* out, uint16_t value);
+    static void putU32(uint8_t* out, uint32_t value);
+    static void putF32(uint8_t* out, float value);
+};
+
+/**
+ * HistoryColumnStream - Raw history as column blocks (/api/history.bin)
+ *
+ * One column per quantity, so a browser can wrap each one in a typed array
+ * view without parsing. Every column starts on a 4-byte boundary:
+ *
+ *   offset  type     field
+ *   0       uint8    version (HISTORY_BINARY_VERSION)
+ *   1       uint8    type (HISTORY_FRAME_COLUMNS)
+ *   2       uint16   field mask (bit n = HistoryField n has a value column)
+ *   4       uint32   row count N
+ *   8       uint32   cursor (since= cursor that follows the last row)
+ *   12      uint8    options (HISTORY_COLUMNS_NTP_SYNCED, HISTORY_COLUMNS_DELTA)
+ *   13      uint8    reserved (0)
+ *   14      uint16   interval between raw points in seconds
+ *   16      uint32   timestamp[N]
+ *           uint16   flags[N] (as in point frames), padded with 2 zero bytes when N is odd
+ *           float32  value[N] for each field in the mask, in enum order (NaN = no reading)
+ *
+ * Rows are every raw slot from the first sequence number to the newest
+ * point at construction, including gaps (flags bit 0 clear). The length is fixed up
+ * front so it can be sent as Content-Length; a row evicted while the stream
+ * is running keeps its place with timestamp 0, flags 0 and NaN values.
+ */
+class HistoryColumnStream : public HistoryExportStream {
+public:
+    /**
+     * @param store Raw history to stream
+     * @param first Sequence number of the first row (clamped to the oldest retained point)
+     * @param fields Bit mask of HistoryFields to include
+     * @param cursorBase Added to sequence numbers to form the cursor
+     * @param options HISTORY_COLUMNS_* bits for the header
+     */
+    HistoryColumnStream(const HistoryStore& store, uint32_t first, uint16_t fields,
+                        uint32_t cursorBase, uint8_t options);
+
+    uint32_t getRowCount() const { return endSequence - firstSequence; }
+
+    // Total bytes the stream produces
+    size_t getLength() const;
+
+protected:
+    size_t formatNext(char* line) override;
+
+private:
+    HistoryDerivedContext derived;  // Settings at construction, used for every row
+    uint32_t firstSequence;
+    uint32_t endSequence;
+    uint32_t rowSequence;  // Next row of the current column
+    uint32_t cursor;
+    uint16_t fields;
+    uint8_t options;
+    int8_t column;  // Header, time, flags, then a HistoryField
+
+    void nextColumn();
+};
+
+#endif // HISTORY_BINARY_H
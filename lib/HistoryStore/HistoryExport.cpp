@@ -0,0 +1,225 @@
+#include "HistoryExport.h"
+#include <stdarg.h>
+#include <math.h>
+
+// CSV output stages
+#define CSV_STAGE_HEADER 0
+#define CSV_STAGE_COLUMNS 1
+#define CSV_STAGE_ROWS 2
+
+// JSON output stages
+#define JSON_STAGE_OPEN 0
+#define JSON_STAGE_DEVICE 1
+#define JSON_STAGE_DATA 2
+#define JSON_STAGE_SUMMARY 3
+#define JSON_STAGE_DONE 4
+
+// Values printed as JSON numbers; anything else becomes null so the document stays valid
+#define JSON_NUMBER_LIMIT 1e9
+
+static const char CSV_COLUMNS[] =
+    "Timestamp,Unix_Time,Temperature_C,ORP_mV,pH,EC_mS_cm,TDS_ppm,CO2_ppm,NH3_Ratio_%,NH3_ppm,"
+    "Max_DO_mg_L,Stocking_cm_L,Temp_State,pH_State,NH3_State,ORP_State,EC_State,DO_State,Valid\r\n";
+
+static_assert(sizeof(CSV_COLUMNS) - 1 <= HISTORY_EXPORT_LINE_SIZE, "Column header must fit in one line");
+
+HistoryExportStream::HistoryExportStream(const HistoryStore& source)
+    : store(source),
+      points(0),
+      lineLength(0),
+      lineSent(0) {
+    source.getSequenceRange(nextSequence, endSequence);
+}
+
+size_t HistoryExportStream::read(uint8_t* buffer, size_t maxLen) {
+    size_t written = 0;
+    while (written < maxLen) {
+        if (lineSent >= lineLength) {
+            lineLength = formatNext(line);
+            lineSent = 0;
+            if (lineLength == 0) {
+                break;  // Export complete
+            }
+        }
+
+        size_t chunk = lineLength - lineSent;
+        if (chunk > maxLen - written) {
+            chunk = maxLen - written;
+        }
+        memcpy(buffer + written, line + lineSent, chunk);
+        lineSent += chunk;
+        written += chunk;
+    }
+    return written;
+}
+
+bool HistoryExportStream::nextPoint(DataPoint& dp) {
+    while (nextSequence != endSequence) {
+        if (!store.readPoint(nextSequence, dp)) {
+            // Evicted while the export was running - resume at the oldest retained point
+            uint32_t first, end;
+            store.getSequenceRange(first, end);
+            bool endRetained = endSequence - first <= end - first;
+            nextSequence = endRetained ? first : endSequence;  // Everything requested may be gone
+            continue;
+        }
+
+        nextSequence++;
+        if (dp.valid) {
+            points++;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t HistoryExportStream::formatLine(char* line, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, HISTORY_EXPORT_LINE_SIZE, format, args);
+    va_end(args);
+
+    if (length < 0) {
+        return 0;
+    }
+    return (size_t)length < HISTORY_EXPORT_LINE_SIZE ? (size_t)length : HISTORY_EXPORT_LINE_SIZE - 1;
+}
+
+size_t HistoryExportStream::sliceText(char* line, const String& text, size_t& sent) {
+    size_t length = text.length() - sent;
+    if (length > HISTORY_EXPORT_LINE_SIZE) {
+        length = HISTORY_EXPORT_LINE_SIZE;
+    }
+    memcpy(line, text.c_str() + sent, length);
+    sent += length;
+    return length;
+}
+
+HistoryCsvStream::HistoryCsvStream(const HistoryStore& source, const String& metadata)
+    : HistoryExportStream(source),
+      header(metadata),
+      headerSent(0),
+      stage(CSV_STAGE_HEADER) {
+}
+
+size_t HistoryCsvStream::formatNext(char* line) {
+    if (stage == CSV_STAGE_HEADER) {
+        // Metadata can be longer than a line - hand it out in line-sized slices
+        size_t length = sliceText(line, header, headerSent);
+        if (length > 0) {
+            return length;
+        }
+        header = String();  // Release before the rows are streamed
+        stage = CSV_STAGE_COLUMNS;
+    }
+
+    if (stage == CSV_STAGE_COLUMNS) {
+        stage = CSV_STAGE_ROWS;
+        memcpy(line, CSV_COLUMNS, sizeof(CSV_COLUMNS) - 1);
+        return sizeof(CSV_COLUMNS) - 1;
+    }
+
+    DataPoint dp;
+    if (!nextPoint(dp)) {
+        return 0;
+    }
+    return formatRow(dp, line);
+}
+
+size_t HistoryCsvStream::formatRow(const DataPoint& dp, char* line) {
+    char timeStr[24] = "N/A";
+    time_t ts = dp.timestamp;
+    if (ts > 100000) {
+        struct tm timeinfo;
+        localtime_r(&ts, &timeinfo);
+        strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeinfo);
+    }
+
+    return formatLine(line,
+                      "%s,%lld,%.2f,%.2f,%.2f,%.3f,%.1f,%.2f,%.2f,%.4f,%.2f,%.2f,%u,%u,%u,%u,%u,%u,true\r\n",
+                      timeStr, (long long)dp.timestamp,
+                      dp.temp_c, dp.orp_mv, dp.ph, dp.ec_ms_cm,
+                      dp.tds_ppm, dp.co2_ppm, dp.toxic_ammonia_ratio * 100.0, dp.nh3_ppm,
+                      dp.max_do_mg_l, dp.stocking_density,
+                      dp.temp_state, dp.ph_state, dp.nh3_state,
+                      dp.orp_state, dp.ec_state, dp.do_state);
+}
+
+HistoryJsonStream::HistoryJsonStream(const HistoryStore& source, const String& deviceJson)
+    : HistoryExportStream(source),
+      device(deviceJson),
+      deviceSent(0),
+      stage(JSON_STAGE_OPEN) {
+}
+
+size_t HistoryJsonStream::formatNext(char* line) {
+    switch (stage) {
+        case JSON_STAGE_OPEN:
+            stage = JSON_STAGE_DEVICE;
+            return formatLine(line, "{\"device\":");
+
+        case JSON_STAGE_DEVICE: {
+            size_t length = sliceText(line, device, deviceSent);
+            if (length > 0) {
+                return length;
+            }
+            device = String();  // Release before the points are streamed
+            stage = JSON_STAGE_DATA;
+            return formatLine(line, ",\"data\":[");
+        }
+
+        case JSON_STAGE_DATA: {
+            DataPoint dp;
+            if (nextPoint(dp)) {
+                return formatObject(dp, getPointCount() == 1, line);
+            }
+            stage = JSON_STAGE_SUMMARY;
+        }
+        // Fall through
+
+        case JSON_STAGE_SUMMARY:
+            stage = JSON_STAGE_DONE;
+            return formatLine(line, "],\"summary\":{\"total_points\":%lu}}",
+                              (unsigned long)getPointCount());
+
+        default:
+            return 0;
+    }
+}
+
+// Append "key":value with a fixed number of decimals (null if not a finite, printable number)
+static void appendNumber(char* line, size_t& length, const char* key, float value, int decimals) {
+    int written;
+    if (isfinite(value) && fabs(value) < JSON_NUMBER_LIMIT) {
+        written = snprintf(line + length, HISTORY_EXPORT_LINE_SIZE - length,
+                           ",\"%s\":%.*f", key, decimals, value);
+    } else {
+        written = snprintf(line + length, HISTORY_EXPORT_LINE_SIZE - length, ",\"%s\":null", key);
+    }
+    if (written > 0) {
+        length += written;
+    }
+}
+
+size_t HistoryJsonStream::formatObject(const DataPoint& dp, bool first, char* line) {
+    size_t length = formatLine(line, "%s{\"timestamp\":%lld", first ? "" : ",", (long long)dp.timestamp);
+
+    // Primary sensors
+    appendNumber(line, length, "temp_c", dp.temp_c, 2);
+    appendNumber(line, length, "orp_mv", dp.orp_mv, 2);
+    appendNumber(line, length, "ph", dp.ph, 2);
+    appendNumber(line, length, "ec_ms_cm", dp.ec_ms_cm, 3);
+    // Derived metrics
+    appendNumber(line, length, "tds_ppm", dp.tds_ppm, 1);
+    appendNumber(line, length, "co2_ppm", dp.co2_ppm, 2);
+    appendNumber(line, length, "nh3_ratio_pct", dp.toxic_ammonia_ratio * 100.0, 2);
+    appendNumber(line, length, "nh3_ppm", dp.nh3_ppm, 4);
+    appendNumber(line, length, "max_do_mg_l", dp.max_do_mg_l, 2);
+    appendNumber(line, length, "stocking_density", dp.stocking_density, 2);
+
+    int written = snprintf(line + length, HISTORY_EXPORT_LINE_SIZE - length, ",\"valid\":true}");
+    if (written > 0) {
+        length += written;
+    }
+    return length;
+}
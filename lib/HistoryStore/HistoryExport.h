@@ -0,0 +1,119 @@
+#ifndef HISTORY_EXPORT_H
+#define HISTORY_EXPORT_H
+
+#include <Arduino.h>
+#include "HistoryStore.h"
+
+// Longest formatted line (a CSV row is ~130 characters, a JSON object up to ~300)
+#define HISTORY_EXPORT_LINE_SIZE 320
+
+/**
+ * HistoryExportStream - Pull-based export of the raw history ring
+ *
+ * Feeds a chunked HTTP response: read() is called with whatever room the TCP
+ * send buffer has and fills it with the next part of the file. Output is
+ * produced one line at a time into a fixed line buffer; a line that does not
+ * fit is finished on the next call, so memory use is constant no matter how
+ * many points are exported.
+ *
+ * Points are tracked by sequence number (HistoryStore::getSequence), so
+ * points appended while the export is running are not included, and points
+ * evicted before they are sent are skipped instead of shifting the output.
+ */
+class HistoryExportStream {
+public:
+    explicit HistoryExportStream(const HistoryStore& store);
+    virtual ~HistoryExportStream() {}
+
+    /**
+     * Copy the next bytes of the export into buffer
+     * @return Bytes written, 0 once the export is complete
+     */
+    size_t read(uint8_t* buffer, size_t maxLen);
+
+    // Points written so far
+    uint32_t getPointCount() const { return points; }
+
+protected:
+    const HistoryStore& store;
+
+    /**
+     * Format the next line into line (at most HISTORY_EXPORT_LINE_SIZE bytes)
+     * @return Line length, 0 when there is nothing left to write
+     */
+    virtual size_t formatNext(char* line) = 0;
+
+    /**
+     * Fetch the next valid point of the export, oldest first
+     * @return false when every point up to the end of the export was read
+     */
+    bool nextPoint(DataPoint& dp);
+
+    // snprintf into line, clamped to the buffer (truncated output is still terminated)
+    static size_t formatLine(char* line, const char* format, ...);
+
+    /**
+     * Copy the next line-sized slice of text into line
+     * @return Slice length, 0 once all of text was handed out
+     */
+    static size_t sliceText(char* line, const String& text, size_t& sent);
+
+private:
+    uint32_t nextSequence;
+    uint32_t endSequence;
+    uint32_t points;
+
+    char line[HISTORY_EXPORT_LINE_SIZE];
+    size_t lineLength;
+    size_t lineSent;
+};
+
+/**
+ * HistoryCsvStream - CSV export (metadata comment block, column header, one row per valid point)
+ */
+class HistoryCsvStream : public HistoryExportStream {
+public:
+    /**
+     * @param store Raw history to export
+     * @param header Metadata comment lines written before the column header
+     */
+    HistoryCsvStream(const HistoryStore& store, const String& header);
+
+protected:
+    size_t formatNext(char* line) override;
+
+private:
+    String header;
+    size_t headerSent;
+    uint8_t stage;
+
+    static size_t formatRow(const DataPoint& dp, char* line);
+};
+
+/**
+ * HistoryJsonStream - JSON export
+ *
+ * Writes {"device": <device>, "data": [...], "summary": {...}} with one
+ * object per valid point. Numbers are printed with snprintf straight into
+ * the line buffer, so no JsonDocument or String is built per point.
+ */
+class HistoryJsonStream : public HistoryExportStream {
+public:
+    /**
+     * @param store Raw history to export
+     * @param device Serialized JSON object for the "device" section
+     */
+    HistoryJsonStream(const HistoryStore& store, const String& device);
+
+protected:
+    size_t formatNext(char* line) override;
+
+private:
+    String device;
+    size_t deviceSent;
+    uint8_t stage;
+
+    static size_t formatObject(const DataPoint& dp, bool first, char* line);
+};
+
+#endif // HISTORY_EXPORT_H
@@ -0,0 +1,246 @@
+#include "HistoryLog.h"
+
+static_assert(sizeof(HistoryLogRecord) == 32, "HistoryLogRecord must stay 32 bytes");
+static_assert(HISTORY_LOG_PAGE_SIZE % sizeof(HistoryLogRecord) == 0, "Page must hold whole records");
+
+// Bucket period of the logged tier (minutes are stored, not seconds)
+#define LOG_PERIOD_S 60
+#define LOG_MINUTE_MASK 0x00FFFFFFUL
+#define LOG_SAMPLES_SHIFT 24
+
+HistoryLog::HistoryLog()
+    : fs(nullptr),
+      firstSegment(0),
+      lastSegment(0),
+      hasSegments(false),
+      segmentRecords(0),
+      lastTimestamp(0),
+      corruptRecords(0),
+      buffered(0) {
+}
+
+uint16_t HistoryLog::crc16(const uint8_t* data, size_t length) {
+    // CRC-16/CCITT-FALSE
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+void HistoryLog::encodeRecord(const HistoryRow& row, HistoryLogRecord& record) {
+    uint32_t minutes = (row.timestamp - HISTORY_TIME_VALID_MIN) / LOG_PERIOD_S;
+    uint32_t samples = row.samples > 0xFF ? 0xFF : row.samples;
+    record.stamp = (minutes & LOG_MINUTE_MASK) | (samples << LOG_SAMPLES_SHIFT);
+    record.flags = row.flags;
+    memcpy(record.mean, row.mean, sizeof(record.mean));
+    memcpy(record.min, row.min, sizeof(record.min));
+    memcpy(record.max, row.max, sizeof(record.max));
+    record.crc = crc16((const uint8_t*)&record, offsetof(HistoryLogRecord, crc));
+}
+
+bool HistoryLog::decodeRecord(const HistoryLogRecord& record, HistoryRow& row) {
+    if (record.crc != crc16((const uint8_t*)&record, offsetof(HistoryLogRecord, crc))) {
+        return false;
+    }
+    row.samples = record.stamp >> LOG_SAMPLES_SHIFT;
+    if (row.samples == 0) {
+        return false;  // Gaps are never logged
+    }
+    row.timestamp = HISTORY_TIME_VALID_MIN + (record.stamp & LOG_MINUTE_MASK) * LOG_PERIOD_S;
+    row.flags = record.flags;
+    memcpy(row.mean, record.mean, sizeof(row.mean));
+    memcpy(row.min, record.min, sizeof(row.min));
+    memcpy(row.max, record.max, sizeof(row.max));
+    return true;
+}
+
+void HistoryLog::segmentPath(uint32_t sequence, char* path, size_t size) {
+    snprintf(path, size, HISTORY_LOG_DIR "/%08lx.log", (unsigned long)sequence);
+}
+
+bool HistoryLog::parseSegmentName(const char* name, uint32_t& sequence) {
+    if (name == nullptr) {
+        return false;
+    }
+    // Some cores return the full path, others only the file name
+    const char* slash = strrchr(name, '/');
+    const char* base = slash ? slash + 1 : name;
+    if (strlen(base) != 12 || strcmp(base + 8, ".log") != 0) {
+        return false;
+    }
+    char* end = nullptr;
+    sequence = strtoul(base, &end, 16);
+    return end == base + 8;
+}
+
+uint32_t HistoryLog::getSegmentCount() const {
+    return hasSegments ? lastSegment - firstSegment + 1 : 0;
+}
+
+bool HistoryLog::begin(fs::FS& fileSystem) {
+    fs = &fileSystem;
+    hasSegments = false;
+    buffered = 0;
+
+    if (!fs->exists(HISTORY_LOG_DIR) && !fs->mkdir(HISTORY_LOG_DIR)) {
+        Serial.println("[HistoryLog] ERROR: Cannot create " HISTORY_LOG_DIR);
+        fs = nullptr;
+        return false;
+    }
+
+    // Find the oldest and newest segment
+    File dir = fs->open(HISTORY_LOG_DIR);
+    if (!dir || !dir.isDirectory()) {
+        Serial.println("[HistoryLog] ERROR: Cannot open " HISTORY_LOG_DIR);
+        fs = nullptr;
+        return false;
+    }
+    File entry = dir.openNextFile();
+    while (entry) {
+        uint32_t sequence;
+        if (!entry.isDirectory() && parseSegmentName(entry.name(), sequence)) {
+            if (!hasSegments || sequence < firstSegment) {
+                firstSegment = sequence;
+            }
+            if (!hasSegments || sequence > lastSegment) {
+                lastSegment = sequence;
+            }
+            hasSegments = true;
+        }
+        entry = dir.openNextFile();
+    }
+    dir.close();
+
+    if (!hasSegments) {
+        firstSegment = 0;
+        lastSegment = 0;
+        segmentRecords = 0;
+        return true;
+    }
+
+    // Enforce the retention limit (e.g. after lowering HISTORY_LOG_MAX_SEGMENTS)
+    char path[32];
+    while (lastSegment - firstSegment >= HISTORY_LOG_MAX_SEGMENTS) {
+        segmentPath(firstSegment++, path, sizeof(path));
+        fs->remove(path);
+    }
+
+    segmentPath(lastSegment, path, sizeof(path));
+    File last = fs->open(path, FILE_READ);
+    size_t size = last ? last.size() : 0;
+    last.close();
+
+    segmentRecords = size / sizeof(HistoryLogRecord);
+    if (size % sizeof(HistoryLogRecord) != 0) {
+        // Torn write - keep appends record-aligned in a new segment
+        segmentRecords = HISTORY_LOG_SEGMENT_RECORDS;
+    }
+    return true;
+}
+
+uint32_t HistoryLog::replay(HistoryRowVisitor visitor, void* context) {
+    if (fs == nullptr || !hasSegments) {
+        return 0;
+    }
+
+    unsigned long started = millis();
+    uint32_t replayed = 0;
+    char path[32];
+
+    for (uint32_t sequence = firstSegment; sequence <= lastSegment; sequence++) {
+        segmentPath(sequence, path, sizeof(path));
+        File file = fs->open(path, FILE_READ);
+        if (!file) {
+            continue;
+        }
+
+        // Read a page at a time into the (still empty) write buffer
+        size_t bytes;
+        while ((bytes = file.read((uint8_t*)buffer, sizeof(buffer))) >= sizeof(HistoryLogRecord)) {
+            size_t records = bytes / sizeof(HistoryLogRecord);
+            for (size_t i = 0; i < records; i++) {
+                HistoryRow row;
+                if (!decodeRecord(buffer[i], row) || row.timestamp <= lastTimestamp) {
+                    corruptRecords++;
+                    continue;
+                }
+                lastTimestamp = row.timestamp;
+                visitor(row, context);
+                replayed++;
+            }
+            if (bytes < sizeof(buffer)) {
+                break;
+            }
+        }
+        file.close();
+        yield();
+    }
+
+    Serial.printf("[HistoryLog] Replayed %lu records from %lu segments in %lu ms (%lu skipped)\n",
+                  (unsigned long)replayed, (unsigned long)getSegmentCount(),
+                  millis() - started, (unsigned long)corruptRecords);
+    return replayed;
+}
+
+bool HistoryLog::append(const HistoryRow& row) {
+    if (fs == nullptr || row.samples == 0) {
+        return false;
+    }
+    if (row.timestamp < HISTORY_TIME_VALID_MIN || row.timestamp <= lastTimestamp) {
+        return false;  // Clock not synced yet, or bucket already logged before a reboot
+    }
+
+    encodeRecord(row, buffer[buffered++]);
+    lastTimestamp = row.timestamp;
+
+    if (buffered >= HISTORY_LOG_PAGE_RECORDS) {
+        flush();
+    }
+    return true;
+}
+
+void HistoryLog::rotate() {
+    if (hasSegments) {
+        lastSegment++;
+    }
+    hasSegments = true;
+    segmentRecords = 0;
+
+    // Drop the oldest segment once the limit is exceeded
+    char path[32];
+    while (lastSegment - firstSegment >= HISTORY_LOG_MAX_SEGMENTS) {
+        segmentPath(firstSegment++, path, sizeof(path));
+        fs->remove(path);
+    }
+}
+
+bool HistoryLog::flush() {
+    if (fs == nullptr || buffered == 0) {
+        return true;
+    }
+
+    if (!hasSegments || segmentRecords >= HISTORY_LOG_SEGMENT_RECORDS) {
+        rotate();
+    }
+
+    char path[32];
+    segmentPath(lastSegment, path, sizeof(path));
+    File file = fs->open(path, FILE_APPEND);
+    size_t bytes = buffered * sizeof(HistoryLogRecord);
+    size_t written = file ? file.write((const uint8_t*)buffer, bytes) : 0;
+    file.close();
+
+    buffered = 0;
+    if (written != bytes) {
+        Serial.printf("[HistoryLog] ERROR: Write to %s failed (%u of %u bytes)\n",
+                      path, (unsigned)written, (unsigned)bytes);
+        segmentRecords = HISTORY_LOG_SEGMENT_RECORDS;  // Continue in a fresh segment
+        return false;
+    }
+    segmentRecords += bytes / sizeof(HistoryLogRecord);
+    return true;
+}
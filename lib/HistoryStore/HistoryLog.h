@@ -0,0 +1,106 @@
+#ifndef HISTORY_LOG_H
+#define HISTORY_LOG_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "HistoryStore.h"
+
+// Directory holding the log segments on the data partition
+#define HISTORY_LOG_DIR "/hist"
+
+// Records are buffered in RAM and written in blocks of this size (4 records,
+// so a power loss or watchdog reset costs at most 4 minutes of the log)
+#define HISTORY_LOG_PAGE_SIZE 128
+
+// Records per segment file (16 KB, ~8.5 hours of 1-minute buckets)
+#define HISTORY_LOG_SEGMENT_RECORDS 512
+
+// Segments kept before the oldest is deleted (1 MB, ~22 days). Also bounds
+// the boot-time replay to HISTORY_LOG_SEGMENT_RECORDS * HISTORY_LOG_MAX_SEGMENTS records.
+#define HISTORY_LOG_MAX_SEGMENTS 64
+
+/**
+ * On-flash record: one closed 1-minute rollup bucket (32 bytes).
+ * The bucket start is stored as minutes since HISTORY_TIME_VALID_MIN so the
+ * sample count fits in the same word; the CRC covers all preceding bytes.
+ */
+struct HistoryLogRecord {
+    uint32_t stamp;  // Bits 0-23: minutes since HISTORY_TIME_VALID_MIN, bits 24-31: samples
+    uint16_t flags;
+    int16_t mean[HISTORY_CHANNEL_COUNT];
+    int16_t min[HISTORY_CHANNEL_COUNT];
+    int16_t max[HISTORY_CHANNEL_COUNT];
+    uint16_t crc;    // CRC-16/CCITT of the record without this field
+};
+
+#define HISTORY_LOG_PAGE_RECORDS (HISTORY_LOG_PAGE_SIZE / sizeof(HistoryLogRecord))
+
+/**
+ * HistoryLog - Append-only flash log of 1-minute history buckets
+ *
+ * The log is a numbered sequence of segment files (HISTORY_LOG_DIR/<seq>.log)
+ * of fixed-size records. Appends are buffered and written a page at a time;
+ * when the newest segment is full a new one is started and the oldest
+ * segment beyond HISTORY_LOG_MAX_SEGMENTS is deleted, so flash wear is spread
+ * across the partition and no file is ever rewritten.
+ *
+ * On boot replay() feeds every record that passes its CRC and is newer than
+ * the previous one back to the caller, which rebuilds the rollup tiers.
+ * Torn writes from a power loss fail the CRC (or leave a partial record) and
+ * are skipped; appends after such a segment continue in a fresh segment.
+ *
+ * Only buckets with a synced clock (>= HISTORY_TIME_VALID_MIN) are logged.
+ */
+class HistoryLog {
+public:
+    HistoryLog();
+
+    /**
+     * Attach to a mounted file system and scan the existing segments
+     * @return true if the log directory is usable
+     */
+    bool begin(fs::FS& fs);
+
+    /**
+     * Read every valid record, oldest first
+     * @return Number of records passed to the visitor
+     */
+    uint32_t replay(HistoryRowVisitor visitor, void* context);
+
+    /**
+     * Queue a closed bucket for writing (writes a page when the buffer fills)
+     * @return true if the row was queued (gaps, unsynced and old rows are ignored)
+     */
+    bool append(const HistoryRow& row);
+
+    // Write any buffered records now (e.g. before a restart)
+    bool flush();
+
+    bool isReady() const { return fs != nullptr; }
+    uint32_t getSegmentCount() const;
+    uint32_t getCorruptCount() const { return corruptRecords; }
+    uint32_t getLastTimestamp() const { return lastTimestamp; }
+
+    // Record encoding (exposed for tests)
+    static void encodeRecord(const HistoryRow& row, HistoryLogRecord& record);
+    static bool decodeRecord(const HistoryLogRecord& record, HistoryRow& row);
+
+private:
+    fs::FS* fs;
+    uint32_t firstSegment;     // Oldest segment sequence number
+    uint32_t lastSegment;      // Segment receiving appends
+    bool hasSegments;
+    uint32_t segmentRecords;   // Records already in lastSegment
+    uint32_t lastTimestamp;    // Newest logged bucket start
+    uint32_t corruptRecords;
+
+    HistoryLogRecord buffer[HISTORY_LOG_PAGE_RECORDS];
+    uint8_t buffered;
+
+    void rotate();
+    static void segmentPath(uint32_t sequence, char* path, size_t size);
+    static bool parseSegmentName(const char* name, uint32_t& sequence);
+    static uint16_t crc16(const uint8_t* data, size_t length);
+};
+
+#endif // HISTORY_LOG_H
@@ -0,0 +1,173 @@
+#include "HistoryLttb.h"
+#include "HistoryBinary.h"
+#include <math.h>
+
+static_assert(HISTORY_SIZE <= HISTORY_LTTB_MAX_ROWS && HISTORY_TIER1_BUCKETS <= HISTORY_LTTB_MAX_ROWS &&
+              HISTORY_TIER2_BUCKETS <= HISTORY_LTTB_MAX_ROWS && HISTORY_TIER3_BUCKETS <= HISTORY_LTTB_MAX_ROWS,
+              "A whole tier must fit in the LTTB scratch buffer");
+
+// First row of a bucket; bucket `buckets` is the last row alone, followed by the end of the window
+static int bucketStart(int bucket, int buckets, float bucketSize, int rowCount) {
+    if (bucket < buckets) {
+        return 1 + (int)(bucket * bucketSize);
+    }
+    return bucket == buckets ? rowCount - 1 : rowCount;
+}
+
+HistoryLttb::HistoryLttb(const TieredHistory& source)
+    : history(source), tier(0), firstSequence(0), rowCount(0) {
+}
+
+void HistoryLttb::pickValid(int offset, uint16_t fields, const HistoryDerivedContext& context) {
+    HistoryRow row;
+    if (!readRow(offset, row)) {
+        return;
+    }
+    for (int field = 0; field < HISTORY_FIELD_COUNT; field++) {
+        if ((fields & (1 << field)) &&
+            isfinite(HistoryBinary::getRowFieldValue(row, context, (HistoryField)field))) {
+            picks[offset] |= 1 << field;
+        }
+    }
+}
+
+uint32_t HistoryLttb::select(int tierIndex, uint32_t first, uint32_t end, uint16_t fields, uint16_t maxPoints,
+                             const HistoryDerivedContext& context) {
+    tier = tierIndex;
+    int32_t rows = (int32_t)(end - first);
+    if (rows > HISTORY_LTTB_MAX_ROWS) {
+        first = end - HISTORY_LTTB_MAX_ROWS;
+        rows = HISTORY_LTTB_MAX_ROWS;
+    }
+    firstSequence = first;
+    rowCount = rows > 0 ? rows : 0;
+    memset(picks, 0, sizeof(picks));
+    if (maxPoints < HISTORY_LTTB_MIN_POINTS) {
+        maxPoints = HISTORY_LTTB_MIN_POINTS;
+    }
+
+    if (rowCount <= maxPoints) {
+        for (int i = 0; i < rowCount; i++) {
+            pickValid(i, fields, context);
+        }
+    } else {
+        // Point kept in the previous bucket, per field
+        float keptX[HISTORY_FIELD_COUNT];
+        float keptY[HISTORY_FIELD_COUNT];
+        bool kept[HISTORY_FIELD_COUNT];
+
+        HistoryRow row;
+        bool firstRead = readRow(0, row);
+        uint32_t origin = firstRead ? row.timestamp : 0;  // x is seconds since the first row
+        for (int field = 0; field < HISTORY_FIELD_COUNT; field++) {
+            keptX[field] = 0;
+            keptY[field] = firstRead ? HistoryBinary::getRowFieldValue(row, context, (HistoryField)field) : NAN;
+            kept[field] = (fields & (1 << field)) && isfinite(keptY[field]);
+            if (kept[field]) {
+                picks[0] |= 1 << field;
+            }
+        }
+
+        // Rows 1 .. rowCount - 2 in equal buckets; the last bucket looks ahead to the last row
+        int buckets = maxPoints - 2;
+        float bucketSize = (float)(rowCount - 2) / buckets;
+        for (int bucket = 0; bucket < buckets; bucket++) {
+            int start = bucketStart(bucket, buckets, bucketSize, rowCount);
+            int stop = bucketStart(bucket + 1, buckets, bucketSize, rowCount);
+            int nextStop = bucketStart(bucket + 2, buckets, bucketSize, rowCount);
+
+            // Average of the next bucket
+            float sumX[HISTORY_FIELD_COUNT] = {};
+            float sumY[HISTORY_FIELD_COUNT] = {};
+            int samples[HISTORY_FIELD_COUNT] = {};
+            for (int i = stop; i < nextStop; i++) {
+                if (!readRow(i, row)) {
+                    continue;
+                }
+                float x = (float)(row.timestamp - origin);
+                for (int field = 0; field < HISTORY_FIELD_COUNT; field++) {
+                    if (!(fields & (1 << field))) {
+                        continue;
+                    }
+                    float y = HistoryBinary::getRowFieldValue(row, context, (HistoryField)field);
+                    if (isfinite(y)) {
+                        sumX[field] += x;
+                        sumY[field] += y;
+                        samples[field]++;
+                    }
+                }
+            }
+
+            // Candidate with the largest triangle (twice the area; only the order matters)
+            float bestArea[HISTORY_FIELD_COUNT];
+            float bestX[HISTORY_FIELD_COUNT];
+            float bestY[HISTORY_FIELD_COUNT];
+            int best[HISTORY_FIELD_COUNT];
+            for (int field = 0; field < HISTORY_FIELD_COUNT; field++) {
+                best[field] = -1;
+                bestArea[field] = -1;
+            }
+            for (int i = start; i < stop; i++) {
+                if (!readRow(i, row)) {
+                    continue;
+                }
+                float x = (float)(row.timestamp - origin);
+                for (int field = 0; field < HISTORY_FIELD_COUNT; field++) {
+                    if (!(fields & (1 << field))) {
+                        continue;
+                    }
+                    float y = HistoryBinary::getRowFieldValue(row, context, (HistoryField)field);
+                    if (!isfinite(y)) {
+                        continue;
+                    }
+
+                    float area = 0;
+                    if (kept[field] && samples[field] > 0) {
+                        float ax = keptX[field];
+                        float ay = keptY[field];
+                        float cx = sumX[field] / samples[field];
+                        float cy = sumY[field] / samples[field];
+                        area = fabsf((ax - cx) * (y - ay) - (ax - x) * (cy - ay));
+                    }
+                    if (area > bestArea[field]) {
+                        bestArea[field] = area;
+                        best[field] = i;
+                        bestX[field] = x;
+                        bestY[field] = y;
+                    }
+                }
+            }
+
+            for (int field = 0; field < HISTORY_FIELD_COUNT; field++) {
+                if (best[field] >= 0) {
+                    picks[best[field]] |= 1 << field;
+                    keptX[field] = bestX[field];
+                    keptY[field] = bestY[field];
+                    kept[field] = true;
+                }
+            }
+        }
+
+        pickValid(rowCount - 1, fields, context);
+    }
+
+    uint32_t picked = 0;
+    for (int i = 0; i < rowCount; i++) {
+        if (picks[i]) {
+            picked++;
+        }
+    }
+    return picked;
+}
+
+uint32_t HistoryLttb::run(HistoryPickVisitor visitor, void* context) const {
+    uint32_t visited = 0;
+    HistoryRow row;
+    for (int i = 0; i < rowCount; i++) {
+        if (picks[i] && readRow(i, row)) {
+            visitor(row, picks[i], context);
+            visited++;
+        }
+    }
+    return visited;
+}
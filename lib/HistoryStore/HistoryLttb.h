@@ -0,0 +1,64 @@
+#ifndef HISTORY_LTTB_H
+#define HISTORY_LTTB_H
+
+#include <Arduino.h>
+#include "HistoryQuery.h"
+
+// Largest window the selection covers (rows of the largest tier)
+#define HISTORY_LTTB_MAX_ROWS 2160
+
+// Fewest points per series (first, last and one bucket)
+#define HISTORY_LTTB_MIN_POINTS 3
+
+// Receives a picked row and the fields that picked it
+typedef void (*HistoryPickVisitor)(const HistoryRow& row, uint16_t fields, void* context);
+
+/**
+ * HistoryLttb - Largest-Triangle-Three-Buckets downsampling of a tier window
+ *
+ * Every field is downsampled on its own: the first and last rows are kept,
+ * the rows between are split into maxPoints - 2 equal buckets, and each
+ * bucket keeps the row forming the largest triangle with the row kept in the
+ * previous bucket and the average of the next bucket. Peaks and dips survive,
+ * unlike with bucket means.
+ *
+ * All fields advance through the buckets together, so each row is read
+ * twice (once as a candidate, once for the next bucket's average) however
+ * many fields are selected. Picks are kept as one field mask per row in a
+ * fixed scratch buffer; run() then visits the picked rows in time order.
+ * Rows are addressed by tier sequence number, so points added meanwhile do
+ * not shift the window; a row evicted meanwhile counts as having no values.
+ */
+class HistoryLttb {
+public:
+    explicit HistoryLttb(const TieredHistory& history);
+
+    /**
+     * Pick at most maxPoints rows per field among sequence numbers [first, end) of a tier
+     * (only the newest HISTORY_LTTB_MAX_ROWS rows of a larger window are used)
+     * @return Number of distinct rows picked
+     */
+    uint32_t select(int tier, uint32_t first, uint32_t end, uint16_t fields, uint16_t maxPoints,
+                    const HistoryDerivedContext& context);
+
+    /**
+     * Visit the picked rows oldest first
+     * @return Number of rows visited
+     */
+    uint32_t run(HistoryPickVisitor visitor, void* context) const;
+
+private:
+    const TieredHistory& history;
+    int tier;
+    uint32_t firstSequence;
+    int rowCount;
+    uint16_t picks[HISTORY_LTTB_MAX_ROWS];  // Fields that picked each row of the window
+
+    // Mark the fields that have a value in a row (first/last row, or no downsampling needed)
+    void pickValid(int offset, uint16_t fields, const HistoryDerivedContext& context);
+
+    // Row at an offset into the window (false if evicted)
+    bool readRow(int offset, HistoryRow& row) const { return history.readRow(tier, firstSequence + offset, row); }
+};
+
+#endif // HISTORY_LTTB_H
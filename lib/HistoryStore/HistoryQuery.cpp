@@ -0,0 +1,213 @@
+#include "HistoryQuery.h"
+#include "HistoryRollup.h"
+
+static const char* const FIELD_NAMES[HISTORY_FIELD_COUNT] = {
+    "temp", "orp", "ph", "ec", "tds", "co2", "nh3_fraction", "nh3_ppm", "max_do", "stocking"
+};
+
+HistoryQuery::HistoryQuery(const TieredHistory& source)
+    : history(source),
+      from(0),
+      to(UINT32_MAX),
+      requestedStep(0),
+      requestedTier(-1),
+      maxPoints(UINT16_MAX),
+      fields(HISTORY_FIELDS_ALL),
+      tier(0),
+      step(0),
+      firstSequence(0),
+      endSequence(0) {
+}
+
+void HistoryQuery::setWindow(uint32_t windowFrom, uint32_t windowTo) {
+    from = windowFrom;
+    to = windowTo;
+}
+
+const char* HistoryQuery::getFieldName(HistoryField field) {
+    return field < HISTORY_FIELD_COUNT ? FIELD_NAMES[field] : "";
+}
+
+uint16_t HistoryQuery::parseFields(const char* list) {
+    if (list == nullptr) {
+        return 0;
+    }
+
+    uint16_t mask = 0;
+    const char* start = list;
+    while (true) {
+        const char* end = strchr(start, ',');
+        size_t length = end ? (size_t)(end - start) : strlen(start);
+
+        int match = -1;
+        for (int i = 0; i < HISTORY_FIELD_COUNT; i++) {
+            if (strlen(FIELD_NAMES[i]) == length && strncmp(FIELD_NAMES[i], start, length) == 0) {
+                match = i;
+                break;
+            }
+        }
+        if (match < 0) {
+            return 0;  // Unknown or empty name
+        }
+        mask |= 1 << match;
+
+        if (end == nullptr) {
+            return mask;
+        }
+        start = end + 1;
+    }
+}
+
+// Binary search over sequence numbers; a row evicted during the search counts as older than any time
+uint32_t HistoryQuery::search(const TieredHistory& history, int tier, uint32_t timestamp, bool inclusive) {
+    uint32_t low, high;
+    history.getSequenceRange(tier, low, high);
+    while (low != high) {
+        uint32_t mid = low + (high - low) / 2;
+        uint32_t time;
+        bool before = !history.readRowTime(tier, mid, time) || time < timestamp ||
+                      (inclusive && time == timestamp);
+        if (before) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+uint32_t HistoryQuery::lowerBound(const TieredHistory& history, int tier, uint32_t timestamp) {
+    return search(history, tier, timestamp, false);
+}
+
+uint32_t HistoryQuery::upperBound(const TieredHistory& history, int tier, uint32_t timestamp) {
+    return search(history, tier, timestamp, true);
+}
+
+bool HistoryQuery::getOldestTime(const TieredHistory& history, int tier, uint32_t& timestamp) {
+    uint32_t first, end;
+    history.getSequenceRange(tier, first, end);
+    return end != first && history.readRowTime(tier, first, timestamp);
+}
+
+/**
+ * A tier can serve the window if its data reaches back to the start of the
+ * window, or if no coarser tier holds meaningfully older data (e.g. shortly
+ * after boot every tier starts at the same time). Slack allows for the raw
+ * ring evicting a whole block and rollup buckets starting before their data.
+ */
+bool HistoryQuery::tierCovers(int candidate) const {
+    uint32_t oldest;
+    if (!getOldestTime(history, candidate, oldest)) {
+        return false;
+    }
+
+    uint32_t slack = candidate == 0 ? HISTORY_BLOCK_SIZE * history.getTierPeriod(0)
+                                    : history.getTierPeriod(candidate);
+    if (oldest <= from + slack || from + slack < from) {
+        return true;
+    }
+
+    for (int coarser = candidate + 1; coarser < HISTORY_TIER_COUNT; coarser++) {
+        uint32_t coarserOldest;
+        if (getOldestTime(history, coarser, coarserOldest) &&
+            coarserOldest + history.getTierPeriod(coarser) + slack < oldest) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HistoryQuery::prepare() {
+    firstSequence = 0;
+    endSequence = 0;
+
+    if (requestedTier >= 0 && requestedTier < HISTORY_TIER_COUNT) {
+        tier = requestedTier;
+    } else {
+        // Finest usable tier, then coarser ones if the step is a multiple of their period
+        tier = -1;
+        for (int candidate = 0; candidate < HISTORY_TIER_COUNT; candidate++) {
+            if (!tierCovers(candidate)) {
+                continue;
+            }
+            uint32_t period = history.getTierPeriod(candidate);
+            if (tier < 0 || (requestedStep >= period && requestedStep % period == 0)) {
+                tier = candidate;
+            } else {
+                break;
+            }
+        }
+        if (tier < 0) {
+            tier = 0;  // No data anywhere
+        }
+    }
+
+    // Step is a whole number of tier periods
+    uint32_t period = history.getTierPeriod(tier);
+    step = requestedStep > period ? requestedStep : period;
+    step = (step + period - 1) / period * period;
+
+    if (from > to) {
+        return false;
+    }
+
+    // Widen the step until the aligned buckets fit in maxPoints
+    uint32_t span = to - from;
+    if (span / step + 2 > maxPoints) {
+        uint32_t minimum = span / maxPoints + 1;
+        step = (minimum + period - 1) / period * period;
+        while ((to - (from - from % step)) / step + 1 > maxPoints) {
+            step += period;
+        }
+    }
+
+    firstSequence = lowerBound(history, tier, from);
+    endSequence = upperBound(history, tier, to);
+    if ((int32_t)(endSequence - firstSequence) < 0) {
+        endSequence = firstSequence;  // Clock step inside the window
+    }
+    return true;
+}
+
+uint32_t HistoryQuery::run(HistoryRowVisitor visitor, void* context) const {
+    uint32_t emitted = 0;
+    HistoryAccumulator bucket;
+    uint32_t currentBucket = 0;
+    bool open = false;
+
+    // Aggregated rows are stamped with the bucket start, plain rows keep their own time
+    bool aggregated = isAggregated();
+
+    for (uint32_t sequence = firstSequence; sequence != endSequence; sequence++) {
+        HistoryRow row;
+        if (!history.readRow(tier, sequence, row)) {
+            continue;  // Evicted since prepare()
+        }
+        uint32_t bucketStart = row.timestamp - row.timestamp % step;
+
+        if (open && bucketStart != currentBucket) {
+            if (bucket.getSamples() > 0) {
+                HistoryRow merged;
+                bucket.get(merged);
+                visitor(merged, context);
+                emitted++;
+            }
+            open = false;
+        }
+        if (!open) {
+            bucket.reset(aggregated ? bucketStart : row.timestamp);
+            currentBucket = bucketStart;
+            open = true;
+        }
+        bucket.add(row);
+    }
+
+    if (open && bucket.getSamples() > 0) {
+        HistoryRow merged;
+        bucket.get(merged);
+        visitor(merged, context);
+        emitted++;
+    }
+    return emitted;
+}
@@ -0,0 +1,118 @@
+#ifndef HISTORY_QUERY_H
+#define HISTORY_QUERY_H
+
+#include <Arduino.h>
+#include "TieredHistory.h"
+
+// Fields selectable with fields= (primary fields share the HistoryChannel index)
+enum HistoryField {
+    HISTORY_FIELD_TEMP = 0,
+    HISTORY_FIELD_ORP = 1,
+    HISTORY_FIELD_PH = 2,
+    HISTORY_FIELD_EC = 3,
+    HISTORY_FIELD_TDS = 4,
+    HISTORY_FIELD_CO2 = 5,
+    HISTORY_FIELD_NH3_FRACTION = 6,
+    HISTORY_FIELD_NH3_PPM = 7,
+    HISTORY_FIELD_MAX_DO = 8,
+    HISTORY_FIELD_STOCKING = 9,
+    HISTORY_FIELD_COUNT = 10
+};
+
+#define HISTORY_FIELDS_ALL ((uint16_t)((1 << HISTORY_FIELD_COUNT) - 1))
+
+/**
+ * HistoryQuery - Time-window query over TieredHistory
+ *
+ * prepare() picks the finest tier whose data reaches back to the start of
+ * the window and binary-searches the window bounds on the tier's timestamps,
+ * so the cost of run() depends only on the rows inside the window. Rows are
+ * merged into step-sized buckets aligned to multiples of the step (min/max
+ * over the bucket, sample-weighted mean), and the step is widened if the
+ * window would otherwise produce more than the maximum number of points.
+ *
+ * Timestamps are ascending in every tier. The raw tier can step back when
+ * the clock is corrected; the search then finds one of the matching runs.
+ *
+ * The window is held as tier sequence numbers, so rows added or evicted by
+ * the main loop between prepare() and run() do not shift it; run() skips
+ * rows evicted meanwhile.
+ */
+class HistoryQuery {
+public:
+    explicit HistoryQuery(const TieredHistory& history);
+
+    // Inclusive window in Unix seconds
+    void setWindow(uint32_t from, uint32_t to);
+
+    // Bucket width in seconds (0 = tier resolution)
+    void setStep(uint32_t step_s) { requestedStep = step_s; }
+
+    // Force a tier instead of choosing by coverage (-1 = automatic)
+    void setTier(int tier) { requestedTier = tier; }
+
+    void setMaxPoints(uint16_t points) { maxPoints = points > 0 ? points : 1; }
+
+    // Bit mask of HistoryFields to return
+    void setFields(uint16_t mask) { fields = mask; }
+    uint16_t getFields() const { return fields; }
+    bool hasField(HistoryField field) const { return (fields & (1 << field)) != 0; }
+
+    /**
+     * Choose the tier and step and locate the window
+     * @return false if the window is empty (from > to)
+     */
+    bool prepare();
+
+    /**
+     * Emit one merged row per step bucket that has samples, oldest first
+     * @return Number of rows emitted
+     */
+    uint32_t run(HistoryRowVisitor visitor, void* context) const;
+
+    int getTier() const { return tier; }
+    uint32_t getStep() const { return step; }
+    uint32_t getFrom() const { return from; }
+    uint32_t getTo() const { return to; }
+
+    // Rows of the selected tier inside the window, by sequence number: [getFirstSequence(), getEndSequence())
+    int getRowCount() const { return (int)(endSequence - firstSequence); }
+    uint32_t getFirstSequence() const { return firstSequence; }
+    uint32_t getEndSequence() const { return endSequence; }
+
+    // True when emitted rows summarize more than one stored row (min/max meaningful)
+    bool isAggregated() const { return tier > 0 || step > history.getTierPeriod(0); }
+
+    /**
+     * Parse a comma separated field list such as "temp,ph"
+     * @return Field mask, or 0 if the list is empty or names an unknown field
+     */
+    static uint16_t parseFields(const char* list);
+
+    // JSON name of a field ("temp", "nh3_ppm", ...)
+    static const char* getFieldName(HistoryField field);
+
+    // First sequence number in a tier with time >= timestamp / > timestamp
+    static uint32_t lowerBound(const TieredHistory& history, int tier, uint32_t timestamp);
+    static uint32_t upperBound(const TieredHistory& history, int tier, uint32_t timestamp);
+
+private:
+    const TieredHistory& history;
+    uint32_t from;
+    uint32_t to;
+    uint32_t requestedStep;
+    int requestedTier;
+    uint16_t maxPoints;
+    uint16_t fields;
+
+    int tier;
+    uint32_t step;
+    uint32_t firstSequence;
+    uint32_t endSequence;
+
+    bool tierCovers(int candidate) const;
+    static uint32_t search(const TieredHistory& history, int tier, uint32_t timestamp, bool inclusive);
+    static bool getOldestTime(const TieredHistory& history, int tier, uint32_t& timestamp);
+};
+
+#endif // HISTORY_QUERY_H
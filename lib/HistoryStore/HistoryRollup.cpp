@@ -0,0 +1,244 @@
+#include "HistoryRollup.h"
+
+// ============================================================================
+// HistoryAccumulator
+// ============================================================================
+
+void HistoryAccumulator::reset(uint32_t timestamp) {
+    start = timestamp;
+    samples = 0;
+    flags = 0;
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        sum[ch] = 0;
+        weight[ch] = 0;
+        min[ch] = INT16_MAX;
+        max[ch] = INT16_MIN;
+    }
+}
+
+void HistoryAccumulator::add(const HistoryRow& row) {
+    if (row.samples == 0) {
+        return;  // Gap
+    }
+
+    samples = (samples > UINT16_MAX - row.samples) ? UINT16_MAX : samples + row.samples;
+    flags |= HISTORY_FLAG_VALID;
+
+    // Worst state per 2-bit field
+    for (uint8_t shift = 1; shift <= 11; shift += 2) {
+        uint16_t mask = 0x03 << shift;
+        if ((row.flags & mask) > (flags & mask)) {
+            flags = (flags & ~mask) | (row.flags & mask);
+        }
+    }
+
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        if (row.mean[ch] == HISTORY_VALUE_NONE) {
+            continue;
+        }
+        sum[ch] += (int64_t)row.mean[ch] * row.samples;
+        weight[ch] += row.samples;
+        if (row.min[ch] < min[ch]) {
+            min[ch] = row.min[ch];
+        }
+        if (row.max[ch] > max[ch]) {
+            max[ch] = row.max[ch];
+        }
+    }
+}
+
+void HistoryAccumulator::get(HistoryRow& row) const {
+    row.timestamp = start;
+    row.samples = samples;
+    row.flags = flags;
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        if (weight[ch] == 0) {
+            row.mean[ch] = HISTORY_VALUE_NONE;
+            row.min[ch] = HISTORY_VALUE_NONE;
+            row.max[ch] = HISTORY_VALUE_NONE;
+            continue;
+        }
+        // Round half away from zero
+        int64_t half = weight[ch] / 2;
+        row.mean[ch] = (int16_t)((sum[ch] + (sum[ch] >= 0 ? half : -half)) / (int64_t)weight[ch]);
+        row.min[ch] = min[ch];
+        row.max[ch] = max[ch];
+    }
+}
+
+// ============================================================================
+// RollupTier
+// ============================================================================
+
+RollupTier::RollupTier(uint32_t period_s, uint16_t bucketCapacity)
+    : buckets(new Bucket[bucketCapacity]),
+      period(period_s),
+      capacity(bucketCapacity),
+      head(0),
+      count(0),
+      appended(0),
+      hasOpen(false) {
+}
+
+RollupTier::~RollupTier() {
+    delete[] buckets;
+}
+
+void RollupTier::clear() {
+    writes.beginWrite();
+    reset();
+    writes.endWrite();
+}
+
+void RollupTier::reset() {
+    if (hasOpen) {
+        appended++;  // Retire the open bucket's sequence number
+    }
+    head = 0;
+    count = 0;
+    hasOpen = false;
+}
+
+bool RollupTier::add(const HistoryRow& row, HistoryRow* closed) {
+    uint32_t bucketStart = row.timestamp - row.timestamp % period;
+    bool closedBucket = false;
+
+    if (hasOpen && bucketStart < open.getStart()) {
+        return false;  // Clock stepped back - drop until it catches up
+    }
+
+    writes.beginWrite();
+    if (hasOpen && bucketStart != open.getStart()) {
+
+        if (open.getSamples() > 0) {
+            closedBucket = true;
+            if (closed != nullptr) {
+                open.get(*closed);
+            }
+        }
+
+        uint32_t skipped = (bucketStart - open.getStart()) / period - 1;
+        if (skipped >= capacity) {
+            // Gap longer than the whole tier (e.g. NTP sync after boot)
+            reset();
+        } else {
+            closeOpenBucket();
+            for (uint32_t i = 0; i < skipped; i++) {
+                pushEmpty();
+            }
+        }
+    }
+
+    if (!hasOpen || bucketStart != open.getStart()) {
+        open.reset(bucketStart);
+        hasOpen = true;
+    }
+    open.add(row);
+    writes.endWrite();
+    return closedBucket;
+}
+
+void RollupTier::closeOpenBucket() {
+    HistoryRow row;
+    open.get(row);
+
+    Bucket& bucket = buckets[head];
+    bucket.samples = row.samples;
+    bucket.flags = row.flags;
+    memcpy(bucket.mean, row.mean, sizeof(bucket.mean));
+    memcpy(bucket.min, row.min, sizeof(bucket.min));
+    memcpy(bucket.max, row.max, sizeof(bucket.max));
+
+    head = (head + 1) % capacity;
+    if (count < capacity) {
+        count++;
+    }
+    appended++;
+}
+
+void RollupTier::pushEmpty() {
+    Bucket& bucket = buckets[head];
+    bucket.samples = 0;
+    bucket.flags = 0;
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        bucket.mean[ch] = HISTORY_VALUE_NONE;
+        bucket.min[ch] = HISTORY_VALUE_NONE;
+        bucket.max[ch] = HISTORY_VALUE_NONE;
+    }
+
+    head = (head + 1) % capacity;
+    if (count < capacity) {
+        count++;
+    }
+    appended++;
+}
+
+int RollupTier::getCount() const {
+    uint32_t token;
+    int buckets;
+    do {
+        token = writes.readBegin();
+        buckets = count + (hasOpen ? 1 : 0);
+    } while (writes.readRetry(token));
+    return buckets;
+}
+
+uint32_t RollupTier::timeAt(int index) const {
+    while (true) {
+        uint32_t token = writes.readBegin();
+        // Closed buckets are contiguous and end where the open bucket starts
+        uint32_t timestamp = open.getStart() - (uint32_t)(count - index) * period;
+        if (!writes.readRetry(token)) {
+            return timestamp;
+        }
+    }
+}
+
+void RollupTier::at(int index, HistoryRow& row) const {
+    uint32_t token;
+    do {
+        token = writes.readBegin();
+        copyBucket(index, row);
+    } while (writes.readRetry(token));
+}
+
+void RollupTier::getSequenceRange(uint32_t& first, uint32_t& end) const {
+    uint32_t token;
+    do {
+        token = writes.readBegin();
+        first = appended - (uint32_t)count;
+        end = appended + (hasOpen ? 1 : 0);
+    } while (writes.readRetry(token));
+}
+
+bool RollupTier::readRow(uint32_t sequence, HistoryRow& row) const {
+    while (true) {
+        uint32_t token = writes.readBegin();
+        uint32_t behind = appended - sequence;  // Wraps to a huge value for future sequences
+        int index = count - (int)behind;
+        bool found = behind <= (uint32_t)count && (index < count || hasOpen);
+        if (found) {
+            copyBucket(index, row);
+        }
+        if (!writes.readRetry(token)) {
+            return found;
+        }
+    }
+}
+
+// Copy a bucket by chronological index (inside a read section or on the writer)
+void RollupTier::copyBucket(int index, HistoryRow& row) const {
+    if (index == count) {
+        open.get(row);
+        return;
+    }
+
+    int slot = (head - count + index + capacity) % capacity;
+    const Bucket& bucket = buckets[slot];
+    row.timestamp = open.getStart() - (uint32_t)(count - index) * period;
+    row.samples = bucket.samples;
+    row.flags = bucket.flags;
+    memcpy(row.mean, bucket.mean, sizeof(row.mean));
+    memcpy(row.min, bucket.min, sizeof(row.min));
+    memcpy(row.max, bucket.max, sizeof(row.max));
+}
@@ -0,0 +1,128 @@
+#ifndef HISTORY_ROLLUP_H
+#define HISTORY_ROLLUP_H
+
+#include <Arduino.h>
+#include "HistoryStore.h"
+#include "SeqLock.h"
+
+/**
+ * HistoryAccumulator - Incremental min/max/mean over HistoryRows
+ *
+ * add() is O(1). Means are weighted by each row's sample count, so merging
+ * rollup buckets gives the same mean as averaging the raw points. Flags
+ * keep the worst (highest) warning state seen for each sensor.
+ */
+class HistoryAccumulator {
+public:
+    HistoryAccumulator() { reset(0); }
+
+    // Start a new summary beginning at the given time
+    void reset(uint32_t timestamp);
+
+    void add(const HistoryRow& row);
+
+    // Summary of everything added since reset()
+    void get(HistoryRow& row) const;
+
+    uint16_t getSamples() const { return samples; }
+    uint32_t getStart() const { return start; }
+
+private:
+    uint32_t start;
+    uint16_t samples;
+    uint16_t flags;
+    int64_t sum[HISTORY_CHANNEL_COUNT];
+    uint32_t weight[HISTORY_CHANNEL_COUNT];
+    int16_t min[HISTORY_CHANNEL_COUNT];
+    int16_t max[HISTORY_CHANNEL_COUNT];
+};
+
+/**
+ * RollupTier - Round-robin ring of fixed-period min/max/mean buckets
+ *
+ * Buckets are aligned to multiples of the period and contiguous in time, so
+ * a bucket's start time follows from its position and is not stored (28
+ * bytes per bucket). Each raw point is folded into the open bucket in O(1);
+ * when a point falls into a later period the open bucket is closed into the
+ * ring and any skipped periods are recorded as empty buckets.
+ *
+ * at() includes the partially filled open bucket as the newest entry, so
+ * coarse tiers still show the latest data.
+ *
+ * As in HistoryStore, add() and clear() run on the main loop while HTTP
+ * handlers read: the open bucket changes with every point, so writes are
+ * bracketed by a SeqCount and every read copies inside a retried read
+ * section. Every bucket also has a sequence number (the open bucket keeps
+ * its number when it is closed, a bucket dropped by clear() retires its
+ * number), so readers walking the tier over several calls keep a sequence
+ * as their cursor and use readRow(), which skips buckets evicted meanwhile.
+ */
+class RollupTier {
+public:
+    RollupTier(uint32_t period_s, uint16_t capacity);
+    ~RollupTier();
+
+    /**
+     * Fold a row into the open bucket
+     * @param closed If not null, receives the previous open bucket when the
+     *               row starts a new period and that bucket had samples
+     * @return true if a bucket with samples was closed (written to closed)
+     */
+    bool add(const HistoryRow& row, HistoryRow* closed = nullptr);
+    void clear();
+
+    // Buckets available, including the open one
+    int getCount() const;
+
+    // Bucket at a chronological index (0 = oldest)
+    void at(int index, HistoryRow& row) const;
+
+    // Start time of the bucket at a chronological index
+    uint32_t timeAt(int index) const;
+
+    // Oldest retained and one past the newest sequence number (the open bucket is end - 1)
+    void getSequenceRange(uint32_t& first, uint32_t& end) const;
+
+    /**
+     * Copy the bucket with a sequence number
+     * @return false if the bucket was evicted or does not exist yet
+     */
+    bool readRow(uint32_t sequence, HistoryRow& row) const;
+
+    uint32_t getPeriod() const { return period; }
+    uint16_t getCapacity() const { return capacity; }
+    uint32_t getSpan() const { return period * capacity; }
+
+    size_t getStorageBytes() const { return sizeof(Bucket) * capacity; }
+
+private:
+    struct Bucket {
+        uint16_t samples;
+        uint16_t flags;
+        int16_t mean[HISTORY_CHANNEL_COUNT];
+        int16_t min[HISTORY_CHANNEL_COUNT];
+        int16_t max[HISTORY_CHANNEL_COUNT];
+    };
+
+    Bucket* buckets;
+    uint32_t period;
+    uint16_t capacity;
+    int head;    // Next bucket to write
+    int count;   // Closed buckets in the ring
+    uint32_t appended;  // Buckets closed into the ring (or retired) since construction
+
+    HistoryAccumulator open;  // Bucket being filled
+    bool hasOpen;
+
+    SeqCount writes;  // Guards the ring, the open bucket and the positions above
+
+    void reset();
+    void closeOpenBucket();
+    void pushEmpty();
+    void copyBucket(int index, HistoryRow& row) const;
+
+    RollupTier(const RollupTier&) = delete;
+    RollupTier& operator=(const RollupTier&) = delete;
+};
+
+#endif // HISTORY_ROLLUP_H
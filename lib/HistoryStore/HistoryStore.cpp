@@ -0,0 +1,226 @@
+#include "HistoryStore.h"
+#include "DerivedMetrics.h"
+
+static_assert(HISTORY_SIZE % HISTORY_BLOCK_SIZE == 0, "HISTORY_SIZE must be a multiple of HISTORY_BLOCK_SIZE");
+
+// Bit position of each warning state in the flag word
+#define STATE_SHIFT_TEMP 1
+#define STATE_SHIFT_PH   3
+#define STATE_SHIFT_NH3  5
+#define STATE_SHIFT_ORP  7
+#define STATE_SHIFT_EC   9
+#define STATE_SHIFT_DO  11
+
+// Fixed-point scale per HistoryChannel (encoded units per engineering unit)
+static const float CHANNEL_SCALE[HISTORY_CHANNEL_COUNT] = {
+    100.0,   // Temperature: 0.01 °C
+    10.0,    // ORP: 0.1 mV
+    1000.0,  // pH: 0.001
+    500.0    // EC: 0.002 mS/cm
+};
+
+HistoryStore::HistoryStore() : head(0), tail(0), count(0), appended(0) {
+    HistoryDerivedContext context;
+    context.tds_factor = 0.64;
+    context.kh_dkh = 4.0;
+    context.tan_ppm = 0.0;
+    context.stocking_density = 0.0;
+    derived.write(context);
+    clear();
+}
+
+size_t HistoryStore::getStorageBytes() {
+    return sizeof(uint32_t) * HISTORY_BLOCKS +
+           (sizeof(uint16_t) * 2 + sizeof(int16_t) * HISTORY_CHANNEL_COUNT) * HISTORY_SIZE;
+}
+
+int16_t HistoryStore::encodeChannel(HistoryChannel channel, float value) {
+    if (isnan(value)) {
+        return HISTORY_VALUE_NONE;
+    }
+    float scaled = roundf(value * CHANNEL_SCALE[channel]);
+    if (scaled <= (float)INT16_MIN || scaled > (float)INT16_MAX) {
+        return HISTORY_VALUE_NONE;
+    }
+    return (int16_t)scaled;
+}
+
+float HistoryStore::decodeChannel(HistoryChannel channel, int16_t value) {
+    return value == HISTORY_VALUE_NONE ? NAN : value / CHANNEL_SCALE[channel];
+}
+
+uint16_t HistoryStore::packFlags(const DataPoint& point) {
+    return (point.valid ? HISTORY_FLAG_VALID : 0) |
+           (uint16_t)((point.temp_state & 0x03) << STATE_SHIFT_TEMP) |
+           (uint16_t)((point.ph_state & 0x03) << STATE_SHIFT_PH) |
+           (uint16_t)((point.nh3_state & 0x03) << STATE_SHIFT_NH3) |
+           (uint16_t)((point.orp_state & 0x03) << STATE_SHIFT_ORP) |
+           (uint16_t)((point.ec_state & 0x03) << STATE_SHIFT_EC) |
+           (uint16_t)((point.do_state & 0x03) << STATE_SHIFT_DO);
+}
+
+void HistoryStore::unpackFlags(uint16_t flagWord, DataPoint& point) {
+    point.valid = (flagWord & HISTORY_FLAG_VALID) != 0;
+    point.temp_state = (flagWord >> STATE_SHIFT_TEMP) & 0x03;
+    point.ph_state = (flagWord >> STATE_SHIFT_PH) & 0x03;
+    point.nh3_state = (flagWord >> STATE_SHIFT_NH3) & 0x03;
+    point.orp_state = (flagWord >> STATE_SHIFT_ORP) & 0x03;
+    point.ec_state = (flagWord >> STATE_SHIFT_EC) & 0x03;
+    point.do_state = (flagWord >> STATE_SHIFT_DO) & 0x03;
+}
+
+void HistoryStore::decodeRow(const HistoryRow& row, const HistoryDerivedContext& context, DataPoint& dp) {
+    dp.timestamp = (time_t)row.timestamp;
+    dp.temp_c = decodeChannel(HISTORY_CH_TEMP, row.mean[HISTORY_CH_TEMP]);
+    dp.orp_mv = decodeChannel(HISTORY_CH_ORP, row.mean[HISTORY_CH_ORP]);
+    dp.ph = decodeChannel(HISTORY_CH_PH, row.mean[HISTORY_CH_PH]);
+    dp.ec_ms_cm = decodeChannel(HISTORY_CH_EC, row.mean[HISTORY_CH_EC]);
+    unpackFlags(row.flags, dp);
+
+    // Derived metrics - same formulas as the live values in AquariumWebServer
+    dp.tds_ppm = DerivedMetrics::calculateTDS(dp.ec_ms_cm, context.tds_factor);
+    dp.co2_ppm = DerivedMetrics::calculateCO2(dp.ph, context.kh_dkh);
+    dp.toxic_ammonia_ratio = DerivedMetrics::calculateToxicAmmoniaRatio(dp.temp_c, dp.ph);
+    dp.nh3_ppm = DerivedMetrics::calculateActualNH3(context.tan_ppm, dp.toxic_ammonia_ratio);
+    dp.max_do_mg_l = DerivedMetrics::calculateMaxDO(dp.temp_c);
+    dp.stocking_density = context.stocking_density;
+}
+
+void HistoryStore::clear() {
+    writes.beginWrite();
+    head = 0;
+    tail = 0;
+    count = 0;
+    memset(flags, 0, sizeof(flags));
+    writes.endWrite();
+}
+
+void HistoryStore::advance() {
+    head = (head + 1) % HISTORY_SIZE;
+    count++;
+    appended++;
+}
+
+int HistoryStore::indexOfSequence(uint32_t sequence) const {
+    uint32_t behind = appended - sequence;  // Wraps to a huge value for future sequences
+    if (behind > (uint32_t)count) {
+        return -1;
+    }
+    return count - (int)behind;
+}
+
+void HistoryStore::startBlock(uint32_t timestamp) {
+    // Evict the oldest block if the new one would overwrite it
+    if (count + HISTORY_BLOCK_SIZE > HISTORY_SIZE) {
+        tail = (tail + HISTORY_BLOCK_SIZE) % HISTORY_SIZE;
+        count -= HISTORY_BLOCK_SIZE;
+    }
+    blockBase[head / HISTORY_BLOCK_SIZE] = timestamp;
+}
+
+void HistoryStore::add(const DataPoint& point) {
+    uint32_t timestamp = (uint32_t)point.timestamp;
+    writes.beginWrite();
+
+    if (head % HISTORY_BLOCK_SIZE != 0) {
+        uint32_t base = blockBase[head / HISTORY_BLOCK_SIZE];
+        if (timestamp < base || timestamp - base > UINT16_MAX) {
+            // Clock stepped - close this block with invalid slots
+            while (head % HISTORY_BLOCK_SIZE != 0) {
+                flags[head] = 0;
+                timeOffset[head] = timeOffset[(head + HISTORY_SIZE - 1) % HISTORY_SIZE];
+                advance();
+            }
+        }
+    }
+    if (head % HISTORY_BLOCK_SIZE == 0) {
+        startBlock(timestamp);
+    }
+
+    timeOffset[head] = (uint16_t)(timestamp - blockBase[head / HISTORY_BLOCK_SIZE]);
+    values[HISTORY_CH_TEMP][head] = encodeChannel(HISTORY_CH_TEMP, point.temp_c);
+    values[HISTORY_CH_ORP][head] = encodeChannel(HISTORY_CH_ORP, point.orp_mv);
+    values[HISTORY_CH_PH][head] = encodeChannel(HISTORY_CH_PH, point.ph);
+    values[HISTORY_CH_EC][head] = encodeChannel(HISTORY_CH_EC, point.ec_ms_cm);
+    flags[head] = packFlags(point);
+    advance();
+    writes.endWrite();
+}
+
+uint32_t HistoryStore::timeAt(int index) const {
+    while (true) {
+        uint32_t token = writes.readBegin();
+        int slot = slotAt(index);
+        uint32_t timestamp = blockBase[slot / HISTORY_BLOCK_SIZE] + timeOffset[slot];
+        if (!writes.readRetry(token)) {
+            return timestamp;
+        }
+    }
+}
+
+void HistoryStore::getRow(int index, HistoryRow& row) const {
+    uint32_t token;
+    do {
+        token = writes.readBegin();
+        copyRow(slotAt(index), row);
+    } while (writes.readRetry(token));
+}
+
+bool HistoryStore::readRow(uint32_t sequence, HistoryRow& row) const {
+    while (true) {
+        uint32_t token = writes.readBegin();
+        int index = indexOfSequence(sequence);
+        bool found = index >= 0 && index < count;
+        if (found) {
+            copyRow(slotAt(index), row);
+        }
+        if (!writes.readRetry(token)) {
+            return found;
+        }
+    }
+}
+
+bool HistoryStore::readPoint(uint32_t sequence, DataPoint& point) const {
+    HistoryRow row;
+    if (!readRow(sequence, row)) {
+        return false;
+    }
+    decodeRow(row, getDerivedContext(), point);
+    return true;
+}
+
+void HistoryStore::getSequenceRange(uint32_t& first, uint32_t& end) const {
+    uint32_t token;
+    do {
+        token = writes.readBegin();
+        end = appended;
+        first = appended - (uint32_t)count;
+    } while (writes.readRetry(token));
+}
+
+HistoryDerivedContext HistoryStore::getDerivedContext() const {
+    HistoryDerivedContext context;
+    derived.read(context);
+    return context;
+}
+
+void HistoryStore::copyRow(int slot, HistoryRow& row) const {
+    row.timestamp = blockBase[slot / HISTORY_BLOCK_SIZE] + timeOffset[slot];
+    row.flags = flags[slot];
+    row.samples = (row.flags & HISTORY_FLAG_VALID) ? 1 : 0;
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        int16_t value = row.samples ? values[ch][slot] : HISTORY_VALUE_NONE;
+        row.mean[ch] = value;
+        row.min[ch] = value;
+        row.max[ch] = value;
+    }
+}
+
+DataPoint HistoryStore::at(int index) const {
+    HistoryRow row;
+    getRow(index, row);
+
+    DataPoint dp;
+    decodeRow(row, getDerivedContext(), dp);
+    return dp;
+}
@@ -0,0 +1,204 @@
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <Arduino.h>
+#include <time.h>
+#include "SeqLock.h"
+
+// Data history configuration (raw tier)
+#define HISTORY_SIZE 720  // 720 points = 1 hour at 5s intervals (~12 bytes per point)
+#define HISTORY_INTERVAL_MS 5000  // 5 seconds between data points
+
+// Points per timestamp block. Each block stores one 32-bit base time and a
+// 16-bit offset per point; the ring evicts whole blocks.
+#define HISTORY_BLOCK_SIZE 16
+#define HISTORY_BLOCKS (HISTORY_SIZE / HISTORY_BLOCK_SIZE)
+
+// Flag word: bit 0 = valid, then 2 bits per warning state
+#define HISTORY_FLAG_VALID 0x0001
+
+// Encoded value of a channel that had no usable reading (NaN or out of range)
+#define HISTORY_VALUE_NONE INT16_MIN
+
+// Earliest timestamp from a synced clock (2024-01-01 UTC). Before NTP sync
+// time() counts from boot, so points below this carry no real date.
+#define HISTORY_TIME_VALID_MIN 1704067200UL
+
+// Stored channels, each as int16 fixed point
+enum HistoryChannel {
+    HISTORY_CH_TEMP = 0,  // 0.01 °C
+    HISTORY_CH_ORP = 1,   // 0.1 mV
+    HISTORY_CH_PH = 2,    // 0.001 pH
+    HISTORY_CH_EC = 3,    // 0.002 mS/cm (2 µS/cm, up to 65 mS/cm)
+    HISTORY_CHANNEL_COUNT = 4
+};
+
+// Decoded view of one logged point
+struct DataPoint {
+    time_t timestamp;
+    float temp_c;
+    float orp_mv;
+    float ph;
+    float ec_ms_cm;
+    // Derived metrics (computed on read, not stored)
+    float tds_ppm;
+    float co2_ppm;
+    float toxic_ammonia_ratio;
+    float nh3_ppm;
+    float max_do_mg_l;
+    float stocking_density;
+    bool valid;
+    // Warning states (0=unknown, 1=normal, 2=warning, 3=critical)
+    uint8_t temp_state;
+    uint8_t ph_state;
+    uint8_t nh3_state;
+    uint8_t orp_state;
+    uint8_t ec_state;
+    uint8_t do_state;
+};
+
+// Tank settings used to derive metrics when points are read back
+struct HistoryDerivedContext {
+    float tds_factor;        // TDS conversion factor
+    float kh_dkh;            // Carbonate hardness for CO2
+    float tan_ppm;           // Total ammonia nitrogen for NH3
+    float stocking_density;  // Depends on settings only, same for every point
+};
+
+/**
+ * Encoded summary of one or more points (a raw point, a rollup bucket or a
+ * merge of several). Values use the HistoryChannel fixed-point encodings;
+ * flags hold the valid bit and the worst warning state per sensor.
+ */
+struct HistoryRow {
+    uint32_t timestamp;  // Time of the first point (bucket start for rollups)
+    uint16_t samples;    // Valid raw points summarized (0 = gap)
+    uint16_t flags;
+    int16_t mean[HISTORY_CHANNEL_COUNT];
+    int16_t min[HISTORY_CHANNEL_COUNT];
+    int16_t max[HISTORY_CHANNEL_COUNT];
+};
+
+// Callback receiving rows in chronological order (log replay, queries)
+typedef void (*HistoryRowVisitor)(const HistoryRow& row, void* context);
+
+/**
+ * HistoryStore - Compact columnar ring buffer of logged data points (raw tier)
+ *
+ * Only the measured channels and warning states are stored, one column each:
+ * - Timestamps: 32-bit base per block of HISTORY_BLOCK_SIZE points + 16-bit offset per point
+ * - Channels: int16 fixed point (see HistoryChannel)
+ * - Flags: valid bit + six 2-bit warning states
+ *
+ * That is about 12 bytes per point instead of 64 for a DataPoint. Derived
+ * metrics (TDS, CO2, NH3, DO, stocking) are recomputed by at() from the
+ * decoded channels and the current HistoryDerivedContext.
+ *
+ * Points are addressed in chronological order: at(0) is the oldest retained
+ * point, at(getCount() - 1) the newest. When the ring is full the oldest
+ * block is evicted, so the count drops by up to HISTORY_BLOCK_SIZE - 1 below
+ * capacity. A timestamp that cannot be encoded against the current block's
+ * base (clock stepped back or jumped forward by more than 18 h, e.g. on NTP
+ * sync) closes the block early; the skipped slots read back as invalid.
+ *
+ * Every slot also has a sequence number that keeps counting across
+ * evictions and clear(), so clients can poll for points appended after a
+ * cursor (getSequence/indexOfSequence).
+ *
+ * add() and clear() run on one task (the main loop) while HTTP handlers read
+ * on the AsyncTCP task. Writes are bracketed by a SeqCount and every read
+ * copies its slot inside a read section that is retried if a write
+ * overlapped it, so readers never block the writer and never return a
+ * half-written row. Readers that walk the ring over several calls should
+ * keep a sequence number as their cursor and use readRow/readPoint, which
+ * resolve the slot and copy it in the same read section.
+ */
+class HistoryStore {
+public:
+    HistoryStore();
+
+    // Append a point (derived fields are ignored)
+    void add(const DataPoint& point);
+
+    // Drop all points
+    void clear();
+
+    // Number of retained slots, including invalid ones (0-HISTORY_SIZE)
+    int getCount() const { return count; }
+
+    // Decoded point at a chronological index (0 = oldest)
+    DataPoint at(int index) const;
+
+    // Encoded point at a chronological index as a single-sample row
+    void getRow(int index, HistoryRow& row) const;
+
+    // Timestamp at a chronological index
+    uint32_t timeAt(int index) const;
+
+    // Sequence number the next slot will get (one past the newest)
+    uint32_t getSequence() const { return appended; }
+
+    // Sequence number of the slot at a chronological index
+    uint32_t sequenceAt(int index) const { return appended - (uint32_t)count + index; }
+
+    /**
+     * Chronological index of a sequence number
+     * @return Index (getCount() if the sequence is the next one), or -1 if
+     *         the slot was evicted or the sequence was never issued
+     */
+    int indexOfSequence(uint32_t sequence) const;
+
+    // Oldest retained and next sequence number, read together
+    void getSequenceRange(uint32_t& first, uint32_t& end) const;
+
+    /**
+     * Copy the slot with a sequence number
+     * @return false if the slot was evicted or not written yet
+     */
+    bool readRow(uint32_t sequence, HistoryRow& row) const;
+
+    // Decoded point with a sequence number (false if evicted or not written yet)
+    bool readPoint(uint32_t sequence, DataPoint& point) const;
+
+    // Newest point (undefined if empty)
+    DataPoint latest() const { return at(count - 1); }
+
+    int getCapacity() const { return HISTORY_SIZE; }
+
+    // Settings used for derived metrics on read
+    void setDerivedContext(const HistoryDerivedContext& context) { derived.write(context); }
+    HistoryDerivedContext getDerivedContext() const;
+
+    // Bytes of point storage (for diagnostics)
+    static size_t getStorageBytes();
+
+    // Fixed-point channel encoding shared by all history tiers
+    static int16_t encodeChannel(HistoryChannel channel, float value);
+    static float decodeChannel(HistoryChannel channel, int16_t value);
+    static uint16_t packFlags(const DataPoint& point);
+    static void unpackFlags(uint16_t flags, DataPoint& point);
+
+    // Decode a row's means (flags, channels and derived metrics) into a DataPoint
+    static void decodeRow(const HistoryRow& row, const HistoryDerivedContext& context, DataPoint& point);
+
+private:
+    uint32_t blockBase[HISTORY_BLOCKS];  // Timestamp of each block's first point
+    uint16_t timeOffset[HISTORY_SIZE];   // Seconds since the block base
+    int16_t values[HISTORY_CHANNEL_COUNT][HISTORY_SIZE];
+    uint16_t flags[HISTORY_SIZE];
+
+    int head;   // Next slot to write
+    int tail;   // Oldest retained slot (always a block start)
+    int count;
+    uint32_t appended;  // Slots written since construction
+
+    SeqCount writes;  // Guards the columns and ring positions above
+    SeqLock<HistoryDerivedContext> derived;
+
+    void startBlock(uint32_t timestamp);
+    void advance();
+    int slotAt(int index) const { return (tail + index) % HISTORY_SIZE; }
+    void copyRow(int slot, HistoryRow& row) const;
+};
+
+#endif // HISTORY_STORE_H
@@ -0,0 +1,286 @@
+#include "RollingStats.h"
+#include <math.h>
+
+static const uint32_t WINDOW_SPANS[ROLLING_STATS_WINDOW_COUNT] = { 3600, 86400, 604800 };
+static const char* const WINDOW_NAMES[ROLLING_STATS_WINDOW_COUNT] = { "1h", "24h", "7d" };
+
+static void resetSummary(RollingSummary& summary) {
+    summary.count = 0;
+    summary.mean = 0;
+    summary.m2 = 0;
+    summary.min = INFINITY;
+    summary.max = -INFINITY;
+}
+
+// Welford's update generalized to merging two summaries (a single reading has count 1, m2 0)
+static void mergeSummary(RollingSummary& into, const RollingSummary& from) {
+    if (from.count == 0) {
+        return;
+    }
+    uint32_t count = into.count + from.count;
+    float delta = from.mean - into.mean;
+    into.mean += delta * from.count / count;
+    into.m2 += from.m2 + delta * delta * ((float)into.count * from.count / count);
+    into.count = count;
+    if (from.min < into.min) {
+        into.min = from.min;
+    }
+    if (from.max > into.max) {
+        into.max = from.max;
+    }
+}
+
+// ============================================================================
+// RollingWindow
+// ============================================================================
+
+RollingWindow::RollingWindow(uint32_t span_s, uint16_t slotCount)
+    : span(span_s), period(span_s / slotCount), capacity(slotCount) {
+    clear();
+}
+
+void RollingWindow::clear() {
+    head = 0;
+    count = 0;
+    hasOpen = false;
+    openStart = 0;
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        resetSummary(open[ch]);
+        totalCount[ch] = 0;
+        totalMean[ch] = 0;
+        totalM2[ch] = 0;
+        minQueue[ch].head = minQueue[ch].size = 0;
+        maxQueue[ch].head = maxQueue[ch].size = 0;
+    }
+}
+
+void RollingWindow::add(const HistoryRow& row) {
+    if (row.samples == 0) {
+        return;  // Gap
+    }
+
+    uint32_t start = row.timestamp - row.timestamp % period;
+    if (!hasOpen) {
+        openStart = start;
+        hasOpen = true;
+    } else if (start > openStart) {
+        closeOpenSlot();
+        openStart = start;
+        evictBefore(start);
+    }
+    // A row from before the open slot (clock stepped back) is counted in the open slot
+
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        if (row.mean[ch] == HISTORY_VALUE_NONE) {
+            continue;
+        }
+        RollingSummary reading;
+        reading.count = row.samples;
+        reading.mean = HistoryStore::decodeChannel((HistoryChannel)ch, row.mean[ch]);
+        reading.m2 = 0;
+        reading.min = HistoryStore::decodeChannel((HistoryChannel)ch, row.min[ch]);
+        reading.max = HistoryStore::decodeChannel((HistoryChannel)ch, row.max[ch]);
+        mergeSummary(open[ch], reading);
+    }
+}
+
+void RollingWindow::pushQueue(Deque& queue, int channel, int position, bool isMin) {
+    float value = isMin ? slots[position][channel].min : slots[position][channel].max;
+
+    // Drop slots that can no longer be the extreme: they leave the window before this one
+    while (queue.size > 0) {
+        int back = queue.items[(queue.head + queue.size - 1) % capacity];
+        float backValue = isMin ? slots[back][channel].min : slots[back][channel].max;
+        if (isMin ? backValue < value : backValue > value) {
+            break;
+        }
+        queue.size--;
+    }
+    queue.items[(queue.head + queue.size) % capacity] = (uint8_t)position;
+    queue.size++;
+}
+
+void RollingWindow::closeOpenSlot() {
+    // evictBefore() left at most capacity - 1 slots, so there is room for this one
+    int position = (head + count) % capacity;
+    slotStart[position] = openStart;
+    count++;
+
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        RollingSummary& slot = slots[position][ch];
+        slot = open[ch];
+        resetSummary(open[ch]);
+        if (slot.count == 0) {
+            continue;
+        }
+
+        uint32_t total = totalCount[ch] + slot.count;
+        double delta = (double)slot.mean - totalMean[ch];
+        totalMean[ch] += delta * slot.count / total;
+        totalM2[ch] += slot.m2 + delta * delta * ((double)totalCount[ch] * slot.count / total);
+        totalCount[ch] = total;
+
+        pushQueue(minQueue[ch], ch, position, true);
+        pushQueue(maxQueue[ch], ch, position, false);
+    }
+}
+
+void RollingWindow::evictBefore(uint32_t start) {
+    while (count > 0 && slotStart[head] + span <= start) {
+        for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+            const RollingSummary& slot = slots[head][ch];
+            if (slot.count == 0) {
+                continue;
+            }
+
+            // Inverse of the merge in closeOpenSlot()
+            uint32_t remaining = totalCount[ch] - slot.count;
+            if (remaining == 0) {
+                totalCount[ch] = 0;
+                totalMean[ch] = 0;
+                totalM2[ch] = 0;
+            } else {
+                double mean = (totalMean[ch] * totalCount[ch] - (double)slot.mean * slot.count) / remaining;
+                double delta = (double)slot.mean - mean;
+                totalM2[ch] -= slot.m2 + delta * delta * ((double)remaining * slot.count / totalCount[ch]);
+                if (totalM2[ch] < 0) {
+                    totalM2[ch] = 0;
+                }
+                totalMean[ch] = mean;
+                totalCount[ch] = remaining;
+            }
+
+            // The evicted slot is the oldest, so it can only be at the front
+            Deque* queues[2] = { &minQueue[ch], &maxQueue[ch] };
+            for (Deque* queue : queues) {
+                if (queue->size > 0 && queue->items[queue->head] == head) {
+                    queue->head = (queue->head + 1) % capacity;
+                    queue->size--;
+                }
+            }
+        }
+        head = (head + 1) % capacity;
+        count--;
+    }
+}
+
+void RollingWindow::get(int channel, RollingStatsValue& value) const {
+    RollingSummary summary;
+    summary.count = totalCount[channel];
+    summary.mean = (float)totalMean[channel];
+    summary.m2 = (float)totalM2[channel];
+    summary.min = INFINITY;
+    summary.max = -INFINITY;
+    const Deque& minFront = minQueue[channel];
+    const Deque& maxFront = maxQueue[channel];
+    if (minFront.size > 0) {
+        summary.min = slots[minFront.items[minFront.head]][channel].min;
+    }
+    if (maxFront.size > 0) {
+        summary.max = slots[maxFront.items[maxFront.head]][channel].max;
+    }
+    mergeSummary(summary, open[channel]);
+
+    value.count = summary.count;
+    if (summary.count == 0) {
+        value.mean = NAN;
+        value.stddev = NAN;
+        value.min = NAN;
+        value.max = NAN;
+        return;
+    }
+    value.mean = summary.mean;
+    value.stddev = sqrtf(summary.m2 / summary.count);
+    value.min = summary.min;
+    value.max = summary.max;
+}
+
+// ============================================================================
+// RollingStats
+// ============================================================================
+
+RollingStats::RollingStats()
+    : windows{ RollingWindow(WINDOW_SPANS[ROLLING_STATS_1H], ROLLING_STATS_1H_SLOTS),
+               RollingWindow(WINDOW_SPANS[ROLLING_STATS_24H], ROLLING_STATS_24H_SLOTS),
+               RollingWindow(WINDOW_SPANS[ROLLING_STATS_7D], ROLLING_STATS_7D_SLOTS) } {
+    clear();
+}
+
+void RollingStats::clear() {
+    for (int w = 0; w < ROLLING_STATS_WINDOW_COUNT; w++) {
+        windows[w].clear();
+    }
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        lastValue[ch] = HISTORY_VALUE_NONE;
+        lastChange[ch] = 0;
+    }
+    updated = 0;
+}
+
+void RollingStats::add(const HistoryRow& row) {
+    if (row.samples == 0 || row.timestamp < HISTORY_TIME_VALID_MIN) {
+        return;  // Gap, or boot-relative time before NTP sync
+    }
+
+    for (int w = 0; w < ROLLING_STATS_WINDOW_COUNT; w++) {
+        windows[w].add(row);
+    }
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        if (row.mean[ch] != HISTORY_VALUE_NONE && row.mean[ch] != lastValue[ch]) {
+            lastValue[ch] = row.mean[ch];
+            lastChange[ch] = row.timestamp;
+        }
+    }
+    updated = row.timestamp;
+}
+
+uint32_t RollingStats::restore(const TieredHistory& history) {
+    clear();
+
+    // 15-minute buckets up to where the 1-minute tier starts, then the 1-minute tier
+    int minutes = history.getRowCount(1);
+    uint32_t minutesStart = minutes > 0 ? history.getRowTime(1, 0) : UINT32_MAX;
+    uint32_t quarterPeriod = history.getTierPeriod(2);
+    uint32_t restored = 0;
+    HistoryRow row;
+
+    int quarters = history.getRowCount(2);
+    for (int i = 0; i < quarters; i++) {
+        history.getRow(2, i, row);
+        if (row.timestamp + quarterPeriod > minutesStart) {
+            break;
+        }
+        if (row.samples > 0) {
+            add(row);
+            restored++;
+        }
+    }
+    for (int i = 0; i < minutes; i++) {
+        history.getRow(1, i, row);
+        if (row.samples > 0) {
+            add(row);
+            restored++;
+        }
+    }
+    return restored;
+}
+
+void RollingStats::get(RollingStatsSnapshot& snapshot) const {
+    snapshot.updated = updated;
+    for (int w = 0; w < ROLLING_STATS_WINDOW_COUNT; w++) {
+        for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+            RollingStatsValue& value = snapshot.values[w][ch];
+            windows[w].get(ch, value);
+            bool recent = lastChange[ch] != 0 && lastChange[ch] + windows[w].getSpan() > updated;
+            value.lastChange = recent ? lastChange[ch] : 0;
+        }
+    }
+}
+
+uint32_t RollingStats::getWindowSpan(int window) {
+    return WINDOW_SPANS[window];
+}
+
+const char* RollingStats::getWindowName(int window) {
+    return WINDOW_NAMES[window];
+}
@@ -0,0 +1,144 @@
+#ifndef ROLLING_STATS_H
+#define ROLLING_STATS_H
+
+#include <Arduino.h>
+#include "TieredHistory.h"
+
+// Windows (span = slots x slot period). The window slides one slot at a time.
+#define ROLLING_STATS_1H_SLOTS   12    // 5 minutes
+#define ROLLING_STATS_24H_SLOTS  24    // 1 hour
+#define ROLLING_STATS_7D_SLOTS   28    // 6 hours
+#define ROLLING_STATS_MAX_SLOTS  28
+
+enum RollingStatsWindow {
+    ROLLING_STATS_1H = 0,
+    ROLLING_STATS_24H = 1,
+    ROLLING_STATS_7D = 2,
+    ROLLING_STATS_WINDOW_COUNT = 3
+};
+
+// Running summary of one channel (Welford mean and sum of squared deviations)
+struct RollingSummary {
+    uint32_t count;
+    float mean;
+    float m2;
+    float min;
+    float max;
+};
+
+// Statistics of one channel over one window (count 0 = no readings)
+struct RollingStatsValue {
+    uint32_t count;
+    float mean;
+    float stddev;  // Population standard deviation
+    float min;
+    float max;
+    uint32_t lastChange;  // Time the value last changed, 0 if not within the window
+};
+
+// All windows and channels, copied out for readers on another task
+struct RollingStatsSnapshot {
+    uint32_t updated;  // Time of the newest point (0 = none yet)
+    RollingStatsValue values[ROLLING_STATS_WINDOW_COUNT][HISTORY_CHANNEL_COUNT];
+};
+
+/**
+ * RollingWindow - Sliding-window mean, variance, min and max of every channel
+ *
+ * Points are folded into the open slot with Welford's update. When a point
+ * falls into a later slot the open slot is closed into a ring, merged into
+ * the window totals and pushed onto a monotonic min and max deque per
+ * channel; slots that slide out of the window are subtracted from the totals
+ * and popped from the deque fronts. Every step is O(1) amortized, and get()
+ * combines the totals with the open slot in O(1).
+ *
+ * The window covers the closed slots that started less than one span before
+ * the open slot plus the open slot itself, so it spans between span - period
+ * and span seconds.
+ */
+class RollingWindow {
+public:
+    RollingWindow(uint32_t span_s, uint16_t slots);
+
+    // Fold a row's channels into the window (rows summarizing several points keep their min/max)
+    void add(const HistoryRow& row);
+    void clear();
+
+    void get(int channel, RollingStatsValue& value) const;
+
+    uint32_t getSpan() const { return span; }
+    uint32_t getPeriod() const { return period; }
+
+private:
+    // Ring positions in window order with monotonic values
+    struct Deque {
+        uint8_t items[ROLLING_STATS_MAX_SLOTS];
+        uint8_t head;
+        uint8_t size;
+    };
+
+    uint32_t span;
+    uint32_t period;
+    uint16_t capacity;
+
+    RollingSummary slots[ROLLING_STATS_MAX_SLOTS][HISTORY_CHANNEL_COUNT];
+    uint32_t slotStart[ROLLING_STATS_MAX_SLOTS];
+    int head;   // Oldest closed slot
+    int count;  // Closed slots in the window
+
+    RollingSummary open[HISTORY_CHANNEL_COUNT];
+    uint32_t openStart;
+    bool hasOpen;
+
+    // Closed slots merged (mean and m2 in double so removals do not drift)
+    uint32_t totalCount[HISTORY_CHANNEL_COUNT];
+    double totalMean[HISTORY_CHANNEL_COUNT];
+    double totalM2[HISTORY_CHANNEL_COUNT];
+
+    Deque minQueue[HISTORY_CHANNEL_COUNT];
+    Deque maxQueue[HISTORY_CHANNEL_COUNT];
+
+    void closeOpenSlot();
+    void evictBefore(uint32_t start);
+    void pushQueue(Deque& queue, int channel, int position, bool isMin);
+};
+
+/**
+ * RollingStats - Precomputed 1 h, 24 h and 7 d statistics of the primary sensors
+ *
+ * Updated once per history point, so readers get min/max/mean/stddev of the
+ * windows without touching the history. Values are the stored fixed-point
+ * readings, and the last-change time is when the stored value last differed
+ * from the previous reading. Points from before NTP sync are left out, since
+ * the windows are wall-clock time. restore() rebuilds the windows from the
+ * rollup tiers after a reboot; variance within a restored bucket is unknown,
+ * so stddev only counts the spread between buckets until the window refills.
+ */
+class RollingStats {
+public:
+    RollingStats();
+
+    // Fold a stored point (or rollup bucket) into every window
+    void add(const HistoryRow& row);
+    void clear();
+
+    /**
+     * Rebuild the windows from the 15-minute and 1-minute tiers (after the log was replayed)
+     * @return Number of rows folded in
+     */
+    uint32_t restore(const TieredHistory& history);
+
+    void get(RollingStatsSnapshot& snapshot) const;
+
+    // Window span in seconds and its name ("1h", "24h", "7d")
+    static uint32_t getWindowSpan(int window);
+    static const char* getWindowName(int window);
+
+private:
+    RollingWindow windows[ROLLING_STATS_WINDOW_COUNT];
+    int16_t lastValue[HISTORY_CHANNEL_COUNT];
+    uint32_t lastChange[HISTORY_CHANNEL_COUNT];
+    uint32_t updated;
+};
+
+#endif // ROLLING_STATS_H
@@ -0,0 +1,191 @@
+#include "TieredHistory.h"
+
+TieredHistory::TieredHistory()
+    : minuteTier(HISTORY_TIER1_PERIOD_S, HISTORY_TIER1_BUCKETS),
+      quarterTier(HISTORY_TIER2_PERIOD_S, HISTORY_TIER2_BUCKETS),
+      hourTier(HISTORY_TIER3_PERIOD_S, HISTORY_TIER3_BUCKETS),
+      log(nullptr) {
+}
+
+void TieredHistory::add(const DataPoint& point) {
+    // Points logged before NTP sync carry boot-relative times; drop them from
+    // the raw tier once the clock is set so they do not show up as a stray
+    // point decades before the rest of the chart
+    int count = raw.getCount();
+    if ((uint32_t)point.timestamp >= HISTORY_TIME_VALID_MIN && count > 0 &&
+        raw.timeAt(count - 1) < HISTORY_TIME_VALID_MIN) {
+        raw.clear();
+    }
+
+    raw.add(point);
+
+    // Fold the stored (quantized) point into every rollup tier
+    HistoryRow row;
+    raw.getRow(raw.getCount() - 1, row);
+    addRollup(row);
+}
+
+void TieredHistory::addRollup(const HistoryRow& row) {
+    HistoryRow closed;
+    if (minuteTier.add(row, &closed) && log != nullptr) {
+        log->append(closed);
+    }
+    quarterTier.add(row);
+    hourTier.add(row);
+}
+
+void TieredHistory::restoreRow(const HistoryRow& row, void* context) {
+    TieredHistory* history = static_cast<TieredHistory*>(context);
+    history->minuteTier.add(row);
+    history->quarterTier.add(row);
+    history->hourTier.add(row);
+}
+
+uint32_t TieredHistory::attachLog(HistoryLog& historyLog) {
+    log = nullptr;
+    uint32_t restored = historyLog.replay(TieredHistory::restoreRow, this);
+    log = &historyLog;
+    return restored;
+}
+
+void TieredHistory::flushLog() {
+    if (log != nullptr) {
+        log->flush();
+    }
+}
+
+void TieredHistory::clear() {
+    raw.clear();
+    minuteTier.clear();
+    quarterTier.clear();
+    hourTier.clear();
+}
+
+const RollupTier* TieredHistory::getRollup(int tier) const {
+    switch (tier) {
+        case 1: return &minuteTier;
+        case 2: return &quarterTier;
+        case 3: return &hourTier;
+        default: return nullptr;
+    }
+}
+
+int TieredHistory::selectTier(uint32_t range_s) const {
+    // After a reboot only the rollups are restored from flash; use the minute
+    // tier while the raw ring is still filling and does not cover the range
+    uint32_t rawFirst, rawEnd, minuteFirst, minuteEnd;
+    raw.getSequenceRange(rawFirst, rawEnd);
+    minuteTier.getSequenceRange(minuteFirst, minuteEnd);
+    uint32_t rawOldest = 0, rawNewest = 0, minuteOldest = 0;
+    bool hasRaw = rawEnd != rawFirst && readRowTime(0, rawFirst, rawOldest) &&
+                  readRowTime(0, rawEnd - 1, rawNewest);
+    bool hasMinutes = minuteEnd != minuteFirst && readRowTime(1, minuteFirst, minuteOldest);
+
+    uint32_t rawCovered = hasRaw ? rawNewest - rawOldest : 0;
+    bool rawShort = rawEnd - rawFirst < HISTORY_SIZE - HISTORY_BLOCK_SIZE && rawCovered < range_s;
+    bool minuteOlder = hasMinutes && (!hasRaw || minuteOldest + HISTORY_TIER1_PERIOD_S <= rawOldest);
+
+    for (int tier = 0; tier < HISTORY_TIER_COUNT - 1; tier++) {
+        if (tier == 0 && rawShort && minuteOlder) {
+            continue;
+        }
+        if (range_s <= getTierSpan(tier)) {
+            return tier;
+        }
+    }
+    return HISTORY_TIER_COUNT - 1;
+}
+
+uint32_t TieredHistory::getLatestTime() const {
+    // Right after a reboot only the restored rollups hold data
+    for (int tier = 0; tier <= 1; tier++) {
+        uint32_t first, end, timestamp;
+        getSequenceRange(tier, first, end);
+        if (end != first && readRowTime(tier, end - 1, timestamp)) {
+            return timestamp;
+        }
+    }
+    return 0;
+}
+
+int TieredHistory::getRowCount(int tier) const {
+    const RollupTier* rollup = getRollup(tier);
+    return rollup ? rollup->getCount() : raw.getCount();
+}
+
+void TieredHistory::getRow(int tier, int index, HistoryRow& row) const {
+    const RollupTier* rollup = getRollup(tier);
+    if (rollup) {
+        rollup->at(index, row);
+    } else {
+        raw.getRow(index, row);
+    }
+}
+
+uint32_t TieredHistory::getRowTime(int tier, int index) const {
+    const RollupTier* rollup = getRollup(tier);
+    return rollup ? rollup->timeAt(index) : raw.timeAt(index);
+}
+
+void TieredHistory::getSequenceRange(int tier, uint32_t& first, uint32_t& end) const {
+    const RollupTier* rollup = getRollup(tier);
+    if (rollup) {
+        rollup->getSequenceRange(first, end);
+    } else {
+        raw.getSequenceRange(first, end);
+    }
+}
+
+bool TieredHistory::readRow(int tier, uint32_t sequence, HistoryRow& row) const {
+    const RollupTier* rollup = getRollup(tier);
+    return rollup ? rollup->readRow(sequence, row) : raw.readRow(sequence, row);
+}
+
+bool TieredHistory::readRowTime(int tier, uint32_t sequence, uint32_t& timestamp) const {
+    HistoryRow row;
+    if (!readRow(tier, sequence, row)) {
+        return false;
+    }
+    timestamp = row.timestamp;
+    return true;
+}
+
+uint32_t TieredHistory::getTierPeriod(int tier) const {
+    const RollupTier* rollup = getRollup(tier);
+    return rollup ? rollup->getPeriod() : HISTORY_INTERVAL_MS / 1000;
+}
+
+uint32_t TieredHistory::getTierSpan(int tier) const {
+    const RollupTier* rollup = getRollup(tier);
+    return rollup ? rollup->getSpan() : (uint32_t)HISTORY_SIZE * (HISTORY_INTERVAL_MS / 1000);
+}
+
+size_t TieredHistory::getStorageBytes() const {
+    return HistoryStore::getStorageBytes() + minuteTier.getStorageBytes() +
+           quarterTier.getStorageBytes() + hourTier.getStorageBytes();
+}
+
+uint32_t TieredHistory::parseDuration(const char* text) {
+    if (text == nullptr || *text < '0' || *text > '9') {
+        return 0;
+    }
+
+    char* end = nullptr;
+    unsigned long value = strtoul(text, &end, 10);
+    uint32_t multiplier;
+    switch (*end) {
+        case '\0':
+        case 's': multiplier = 1; break;
+        case 'm': multiplier = 60; break;
+        case 'h': multiplier = 3600; break;
+        case 'd': multiplier = 86400; break;
+        default: return 0;
+    }
+    if (*end != '\0' && end[1] != '\0') {
+        return 0;  // Trailing characters after the unit
+    }
+    if (value == 0 || value > UINT32_MAX / multiplier) {
+        return 0;
+    }
+    return (uint32_t)value * multiplier;
+}
@@ -0,0 +1,107 @@
+#ifndef TIERED_HISTORY_H
+#define TIERED_HISTORY_H
+
+#include <Arduino.h>
+#include "HistoryStore.h"
+#include "HistoryRollup.h"
+#include "HistoryLog.h"
+
+// Rollup tiers (period in seconds x buckets). Each bucket is 28 bytes.
+#define HISTORY_TIER1_PERIOD_S    60    // 1 minute
+#define HISTORY_TIER1_BUCKETS   1440    // 24 hours (~39 KB)
+#define HISTORY_TIER2_PERIOD_S   900    // 15 minutes
+#define HISTORY_TIER2_BUCKETS    672    // 7 days (~18 KB)
+#define HISTORY_TIER3_PERIOD_S  3600    // 1 hour
+#define HISTORY_TIER3_BUCKETS    720    // 30 days (~20 KB); 2160 = 90 days (~59 KB)
+
+// Raw tier + rollup tiers
+#define HISTORY_TIER_COUNT 4
+
+/**
+ * TieredHistory - Multi-resolution round-robin history
+ *
+ * Tier 0 is the raw HistoryStore (5 s points); tiers 1-3 are RollupTiers
+ * with min/max/mean buckets. Every point added goes to the raw ring and is
+ * folded into each rollup tier in O(1), so long ranges are served from a
+ * coarse tier without touching or keeping the raw points.
+ *
+ * Tiers are read through a uniform row interface (getRowCount/getRow) so
+ * callers can serve any tier with the same code. Every tier is safe to read
+ * from the HTTP handlers while the main loop adds points; readers that walk
+ * a tier over several calls use sequence numbers (getSequenceRange/readRow),
+ * since an index shifts whenever a point or bucket is added or evicted.
+ *
+ * With a HistoryLog attached, every closed 1-minute bucket is appended to
+ * flash and the log is replayed into the rollup tiers on boot, so trends
+ * survive reboots and firmware updates (the raw tier starts empty).
+ */
+class TieredHistory {
+public:
+    TieredHistory();
+
+    void add(const DataPoint& point);
+    void clear();
+
+    /**
+     * Replay a flash log into the rollup tiers and log closed buckets to it from now on
+     * @return Number of 1-minute buckets restored
+     */
+    uint32_t attachLog(HistoryLog& log);
+
+    // Write buffered log records (call before a restart)
+    void flushLog();
+
+    // Raw (tier 0) points
+    const HistoryStore& getRaw() const { return raw; }
+
+    // Settings used for derived metrics on read
+    void setDerivedContext(const HistoryDerivedContext& context) { raw.setDerivedContext(context); }
+    HistoryDerivedContext getDerivedContext() const { return raw.getDerivedContext(); }
+
+    // Finest tier whose span covers the range (last tier if none does)
+    int selectTier(uint32_t range_s) const;
+
+    // Time of the newest data in any tier (0 if empty)
+    uint32_t getLatestTime() const;
+
+    // Row access for any tier (0 = raw) by chronological index (main loop only)
+    int getRowCount(int tier) const;
+    void getRow(int tier, int index, HistoryRow& row) const;
+    uint32_t getRowTime(int tier, int index) const;
+
+    // Oldest retained and one past the newest sequence number of a tier
+    void getSequenceRange(int tier, uint32_t& first, uint32_t& end) const;
+
+    /**
+     * Row with a sequence number, for readers on another task
+     * @return false if the row was evicted or does not exist yet
+     */
+    bool readRow(int tier, uint32_t sequence, HistoryRow& row) const;
+    bool readRowTime(int tier, uint32_t sequence, uint32_t& timestamp) const;
+
+    // Resolution and span of a tier in seconds
+    uint32_t getTierPeriod(int tier) const;
+    uint32_t getTierSpan(int tier) const;
+
+    // Bytes of point storage across all tiers (for diagnostics)
+    size_t getStorageBytes() const;
+
+    /**
+     * Parse a duration such as "90s", "15m", "24h", "7d" or plain seconds
+     * @return Seconds, or 0 if the string is not a valid positive duration
+     */
+    static uint32_t parseDuration(const char* text);
+
+private:
+    HistoryStore raw;
+    RollupTier minuteTier;
+    RollupTier quarterTier;
+    RollupTier hourTier;
+    HistoryLog* log;
+
+    const RollupTier* getRollup(int tier) const;
+    void addRollup(const HistoryRow& row);
+    static void restoreRow(const HistoryRow& row, void* context);
+};
+
+#endif // TIERED_HISTORY_H
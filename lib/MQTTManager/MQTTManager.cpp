@@ -10,13 +10,81 @@ static const char* KEY_PASSWORD = "password";
 static const char* KEY_DEVICE_ID = "device_id";
 static const char* KEY_PUBLISH_INTERVAL = "pub_interval";
 static const char* KEY_DISCOVERY_EN = "discovery_en";
+static const char* KEY_COMPACT_MODE = "compact";
+
+// Topic names (also the Home Assistant discovery object IDs), indexed by MQTTTopic
+static const char* const TOPIC_NAMES[MQTT_TOPIC_COUNT] = {
+    "temperature", "orp", "ph", "ec",
+    "tds", "co2", "nh3_fraction_percent", "nh3_ppm", "max_do", "stocking",
+    "temp_state", "ph_state", "nh3_state", "orp_state", "ec_state", "do_state",
+    "sensors"
+};
+
+// Combined JSON keys of MQTTOutboxRecord values and states, in payload order
+static const char* const VALUE_KEYS[MQTT_OUTBOX_VALUES] = {
+    "temperature_c", "orp_mv", "ph", "ec_ms_cm",
+    "tds_ppm", "co2_ppm", "nh3_ratio", "nh3_ppm", "max_do_mg_l", "stocking_density"
+};
+static const char* const STATE_KEYS[MQTT_OUTBOX_STATES] = {
+    "temp_state", "ph_state", "nh3_state", "orp_state", "ec_state", "do_state"
+};
+
+// Append "key":value to a JSON object being formatted in place
+// (9 significant digits so every float round-trips, null if not finite, as ArduinoJson does)
+static void appendJsonNumber(char* buffer, size_t size, size_t& length, const char* key, float value) {
+    if (length >= size) {
+        return;
+    }
+    const char* separator = buffer[length - 1] != '{' ? "," : "";
+    int written;
+    if (isfinite(value)) {
+        written = snprintf(buffer + length, size - length, "%s\"%s\":%.9g", separator, key, value);
+    } else {
+        written = snprintf(buffer + length, size - length, "%s\"%s\":null", separator, key);
+    }
+    length += written > 0 ? written : 0;
+}
+
+static void toOutboxRecord(const SensorData& data, uint32_t timestamp, MQTTOutboxRecord& record) {
+    record.timestamp = timestamp;
+    record.values[0] = data.temp_c;
+    record.values[1] = data.orp_mv;
+    record.values[2] = data.ph;
+    record.values[3] = data.ec_ms_cm;
+    record.values[4] = data.tds_ppm;
+    record.values[5] = data.co2_ppm;
+    record.values[6] = data.nh3_ratio;
+    record.values[7] = data.nh3_ppm;
+    record.values[8] = data.max_do_mg_l;
+    record.values[9] = data.stocking_density;
+    record.states[0] = data.temp_state;
+    record.states[1] = data.ph_state;
+    record.states[2] = data.nh3_state;
+    record.states[3] = data.orp_state;
+    record.states[4] = data.ec_state;
+    record.states[5] = data.do_state;
+    record.reserved[0] = 0;
+    record.reserved[1] = 0;
+}
+
+// Append the sensor values and warning states of a sample to a JSON object being formatted in place
+static void appendSampleJson(char* buffer, size_t size, size_t& length, const MQTTOutboxRecord& record) {
+    for (int i = 0; i < MQTT_OUTBOX_VALUES; i++) {
+        appendJsonNumber(buffer, size, length, VALUE_KEYS[i], record.values[i]);
+    }
+    for (int i = 0; i < MQTT_OUTBOX_STATES && length < size; i++) {
+        int written = snprintf(buffer + length, size - length, ",\"%s\":%u", STATE_KEYS[i], record.states[i]);
+        length += written > 0 ? written : 0;
+    }
+}
 
 MQTTManager::MQTTManager()
     : mqttClient(nullptr),
       lastPublishTime(0),
       lastReconnectAttempt(0),
       initialized(false),
-      currentReconnectInterval(RECONNECT_INTERVAL) {
+      currentReconnectInterval(RECONNECT_INTERVAL),
+      lastBackfillTime(0) {
 
     // Initialize config with defaults
     config.enabled = false;
@@ -27,8 +95,10 @@ MQTTManager::MQTTManager()
     strncpy(config.device_id, "aquarium", sizeof(config.device_id));
     config.publish_interval_ms = 5000;  // Default 5 seconds
     config.discovery_enabled = false;
+    config.compact_mode = false;
     config.timestamp = 0;
     strncpy(config.chip_id, "", sizeof(config.chip_id));
+    buildTopics();
 }
 
 MQTTManager::~MQTTManager() {
@@ -61,8 +131,8 @@ bool MQTTManager::begin() {
     // Set callback for incoming messages
     mqttClient->setCallback(MQTTManager::messageCallback);
 
-    // Set buffer size for larger payloads (Home Assistant Discovery)
-    mqttClient->setBufferSize(512);
+    // Set buffer size for larger payloads (discovery with value_template, backfill batches)
+    mqttClient->setBufferSize(MQTT_BUFFER_SIZE);
 
     initialized = true;
 
@@ -85,6 +155,12 @@ void MQTTManager::loop() {
     // Handle MQTT client loop
     if (mqttClient->connected()) {
         mqttClient->loop();
+
+        // Drain samples queued while disconnected, one batch per interval so the
+        // backlog does not crowd out live publishing
+        if (!outbox.isEmpty() && millis() - lastBackfillTime >= MQTT_BACKFILL_INTERVAL_MS) {
+            drainOutbox();
+        }
     } else {
         // Attempt reconnection with exponential backoff
         unsigned long now = millis();
@@ -119,12 +195,17 @@ bool MQTTManager::saveMQTTConfig(const MQTTConfiguration& newConfig) {
     preferences.putString(KEY_DEVICE_ID, newConfig.device_id);
     preferences.putUShort(KEY_PUBLISH_INTERVAL, newConfig.publish_interval_ms);
     preferences.putBool(KEY_DISCOVERY_EN, newConfig.discovery_enabled);
+    preferences.putBool(KEY_COMPACT_MODE, newConfig.compact_mode);
 
     preferences.end();
 
-    // Update local config
+    // Update local config (the chip ID is derived from the MAC, not part of the saved settings)
+    char chipId[sizeof(config.chip_id)];
+    memcpy(chipId, config.chip_id, sizeof(chipId));
     config = newConfig;
+    memcpy(config.chip_id, chipId, sizeof(chipId));
     config.timestamp = millis();
+    buildTopics();
 
     Serial.println("[MQTT] Configuration saved successfully");
     Serial.printf("[MQTT] Broker: %s:%d, Device ID: %s, Enabled: %s\n",
@@ -149,6 +230,7 @@ void MQTTManager::loadMQTTConfig() {
 
     if (!preferences.begin(PREF_NAMESPACE, true)) {
         Serial.println("[MQTT] No saved configuration found, using defaults");
+        buildTopics();
         return;
     }
 
@@ -160,12 +242,14 @@ void MQTTManager::loadMQTTConfig() {
     preferences.getString(KEY_DEVICE_ID, config.device_id, sizeof(config.device_id));
     config.publish_interval_ms = preferences.getUShort(KEY_PUBLISH_INTERVAL, 5000);
     config.discovery_enabled = preferences.getBool(KEY_DISCOVERY_EN, false);
+    config.compact_mode = preferences.getBool(KEY_COMPACT_MODE, false);  // Existing setups keep per-topic publishing
 
     preferences.end();
+    buildTopics();
 
-    Serial.printf("[MQTT] Loaded config - Broker: %s:%d, Device ID: %s, Enabled: %s\n",
+    Serial.printf("[MQTT] Loaded config - Broker: %s:%d, Device ID: %s, Enabled: %s, Mode: %s\n",
                   config.broker_host, config.broker_port, config.device_id,
-                  config.enabled ? "YES" : "NO");
+                  config.enabled ? "YES" : "NO", config.compact_mode ? "compact" : "per-topic");
 }
 
 bool MQTTManager::connect() {
@@ -190,10 +274,10 @@ bool MQTTManager::connect() {
     }
 
     // Use topic device ID as MQTT client ID (includes chip ID for uniqueness)
-    String clientId = getTopicDeviceId();
+    const char* clientId = topicDeviceId;
 
     Serial.printf("[MQTT] Connecting to broker %s:%d as '%s'...\n",
-                  config.broker_host, config.broker_port, clientId.c_str());
+                  config.broker_host, config.broker_port, clientId);
 
     mqttClient->setServer(config.broker_host, config.broker_port);
 
@@ -201,9 +285,9 @@ bool MQTTManager::connect() {
 
     // Connect with or without authentication
     if (strlen(config.username) > 0 && strlen(config.password) > 0) {
-        connected = mqttClient->connect(clientId.c_str(), config.username, config.password);
+        connected = mqttClient->connect(clientId, config.username, config.password);
     } else {
-        connected = mqttClient->connect(clientId.c_str());
+        connected = mqttClient->connect(clientId);
     }
 
     if (connected) {
@@ -268,124 +352,134 @@ String MQTTManager::getConnectionStatus() const {
 }
 
 bool MQTTManager::publishSensorData(const SensorData& data) {
+    if (!initialized || !config.enabled) {
+        return false;
+    }
+
+    unsigned long now = millis();
     if (!isConnected()) {
+        // Keep the sample for backfill, at the publish interval
+        if (now - lastPublishTime >= config.publish_interval_ms) {
+            queueSample(data);
+            lastPublishTime = now;
+        }
         return false;
     }
 
     // Check publish interval
-    unsigned long now = millis();
     if (now - lastPublishTime < config.publish_interval_ms) {
         return true;  // Not an error, just skipping
     }
 
     bool success = true;
 
+    // Per-topic mode: one retained message per value and state. Compact mode
+    // sends only the combined JSON below (one broker write per cycle).
+    bool perTopic = data.valid && !config.compact_mode;
+
     // Publish individual sensor topics
-    if (data.valid) {
+    if (perTopic) {
         char payload[32];
 
         // Primary sensors
         // Temperature
         snprintf(payload, sizeof(payload), "%.2f", data.temp_c);
-        success &= mqttClient->publish(getTelemetryTopic("temperature").c_str(), payload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_TEMPERATURE), payload, true);
 
         // ORP
         snprintf(payload, sizeof(payload), "%.1f", data.orp_mv);
-        success &= mqttClient->publish(getTelemetryTopic("orp").c_str(), payload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_ORP), payload, true);
 
         // pH
         snprintf(payload, sizeof(payload), "%.2f", data.ph);
-        success &= mqttClient->publish(getTelemetryTopic("ph").c_str(), payload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_PH), payload, true);
 
         // EC
         snprintf(payload, sizeof(payload), "%.3f", data.ec_ms_cm);
-        success &= mqttClient->publish(getTelemetryTopic("ec").c_str(), payload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_EC), payload, true);
 
         // Derived metrics
         // TDS
         snprintf(payload, sizeof(payload), "%.1f", data.tds_ppm);
-        success &= mqttClient->publish(getTelemetryTopic("tds").c_str(), payload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_TDS), payload, true);
 
         // CO2
         snprintf(payload, sizeof(payload), "%.2f", data.co2_ppm);
-        success &= mqttClient->publish(getTelemetryTopic("co2").c_str(), payload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_CO2), payload, true);
 
         // NH3 Fraction (as percentage 0-100)
         // Topic name is self-describing: "nh3_fraction_percent"
         snprintf(payload, sizeof(payload), "%.2f", data.nh3_ratio * 100.0);
-        success &= mqttClient->publish(getTelemetryTopic("nh3_fraction_percent").c_str(), payload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_NH3_FRACTION), payload, true);
 
         // NH3 PPM (toxic ammonia concentration)
         snprintf(payload, sizeof(payload), "%.3f", data.nh3_ppm);
-        success &= mqttClient->publish(getTelemetryTopic("nh3_ppm").c_str(), payload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_NH3_PPM), payload, true);
 
         // Max DO
         snprintf(payload, sizeof(payload), "%.2f", data.max_do_mg_l);
-        success &= mqttClient->publish(getTelemetryTopic("max_do").c_str(), payload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_MAX_DO), payload, true);
 
         // Stocking Density
         snprintf(payload, sizeof(payload), "%.2f", data.stocking_density);
-        success &= mqttClient->publish(getTelemetryTopic("stocking").c_str(), payload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_STOCKING), payload, true);
     }
 
     // Publish warning state topics
-    if (data.valid) {
+    if (perTopic) {
         char statePayload[16];
 
         // Temperature state
         snprintf(statePayload, sizeof(statePayload), "%d", data.temp_state);
-        success &= mqttClient->publish(getTelemetryTopic("temp_state").c_str(), statePayload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_TEMP_STATE), statePayload, true);
 
         // pH state
         snprintf(statePayload, sizeof(statePayload), "%d", data.ph_state);
-        success &= mqttClient->publish(getTelemetryTopic("ph_state").c_str(), statePayload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_PH_STATE), statePayload, true);
 
         // NH3 state
         snprintf(statePayload, sizeof(statePayload), "%d", data.nh3_state);
-        success &= mqttClient->publish(getTelemetryTopic("nh3_state").c_str(), statePayload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_NH3_STATE), statePayload, true);
 
         // ORP state
         snprintf(statePayload, sizeof(statePayload), "%d", data.orp_state);
-        success &= mqttClient->publish(getTelemetryTopic("orp_state").c_str(), statePayload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_ORP_STATE), statePayload, true);
 
         // EC state
         snprintf(statePayload, sizeof(statePayload), "%d", data.ec_state);
-        success &= mqttClient->publish(getTelemetryTopic("ec_state").c_str(), statePayload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_EC_STATE), statePayload, true);
 
         // DO state
         snprintf(statePayload, sizeof(statePayload), "%d", data.do_state);
-        success &= mqttClient->publish(getTelemetryTopic("do_state").c_str(), statePayload, true);
+        success &= mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_DO_STATE), statePayload, true);
     }
 
-    // Also publish combined JSON payload
-    JsonDocument doc;
-    // Primary sensors
-    doc["temperature_c"] = data.temp_c;
-    doc["orp_mv"] = data.orp_mv;
-    doc["ph"] = data.ph;
-    doc["ec_ms_cm"] = data.ec_ms_cm;
-    // Derived metrics
-    doc["tds_ppm"] = data.tds_ppm;
-    doc["co2_ppm"] = data.co2_ppm;
-    doc["nh3_ratio"] = data.nh3_ratio;
-    doc["nh3_ppm"] = data.nh3_ppm;
-    doc["max_do_mg_l"] = data.max_do_mg_l;
-    doc["stocking_density"] = data.stocking_density;
-    // Warning states
-    doc["temp_state"] = data.temp_state;
-    doc["ph_state"] = data.ph_state;
-    doc["nh3_state"] = data.nh3_state;
-    doc["orp_state"] = data.orp_state;
-    doc["ec_state"] = data.ec_state;
-    doc["do_state"] = data.do_state;
-    doc["valid"] = data.valid;
-    doc["timestamp"] = now;
-
-    String jsonPayload;
-    serializeJson(doc, jsonPayload);
-
-    success &= mqttClient->publish(getTelemetryTopic("sensors").c_str(),
-                                    jsonPayload.c_str(), true);
+    // Also publish combined JSON payload (formatted in place, no heap allocation)
+    MQTTOutboxRecord sample;
+    toOutboxRecord(data, 0, sample);
+    char jsonPayload[MQTT_JSON_PAYLOAD_SIZE] = "{";
+    size_t length = 1;
+    // Sensor values, derived metrics and warning states
+    appendSampleJson(jsonPayload, sizeof(jsonPayload), length, sample);
+    // Validity and uptime
+    if (length < sizeof(jsonPayload)) {
+        int written = snprintf(jsonPayload + length, sizeof(jsonPayload) - length,
+                               ",\"valid\":%s,\"timestamp\":%lu}", data.valid ? "true" : "false", now);
+        length += written > 0 ? written : 0;
+    }
+
+    if (length >= sizeof(jsonPayload)) {
+        lastError = "Combined JSON payload too large";
+        Serial.println("[MQTT] ERROR: " + lastError);
+        return false;
+    }
+
+    if (!mqttClient->publish(getTelemetryTopic(MQTT_TOPIC_SENSORS), jsonPayload, true)) {
+        // The broker never got this sample: keep it for backfill instead of retrying it live
+        queueSample(data);
+        lastPublishTime = now;
+        return false;
+    }
 
     if (success) {
         lastPublishTime = now;
@@ -402,19 +496,25 @@ bool MQTTManager::publishDiscovery() {
     Serial.println("[MQTT] Publishing Home Assistant Discovery messages...");
 
     // Get device identifiers
-    String topicDeviceId = getTopicDeviceId();  // e.g., "kates_aquarium_7-A1B2C3"
     String friendlyName = String(config.device_id);  // User's friendly name (e.g., "Kate's Aquarium #7")
 
-    // Helper lambda to publish discovery for a sensor
-    auto publishSensor = [this, &topicDeviceId, &friendlyName](const char* sensorName, const char* deviceClass,
-                                 const char* unit, const char* icon) -> bool {
+    // Helper lambda to publish discovery for a sensor. In compact mode every entity
+    // reads the combined JSON topic and extracts its value with valueTemplate.
+    auto publishSensor = [this, &friendlyName](MQTTTopic sensor, const char* deviceClass,
+                                 const char* unit, const char* icon, const char* valueTemplate) -> bool {
+        const char* sensorName = TOPIC_NAMES[sensor];
         JsonDocument doc;
 
         // Entity name uses friendly unit name for display
         doc["name"] = friendlyName + " " + String(sensorName);
         // Unique ID uses topic device ID (includes chip ID) to guarantee uniqueness
-        doc["unique_id"] = topicDeviceId + "_" + String(sensorName);
-        doc["state_topic"] = getTelemetryTopic(sensorName);
+        doc["unique_id"] = String(topicDeviceId) + "_" + String(sensorName);
+        if (config.compact_mode) {
+            doc["state_topic"] = getTelemetryTopic(MQTT_TOPIC_SENSORS);
+            doc["value_template"] = valueTemplate;
+        } else {
+            doc["state_topic"] = getTelemetryTopic(sensor);
+        }
         doc["device_class"] = deviceClass;
         doc["unit_of_measurement"] = unit;
         doc["icon"] = icon;
@@ -430,24 +530,35 @@ bool MQTTManager::publishDiscovery() {
         String payload;
         serializeJson(doc, payload);
 
-        String topic = getDiscoveryTopic(sensorName);
-        return mqttClient->publish(topic.c_str(), payload.c_str(), true);
+        char topic[MQTT_TOPIC_SIZE + 16];
+        getDiscoveryTopic(sensor, topic, sizeof(topic));
+        return mqttClient->publish(topic, payload.c_str(), true);
     };
 
     bool success = true;
     // Primary sensors
-    success &= publishSensor("temperature", "temperature", "°C", "mdi:thermometer");
-    success &= publishSensor("orp", "voltage", "mV", "mdi:flash");
-    success &= publishSensor("ph", "", "pH", "mdi:ph");
-    success &= publishSensor("ec", "voltage", "mS/cm", "mdi:water-percent");
+    success &= publishSensor(MQTT_TOPIC_TEMPERATURE, "temperature", "°C", "mdi:thermometer",
+                             "{{ value_json.temperature_c }}");
+    success &= publishSensor(MQTT_TOPIC_ORP, "voltage", "mV", "mdi:flash",
+                             "{{ value_json.orp_mv }}");
+    success &= publishSensor(MQTT_TOPIC_PH, "", "pH", "mdi:ph",
+                             "{{ value_json.ph }}");
+    success &= publishSensor(MQTT_TOPIC_EC, "voltage", "mS/cm", "mdi:water-percent",
+                             "{{ value_json.ec_ms_cm }}");
 
     // Derived metrics
-    success &= publishSensor("tds", "", "ppm", "mdi:water-opacity");
-    success &= publishSensor("co2", "", "ppm", "mdi:molecule-co2");
-    success &= publishSensor("nh3_fraction_percent", "", "%", "mdi:alert-circle");
-    success &= publishSensor("nh3_ppm", "", "ppm", "mdi:biohazard");
-    success &= publishSensor("max_do", "", "mg/L", "mdi:air-filter");
-    success &= publishSensor("stocking", "", "cm/L", "mdi:fish");
+    success &= publishSensor(MQTT_TOPIC_TDS, "", "ppm", "mdi:water-opacity",
+                             "{{ value_json.tds_ppm }}");
+    success &= publishSensor(MQTT_TOPIC_CO2, "", "ppm", "mdi:molecule-co2",
+                             "{{ value_json.co2_ppm }}");
+    success &= publishSensor(MQTT_TOPIC_NH3_FRACTION, "", "%", "mdi:alert-circle",
+                             "{{ (value_json.nh3_ratio * 100) | round(2) }}");
+    success &= publishSensor(MQTT_TOPIC_NH3_PPM, "", "ppm", "mdi:biohazard",
+                             "{{ value_json.nh3_ppm }}");
+    success &= publishSensor(MQTT_TOPIC_MAX_DO, "", "mg/L", "mdi:air-filter",
+                             "{{ value_json.max_do_mg_l }}");
+    success &= publishSensor(MQTT_TOPIC_STOCKING, "", "cm/L", "mdi:fish",
+                             "{{ value_json.stocking_density }}");
 
     if (success) {
         Serial.println("[MQTT] Discovery messages published successfully");
@@ -470,62 +581,134 @@ void MQTTManager::generateChipId() {
     Serial.printf("[MQTT] Generated chip ID: %s\n", config.chip_id);
 }
 
-String MQTTManager::sanitizeForTopic(const String& name) const {
+void MQTTManager::sanitizeForTopic(const char* name, char* buffer, size_t size) {
     // Convert to lowercase, replace spaces and special chars with underscores
     // Only allow alphanumeric and underscores for MQTT topic compatibility
-    String result = "";
-    for (size_t i = 0; i < name.length() && result.length() < 24; i++) {
-        char c = name.charAt(i);
+    size_t limit = size - 1 < 24 ? size - 1 : 24;
+    size_t length = 0;
+    for (const char* p = name; *p != '\0' && length < limit; p++) {
+        char c = *p;
         if (c >= 'A' && c <= 'Z') {
-            result += (char)(c + 32);  // Convert to lowercase
+            buffer[length++] = (char)(c + 32);  // Convert to lowercase
         } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
-            result += c;
+            buffer[length++] = c;
         } else if (c == ' ' || c == '-' || c == '_') {
             // Avoid consecutive underscores
-            if (result.length() == 0 || result.charAt(result.length() - 1) != '_') {
-                result += '_';
+            if (length == 0 || buffer[length - 1] != '_') {
+                buffer[length++] = '_';
             }
         }
         // Skip other special characters (apostrophes, #, etc.)
     }
     // Remove trailing underscore
-    while (result.length() > 0 && result.charAt(result.length() - 1) == '_') {
-        result = result.substring(0, result.length() - 1);
+    while (length > 0 && buffer[length - 1] == '_') {
+        length--;
     }
+    buffer[length] = '\0';
     // Default if empty
-    if (result.length() == 0) {
-        result = "aquarium";
+    if (length == 0) {
+        strncpy(buffer, "aquarium", size - 1);
+        buffer[size - 1] = '\0';
     }
-    return result;
 }
 
-String MQTTManager::getTopicDeviceId() const {
-    // Format: sanitized_unit_name-CHIPID
+void MQTTManager::buildTopics() {
+    // Device ID format: sanitized_unit_name-CHIPID
     // Example: "kates_aquarium_7-A1B2C3"
     // This ensures uniqueness even if users name all units the same
-    String sanitized = sanitizeForTopic(String(config.device_id));
-    return sanitized + "-" + String(config.chip_id);
+    char sanitized[25];
+    sanitizeForTopic(config.device_id, sanitized, sizeof(sanitized));
+    snprintf(topicDeviceId, sizeof(topicDeviceId), "%s-%s", sanitized, config.chip_id);
+
+    for (int topic = 0; topic < MQTT_TOPIC_COUNT; topic++) {
+        snprintf(telemetryTopics[topic], MQTT_TOPIC_SIZE, "aquarium/%s/telemetry/%s",
+                 topicDeviceId, TOPIC_NAMES[topic]);
+    }
+    snprintf(backfillTopic, sizeof(backfillTopic), "aquarium/%s/backfill", topicDeviceId);
 }
 
-String MQTTManager::getBaseTopic() const {
-    return String("aquarium/") + getTopicDeviceId();
+void MQTTManager::getDiscoveryTopic(MQTTTopic topic, char* buffer, size_t size) const {
+    snprintf(buffer, size, "homeassistant/sensor/%s/%s/config", topicDeviceId, TOPIC_NAMES[topic]);
 }
 
-String MQTTManager::getTelemetryTopic(const char* sensor) const {
-    return getBaseTopic() + "/telemetry/" + sensor;
+bool MQTTManager::attemptReconnect() {
+    Serial.println("[MQTT] Attempting to reconnect...");
+    if (!connect()) {
+        return false;
+    }
+
+    if (!outbox.isEmpty()) {
+        Serial.printf("[MQTT] Backfilling %lu queued samples\n", (unsigned long)outbox.getCount());
+        lastBackfillTime = millis();  // First batch after the live topics have settled
+    }
+    return true;
 }
 
-String MQTTManager::getStateTopic(const char* state) const {
-    return getBaseTopic() + "/state/" + state;
+void MQTTManager::setOutboxStorage(fs::FS& fs) {
+    outbox.begin(fs);
 }
 
-String MQTTManager::getDiscoveryTopic(const char* sensor) const {
-    return String("homeassistant/sensor/") + getTopicDeviceId() + "/" + sensor + "/config";
+void MQTTManager::queueSample(const SensorData& data) {
+    time_t now = time(nullptr);
+    if (!data.valid || now < (time_t)MQTT_TIME_VALID_MIN) {
+        return;  // Nothing to report, or no wall-clock time to tag it with
+    }
+
+    if (outbox.isEmpty()) {
+        Serial.println("[MQTT] Broker unreachable, queueing samples for backfill");
+    }
+    uint32_t dropped = outbox.getDropped();
+
+    MQTTOutboxRecord record;
+    toOutboxRecord(data, (uint32_t)now, record);
+    outbox.push(record);
+
+    if (outbox.getDropped() != dropped && dropped == 0) {
+        Serial.println("[MQTT] Backfill outbox full, dropping the oldest samples");
+    }
 }
 
-bool MQTTManager::attemptReconnect() {
-    Serial.println("[MQTT] Attempting to reconnect...");
-    return connect();
+void MQTTManager::drainOutbox() {
+    MQTTOutboxRecord records[MQTT_BACKFILL_BATCH_RECORDS];
+    size_t available = outbox.peek(records, MQTT_BACKFILL_BATCH_RECORDS);
+    if (available == 0) {
+        return;
+    }
+
+    // JSON array of samples, oldest first, with "time" in Unix seconds
+    char payload[MQTT_BACKFILL_PAYLOAD_SIZE] = "[";
+    size_t length = 1;
+    size_t batched = 0;
+    while (batched < available) {
+        size_t start = length;
+        int written = snprintf(payload + length, sizeof(payload) - length, "%s{\"time\":%lu",
+                               batched > 0 ? "," : "", (unsigned long)records[batched].timestamp);
+        length += written > 0 ? written : 0;
+        appendSampleJson(payload, sizeof(payload), length, records[batched]);
+        if (length + 2 >= sizeof(payload)) {
+            length = start;  // Room for "}]" only without this sample
+            break;
+        }
+        payload[length++] = '}';
+        batched++;
+    }
+    payload[length++] = ']';
+    payload[length] = '\0';
+
+    lastBackfillTime = millis();
+    if (batched == 0) {
+        Serial.println("[MQTT] Backfill sample too large for a batch, skipped");
+        outbox.pop(1);
+        return;
+    }
+    if (!mqttClient->publish(backfillTopic, payload, false)) {
+        return;  // Retried on the next interval (or after reconnecting)
+    }
+
+    outbox.pop(batched);
+    if (outbox.isEmpty()) {
+        Serial.println("[MQTT] Backfill complete");
+    }
 }
 
 void MQTTManager::messageCallback(char* topic, byte* payload, unsigned int length) {
@@ -5,6 +5,48 @@
 #include <PubSubClient.h>
 #include <Preferences.h>
 #include <ArduinoJson.h>
+#include "MQTTOutbox.h"
+
+// Telemetry topics under aquarium/<unit>-<chip_id>/telemetry/
+enum MQTTTopic {
+    MQTT_TOPIC_TEMPERATURE,
+    MQTT_TOPIC_ORP,
+    MQTT_TOPIC_PH,
+    MQTT_TOPIC_EC,
+    MQTT_TOPIC_TDS,
+    MQTT_TOPIC_CO2,
+    MQTT_TOPIC_NH3_FRACTION,
+    MQTT_TOPIC_NH3_PPM,
+    MQTT_TOPIC_MAX_DO,
+    MQTT_TOPIC_STOCKING,
+    MQTT_TOPIC_TEMP_STATE,
+    MQTT_TOPIC_PH_STATE,
+    MQTT_TOPIC_NH3_STATE,
+    MQTT_TOPIC_ORP_STATE,
+    MQTT_TOPIC_EC_STATE,
+    MQTT_TOPIC_DO_STATE,
+    MQTT_TOPIC_SENSORS,  // Combined JSON payload
+    MQTT_TOPIC_COUNT
+};
+
+// Topic buffers: sanitized unit name (24) + "-" + chip ID (6), and the longest telemetry topic
+#define MQTT_DEVICE_ID_SIZE 32
+#define MQTT_TOPIC_SIZE 80
+
+// Combined JSON payload, formatted on the stack
+#define MQTT_JSON_PAYLOAD_SIZE 512
+
+// Backfill: samples queued while the broker was unreachable are sent as JSON
+// arrays of up to MQTT_BACKFILL_BATCH_RECORDS samples, one batch per interval
+#define MQTT_BACKFILL_PAYLOAD_SIZE 1400
+#define MQTT_BACKFILL_BATCH_RECORDS 4   // About 320 bytes of JSON each (fewer fit if longer)
+#define MQTT_BACKFILL_INTERVAL_MS 250
+
+// PubSubClient buffer: a full backfill batch plus topic and header
+#define MQTT_BUFFER_SIZE 1536
+
+// Samples are only queued with a synced clock (2024-01-01, as the history store)
+#define MQTT_TIME_VALID_MIN 1704067200UL
 
 struct MQTTConfiguration {
     bool enabled;
@@ -15,6 +57,7 @@ struct MQTTConfiguration {
     char device_id[32];              // User-assigned unit name (friendly name)
     uint16_t publish_interval_ms;    // Publish frequency in milliseconds
     bool discovery_enabled;          // Home Assistant MQTT Discovery
+    bool compact_mode;               // Publish only the combined JSON topic (discovery uses value_template)
     unsigned long timestamp;
     char chip_id[7];                 // 6-char hex chip ID + null (derived from MAC, read-only)
 };
@@ -67,6 +110,11 @@ public:
     bool publishSensorData(const SensorData& data);
     bool publishDiscovery();  // Home Assistant MQTT Discovery
 
+    // Spill the backfill outbox to a mounted file system (and resume a backlog from before a reboot)
+    void setOutboxStorage(fs::FS& fs);
+    uint32_t getBackfillPending() const { return outbox.getCount(); }
+    uint32_t getBackfillDropped() const { return outbox.getDropped(); }
+
     // Get last error message
     String getLastError() const;
 
@@ -85,20 +133,32 @@ private:
     static const unsigned long MAX_RECONNECT_INTERVAL = 60000;  // Maximum backoff: 60 seconds
     unsigned long currentReconnectInterval;  // Dynamic interval with exponential backoff
 
+    // Samples missed while disconnected, drained to the backfill topic once connected
+    MQTTOutbox outbox;
+    unsigned long lastBackfillTime;
+
+    // Topic names, rebuilt by buildTopics() whenever the config is loaded or saved,
+    // so the publish path never builds a String
+    char topicDeviceId[MQTT_DEVICE_ID_SIZE];           // e.g. "kates_aquarium_7-A1B2C3"
+    char telemetryTopics[MQTT_TOPIC_COUNT][MQTT_TOPIC_SIZE];
+    char backfillTopic[MQTT_TOPIC_SIZE];               // aquarium/<id>/backfill
+
     // Topic helpers
-    String getBaseTopic() const;
-    String getTelemetryTopic(const char* sensor) const;
-    String getStateTopic(const char* state) const;
-    String getDiscoveryTopic(const char* sensor) const;
+    void buildTopics();
+    const char* getTelemetryTopic(MQTTTopic topic) const { return telemetryTopics[topic]; }
+    void getDiscoveryTopic(MQTTTopic topic, char* buffer, size_t size) const;
 
     // Device ID helpers
     void generateChipId();                     // Generate chip ID from MAC address
-    String sanitizeForTopic(const String& name) const;  // Sanitize name for MQTT topics
-    String getTopicDeviceId() const;           // Get sanitized device ID for topics
+    static void sanitizeForTopic(const char* name, char* buffer, size_t size);  // Sanitize name for MQTT topics
 
     // Reconnection logic
     bool attemptReconnect();
 
+    // Backfill
+    void queueSample(const SensorData& data);
+    void drainOutbox();
+
     // Callback for subscribed messages
     static void messageCallback(char* topic, byte* payload, unsigned int length);
 };
@@ -0,0 +1,130 @@
+#include "MQTTOutbox.h"
+
+static_assert(sizeof(MQTTOutboxRecord) == 52, "Spill file records must keep their size");
+
+MQTTOutbox::MQTTOutbox()
+    : head(0), count(0), fs(nullptr), spillCount(0), spillRead(0), spillTorn(false), dropped(0) {
+}
+
+uint32_t MQTTOutbox::begin(fs::FS& fileSystem) {
+    fs = &fileSystem;
+    spillCount = 0;
+    spillRead = 0;
+    spillTorn = false;
+
+    if (fs->exists(MQTT_OUTBOX_SPILL_PATH)) {
+        File file = fs->open(MQTT_OUTBOX_SPILL_PATH, FILE_READ);
+        if (file) {
+            spillCount = file.size() / sizeof(MQTTOutboxRecord);  // A torn last record is ignored
+            spillTorn = file.size() % sizeof(MQTTOutboxRecord) != 0;
+            file.close();
+        }
+        if (spillCount == 0) {
+            fs->remove(MQTT_OUTBOX_SPILL_PATH);
+            spillTorn = false;
+        } else {
+            Serial.printf("[MQTT] Outbox: %lu samples from before the restart queued for backfill\n",
+                          (unsigned long)spillCount);
+        }
+    }
+    return spillCount;
+}
+
+void MQTTOutbox::push(const MQTTOutboxRecord& record) {
+    if (count == MQTT_OUTBOX_RAM_RECORDS && !spillRing()) {
+        // Nowhere to spill: drop the oldest sample in the ring
+        head = (head + 1) % MQTT_OUTBOX_RAM_RECORDS;
+        count--;
+        dropped++;
+    }
+    ring[(head + count) % MQTT_OUTBOX_RAM_RECORDS] = record;
+    count++;
+}
+
+bool MQTTOutbox::spillRing() {
+    if (fs == nullptr || spillTorn || spillCount + count > MQTT_OUTBOX_SPILL_MAX_RECORDS) {
+        return false;
+    }
+
+    File file = fs->open(MQTT_OUTBOX_SPILL_PATH, FILE_APPEND);
+    if (!file) {
+        return false;
+    }
+
+    // The ring may wrap: write it as up to two contiguous runs
+    int first = min(count, MQTT_OUTBOX_RAM_RECORDS - head);
+    size_t bytes = file.write((const uint8_t*)&ring[head], first * sizeof(MQTTOutboxRecord));
+    if (count > first) {
+        bytes += file.write((const uint8_t*)&ring[0], (count - first) * sizeof(MQTTOutboxRecord));
+    }
+    file.close();
+
+    if (bytes != count * sizeof(MQTTOutboxRecord)) {
+        // Partial write (flash full): the ring keeps every sample and the file is
+        // only read up to spillCount; stop appending until it has been sent
+        if (spillCount == 0) {
+            fs->remove(MQTT_OUTBOX_SPILL_PATH);
+        } else {
+            spillTorn = true;
+        }
+        Serial.println("[MQTT] Outbox: spill write failed");
+        return false;
+    }
+
+    spillCount += count;
+    head = 0;
+    count = 0;
+    return true;
+}
+
+size_t MQTTOutbox::peek(MQTTOutboxRecord* records, size_t maxRecords) {
+    // Spilled records are older than anything in the ring
+    if (spillRead < spillCount) {
+        File file = fs->open(MQTT_OUTBOX_SPILL_PATH, FILE_READ);
+        if (!file || !file.seek(spillRead * sizeof(MQTTOutboxRecord))) {
+            return 0;
+        }
+        size_t wanted = min((size_t)(spillCount - spillRead), maxRecords);
+        size_t bytes = file.read((uint8_t*)records, wanted * sizeof(MQTTOutboxRecord));
+        file.close();
+        return bytes / sizeof(MQTTOutboxRecord);
+    }
+
+    size_t copied = 0;
+    while (copied < maxRecords && copied < (size_t)count) {
+        records[copied] = ring[(head + copied) % MQTT_OUTBOX_RAM_RECORDS];
+        copied++;
+    }
+    return copied;
+}
+
+void MQTTOutbox::pop(size_t removed) {
+    if (spillRead < spillCount) {
+        spillRead += min((uint32_t)removed, spillCount - spillRead);
+        if (spillRead == spillCount) {
+            // Spill fully sent
+            fs->remove(MQTT_OUTBOX_SPILL_PATH);
+            spillCount = 0;
+            spillRead = 0;
+            spillTorn = false;
+        }
+        return;
+    }
+
+    if (removed > (size_t)count) {
+        removed = count;
+    }
+    head = (head + removed) % MQTT_OUTBOX_RAM_RECORDS;
+    count -= removed;
+}
+
+void MQTTOutbox::clear() {
+    head = 0;
+    count = 0;
+    if (fs != nullptr && (spillCount > 0 || spillTorn)) {
+        fs->remove(MQTT_OUTBOX_SPILL_PATH);
+    }
+    spillCount = 0;
+    spillRead = 0;
+    spillTorn = false;
+}
@@ -0,0 +1,90 @@
+#ifndef MQTT_OUTBOX_H
+#define MQTT_OUTBOX_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// Samples kept in RAM while the broker is unreachable (64 x 52 bytes, ~5 minutes at 5 s)
+#define MQTT_OUTBOX_RAM_RECORDS 64
+
+// Spill file for longer outages (4096 x 52 bytes = 208 KB, ~5.7 hours at 5 s).
+// Shares the LittleFS data partition with the 1 MB history log; main.cpp
+// checks that both caps fit together.
+#define MQTT_OUTBOX_SPILL_PATH "/mqtt_outbox.bin"
+#define MQTT_OUTBOX_SPILL_MAX_RECORDS 4096
+
+// Values and warning states per record, in combined JSON payload order
+#define MQTT_OUTBOX_VALUES 10
+#define MQTT_OUTBOX_STATES 6
+
+// One sample waiting for backfill (52 bytes, also the spill file record)
+struct MQTTOutboxRecord {
+    uint32_t timestamp;  // Unix seconds
+    float values[MQTT_OUTBOX_VALUES];
+    uint8_t states[MQTT_OUTBOX_STATES];
+    uint8_t reserved[2];
+};
+
+/**
+ * MQTTOutbox - Bounded store-and-forward queue of samples for MQTT backfill
+ *
+ * Samples are queued in a RAM ring. With a file system attached, a full ring
+ * is appended to a spill file in one write and emptied, so an outage only
+ * costs one flash write per MQTT_OUTBOX_RAM_RECORDS samples. The spill file
+ * always holds older samples than the ring, so peek() serves the file first
+ * and the order is kept. When both are full the oldest sample in the ring is
+ * overwritten and counted as dropped.
+ *
+ * The read position in the spill file is kept in RAM only: a spill left by a
+ * reboot is picked up by begin() and sent again from its start, so samples
+ * sent just before the reboot may be backfilled twice.
+ *
+ * A short write (flash full) leaves a torn tail that cannot be truncated
+ * away. Only the records counted before it are read, the ring keeps the
+ * samples, and nothing more is appended until the file has been sent and
+ * removed, so reads stay on record boundaries.
+ */
+class MQTTOutbox {
+public:
+    MQTTOutbox();
+
+    /**
+     * Attach a mounted file system for spilling and pick up a spill file left by a previous boot
+     * @return Number of spilled records pending
+     */
+    uint32_t begin(fs::FS& fs);
+
+    // Queue a sample (overwrites the oldest queued sample when full)
+    void push(const MQTTOutboxRecord& record);
+
+    /**
+     * Copy the oldest pending records without removing them
+     * @return Number of records copied (0 if empty)
+     */
+    size_t peek(MQTTOutboxRecord* records, size_t maxRecords);
+
+    // Remove the oldest count records (after peek() and a successful send)
+    void pop(size_t count);
+
+    // Drop all pending records, including the spill file
+    void clear();
+
+    uint32_t getCount() const { return (spillCount - spillRead) + count; }
+    bool isEmpty() const { return getCount() == 0; }
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    MQTTOutboxRecord ring[MQTT_OUTBOX_RAM_RECORDS];
+    int head;   // Oldest record in the ring
+    int count;
+
+    fs::FS* fs;
+    uint32_t spillCount;  // Records in the spill file
+    uint32_t spillRead;   // Records of the spill file already sent
+    bool spillTorn;       // The spill file ends in a partial write: no more appends
+    uint32_t dropped;
+
+    bool spillRing();
+};
+
+#endif // MQTT_OUTBOX_H
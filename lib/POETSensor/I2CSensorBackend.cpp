@@ -0,0 +1,104 @@
+#include "I2CSensorBackend.h"
+
+I2CSensorBackend::I2CSensorBackend(TwoWire& wireBus)
+    : wire(wireBus) {
+}
+
+/**
+ * Initialize I2C and check for POET sensor presence
+ */
+bool I2CSensorBackend::begin() {
+    // Initialize I2C with standard SDA/SCL pins
+    wire.begin();
+    wire.setClock(I2C_FREQ);
+
+    // Check if device responds
+    wire.beginTransmission(POET_I2C_ADDR);
+    uint8_t error = wire.endTransmission();
+
+    return (error == 0);  // 0 = success
+}
+
+/**
+ * Start a measurement by sending the command byte to POET
+ * @param command Bit mask of measurements to perform (CMD_TEMPERATURE, CMD_ORP, CMD_PH, CMD_EC)
+ * @return true if the sensor acknowledged the command
+ */
+bool I2CSensorBackend::startMeasurement(uint8_t command) {
+    wire.beginTransmission(POET_I2C_ADDR);
+    wire.write(command);
+    uint8_t error = wire.endTransmission();
+
+    if (error != 0) {
+        Serial.printf("[POET] I2C transmission error: %d\n", error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Read the result of a previously started measurement
+ * @param command Bit mask that was sent with startMeasurement()
+ * @param out Reference to POETResult structure to store results
+ * @return true if all expected bytes were received
+ */
+bool I2CSensorBackend::readMeasurement(uint8_t command, POETResult& out) {
+    // Calculate expected number of bytes based on command
+    uint8_t expected_bytes = 0;
+    if (command & CMD_TEMPERATURE) expected_bytes += 4;
+    if (command & CMD_ORP)        expected_bytes += 4;
+    if (command & CMD_PH)         expected_bytes += 4;
+    if (command & CMD_EC)         expected_bytes += 8;
+
+    // Request data from POET
+    uint8_t bytes_received = wire.requestFrom((uint16_t)POET_I2C_ADDR, (uint8_t)expected_bytes);
+
+    if (bytes_received != expected_bytes) {
+        // Sensor may still be converting - caller retries until its deadline
+        while (wire.available()) {
+            wire.read();
+        }
+        return false;
+    }
+
+    // Read results in order: Temperature, ORP, pH, EC
+    // All values are 32-bit signed integers in little-endian format
+
+    if (command & CMD_TEMPERATURE) {
+        out.temp_mC = readInt32LE();
+    }
+
+    if (command & CMD_ORP) {
+        out.orp_uV = readInt32LE();
+    }
+
+    if (command & CMD_PH) {
+        out.ugs_uV = readInt32LE();
+    }
+
+    if (command & CMD_EC) {
+        out.ec_nA = readInt32LE();
+        out.ec_uV = readInt32LE();
+    }
+
+    return true;
+}
+
+/**
+ * Read 32-bit signed integer in little-endian format from I2C
+ */
+int32_t I2CSensorBackend::readInt32LE() {
+    uint8_t b0 = wire.read();
+    uint8_t b1 = wire.read();
+    uint8_t b2 = wire.read();
+    uint8_t b3 = wire.read();
+
+    // Combine bytes in little-endian order
+    int32_t value = (int32_t)b0 |
+                    ((int32_t)b1 << 8) |
+                    ((int32_t)b2 << 16) |
+                    ((int32_t)b3 << 24);
+
+    return value;
+}
@@ -0,0 +1,30 @@
+#ifndef I2C_SENSOR_BACKEND_H
+#define I2C_SENSOR_BACKEND_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "SensorBackend.h"
+
+/**
+ * I2CSensorBackend - Talks to the POET sensor over I2C (Wire)
+ *
+ * The I2C bus is shared with the OLED display. Arduino-ESP32 serializes
+ * individual Wire transactions internally, and each call here is a single
+ * transaction, so the bus is never held during a conversion.
+ */
+class I2CSensorBackend : public SensorBackend {
+public:
+    explicit I2CSensorBackend(TwoWire& wire = Wire);
+
+    bool begin() override;
+    bool startMeasurement(uint8_t command) override;
+    bool readMeasurement(uint8_t command, POETResult& out) override;
+    const char* getName() const override { return "i2c"; }
+
+private:
+    TwoWire& wire;
+
+    int32_t readInt32LE();
+};
+
+#endif // I2C_SENSOR_BACKEND_H
@@ -0,0 +1,47 @@
+#ifndef POET_PROTOCOL_H
+#define POET_PROTOCOL_H
+
+#include <Arduino.h>
+
+// POET Sensor I2C Configuration
+#define POET_I2C_ADDR 0x1F
+#define I2C_FREQ 400000  // 400 kHz - max supported by POET
+
+// Command byte bits
+#define CMD_TEMPERATURE (1 << 0)  // bit 0
+#define CMD_ORP         (1 << 1)  // bit 1
+#define CMD_PH          (1 << 2)  // bit 2
+#define CMD_EC          (1 << 3)  // bit 3
+#define CMD_ALL         0x0F      // All measurements
+
+// Measurement delays (ms) - from datasheet
+#define DELAY_BASE        100
+#define DELAY_TEMP        384
+#define DELAY_ORP        1664
+#define DELAY_PH          384
+#define DELAY_EC          256
+#define DELAY_ALL_TOTAL  2788  // 100 + 384 + 1664 + 384 + 256
+
+// Measurement channels (index matches the command bit position)
+enum POETChannel {
+    POET_CH_TEMPERATURE = 0,
+    POET_CH_ORP = 1,
+    POET_CH_PH = 2,
+    POET_CH_EC = 3,
+    POET_CHANNEL_COUNT = 4
+};
+
+// Structure to hold POET measurement results
+// Each channel holds its latest reading; updated_ms tells how fresh it is.
+struct POETResult {
+    int32_t temp_mC;   // Temperature in milli-degrees Celsius
+    int32_t orp_uV;    // ORP in micro-volts
+    int32_t ugs_uV;    // pH gate-source potential in micro-volts
+    int32_t ec_nA;     // EC sensor current in nano-Amps
+    int32_t ec_uV;     // EC excitation in micro-volts
+    bool valid;        // All channels have a reading that is not stale
+    uint8_t updated;   // CMD_* bits refreshed by this sample
+    unsigned long updated_ms[POET_CHANNEL_COUNT];  // millis() of each channel's last reading (0 = never)
+};
+
+#endif // POET_PROTOCOL_H
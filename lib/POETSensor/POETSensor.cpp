@@ -0,0 +1,276 @@
+#include "POETSensor.h"
+
+POETSensor::POETSensor(SensorBackend& sensorBackend)
+    : backend(sensorBackend),
+      state(POET_IDLE),
+      currentChannel(-1),
+      stateEnteredAt(0),
+      deadlineMs(0),
+      taskHandle(nullptr) {
+    memset(&result, 0, sizeof(result));
+    memset(&rawResult, 0, sizeof(rawResult));
+
+    filters[FILTER_TEMP].configure(POET_FILTER_WINDOW_FAST, POET_NOISE_TEMP_mC);
+    filters[FILTER_ORP].configure(POET_FILTER_WINDOW_SLOW, POET_NOISE_ORP_uV);
+    filters[FILTER_UGS].configure(POET_FILTER_WINDOW_FAST, POET_NOISE_UGS_uV);
+    filters[FILTER_EC_NA].configure(POET_FILTER_WINDOW_SLOW, POET_NOISE_EC_nA, POET_NOISE_EC_PERMILLE);
+    filters[FILTER_EC_UV].configure(POET_FILTER_WINDOW_SLOW, POET_NOISE_EC_uV, POET_NOISE_EC_PERMILLE);
+
+    channelIntervalMs[POET_CH_TEMPERATURE] = POET_TEMP_INTERVAL_MS;
+    channelIntervalMs[POET_CH_ORP] = POET_ORP_INTERVAL_MS;
+    channelIntervalMs[POET_CH_PH] = POET_PH_INTERVAL_MS;
+    channelIntervalMs[POET_CH_EC] = POET_EC_INTERVAL_MS;
+
+    for (int i = 0; i < POET_CHANNEL_COUNT; i++) {
+        channelStartedAt[i] = 0;
+        channelScheduled[i] = false;
+    }
+}
+
+/**
+ * Initialize the sensor backend and check for POET sensor presence
+ */
+bool POETSensor::begin() {
+    bool present = backend.begin();
+    Serial.printf("[POET] Backend: %s\n", backend.getName());
+    return present;
+}
+
+void POETSensor::setChannelInterval(POETChannel channel, unsigned long interval_ms) {
+    if (channel < POET_CHANNEL_COUNT) {
+        channelIntervalMs[channel] = interval_ms;
+    }
+}
+
+unsigned long POETSensor::getChannelInterval(POETChannel channel) const {
+    return channel < POET_CHANNEL_COUNT ? channelIntervalMs[channel] : 0;
+}
+
+unsigned long POETSensor::getChannelAge(const POETResult& sample, POETChannel channel) {
+    if (channel >= POET_CHANNEL_COUNT || sample.updated_ms[channel] == 0) {
+        return ULONG_MAX;
+    }
+    return millis() - sample.updated_ms[channel];
+}
+
+/**
+ * Advance the POET acquisition state machine by at most one step.
+ * Each state has a deadline measured from when it was entered, so the
+ * datasheet conversion delay is honoured without ever blocking the caller.
+ * @return true when a new result (valid or not) was published
+ */
+bool POETSensor::update() {
+    unsigned long elapsed = millis() - stateEnteredAt;
+    uint8_t command = (currentChannel >= 0) ? (1 << currentChannel) : 0;
+
+    switch (state) {
+        case POET_IDLE: {
+            unsigned long now = millis();
+            int8_t channel = selectDueChannel(now);
+            if (channel >= 0) {
+                currentChannel = channel;
+                channelStartedAt[channel] = now;
+                channelScheduled[channel] = true;
+                enterState(POET_COMMAND_SENT, 0);
+            }
+            return false;
+        }
+
+        case POET_COMMAND_SENT:
+            result.updated = 0;
+            if (!backend.startMeasurement(command)) {
+                enterState(POET_PUBLISH, 0);
+                return false;
+            }
+            enterState(POET_WAIT, getConversionTime(command));
+            return false;
+
+        case POET_WAIT:
+            if (elapsed >= deadlineMs) {
+                enterState(POET_READ, POET_READ_TIMEOUT);
+            }
+            return false;
+
+        case POET_READ:
+            if (backend.readMeasurement(command, rawResult)) {
+                applyFilters(command);
+                unsigned long now = millis();
+                result.updated_ms[currentChannel] = (now != 0) ? now : 1;  // 0 means never read
+                result.updated = command;
+                enterState(POET_PUBLISH, 0);
+            } else if (elapsed >= deadlineMs) {
+                Serial.printf("[POET] ERROR: Timed out waiting for result (command 0x%02X)\n", command);
+                enterState(POET_PUBLISH, 0);
+            }
+            return false;
+
+        case POET_PUBLISH:
+            publish();
+            currentChannel = -1;
+            enterState(POET_IDLE, 0);
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Pick the channel that is most overdue for a conversion
+ * @return Channel index, or -1 if no channel is due yet
+ */
+int8_t POETSensor::selectDueChannel(unsigned long now) const {
+    int8_t selected = -1;
+    unsigned long maxLateness = 0;
+
+    for (int i = 0; i < POET_CHANNEL_COUNT; i++) {
+        if (channelIntervalMs[i] == 0) {
+            continue;  // Channel disabled
+        }
+
+        // Channels never measured are due immediately and take precedence
+        unsigned long lateness;
+        if (!channelScheduled[i]) {
+            lateness = ULONG_MAX;
+        } else {
+            unsigned long since = now - channelStartedAt[i];
+            if (since < channelIntervalMs[i]) {
+                continue;
+            }
+            lateness = since - channelIntervalMs[i];
+        }
+
+        if (selected < 0 || lateness > maxLateness) {
+            selected = i;
+            maxLateness = lateness;
+        }
+    }
+
+    return selected;
+}
+
+void POETSensor::enterState(POETState newState, unsigned long deadline_ms) {
+    state = newState;
+    stateEnteredAt = millis();
+    deadlineMs = deadline_ms;
+}
+
+/**
+ * Run freshly read raw values through their filters into the merged sample
+ */
+void POETSensor::applyFilters(uint8_t cmd) {
+    if (cmd & CMD_TEMPERATURE) {
+        result.temp_mC = filters[FILTER_TEMP].add(rawResult.temp_mC);
+    }
+    if (cmd & CMD_ORP) {
+        result.orp_uV = filters[FILTER_ORP].add(rawResult.orp_uV);
+    }
+    if (cmd & CMD_PH) {
+        result.ugs_uV = filters[FILTER_UGS].add(rawResult.ugs_uV);
+    }
+    if (cmd & CMD_EC) {
+        result.ec_nA = filters[FILTER_EC_NA].add(rawResult.ec_nA);
+        result.ec_uV = filters[FILTER_EC_UV].add(rawResult.ec_uV);
+    }
+}
+
+void POETSensor::publish() {
+    // Sample is valid only while every enabled channel has a fresh reading
+    unsigned long now = millis();
+    bool valid = true;
+    for (int i = 0; i < POET_CHANNEL_COUNT; i++) {
+        if (channelIntervalMs[i] == 0) {
+            continue;
+        }
+        unsigned long maxAge = channelIntervalMs[i] * POET_STALE_PERIODS + DELAY_ALL_TOTAL;
+        if (result.updated_ms[i] == 0 || now - result.updated_ms[i] > maxAge) {
+            valid = false;
+        }
+    }
+    result.valid = valid;
+
+    latest.write(result);
+}
+
+uint32_t POETSensor::getLatest(POETResult& out) const {
+    return latest.read(out);
+}
+
+/**
+ * Time until update() has useful work to do, used by the sampler task to sleep
+ */
+unsigned long POETSensor::getTimeToNextStep() const {
+    unsigned long now = millis();
+
+    switch (state) {
+        case POET_IDLE: {
+            // Sleep until the earliest channel becomes due
+            unsigned long wait_ms = ULONG_MAX;
+            for (int i = 0; i < POET_CHANNEL_COUNT; i++) {
+                if (channelIntervalMs[i] == 0) {
+                    continue;
+                }
+                if (!channelScheduled[i]) {
+                    return 0;
+                }
+                unsigned long since = now - channelStartedAt[i];
+                unsigned long remaining = since >= channelIntervalMs[i] ? 0 : channelIntervalMs[i] - since;
+                wait_ms = min(wait_ms, remaining);
+            }
+            return wait_ms == ULONG_MAX ? 1000 : wait_ms;
+        }
+        case POET_WAIT: {
+            unsigned long elapsed = now - stateEnteredAt;
+            return elapsed >= deadlineMs ? 0 : deadlineMs - elapsed;
+        }
+        case POET_READ:
+            return POET_READ_RETRY_MS;
+        default:
+            return 0;
+    }
+}
+
+bool POETSensor::startTask() {
+    if (taskHandle != nullptr) {
+        return true;
+    }
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        POETSensor::taskEntry, "poet_sampler", POET_TASK_STACK_SIZE, this,
+        POET_TASK_PRIORITY, &taskHandle, POET_TASK_CORE);
+
+    if (created != pdPASS) {
+        taskHandle = nullptr;
+        Serial.println("[POET] ERROR: Failed to create sampler task");
+        return false;
+    }
+
+    Serial.printf("[POET] Sampler task started (temp %lu ms, ORP %lu ms, pH %lu ms, EC %lu ms)\n",
+                  channelIntervalMs[POET_CH_TEMPERATURE], channelIntervalMs[POET_CH_ORP],
+                  channelIntervalMs[POET_CH_PH], channelIntervalMs[POET_CH_EC]);
+    return true;
+}
+
+void POETSensor::taskEntry(void* arg) {
+    POETSensor* sensor = static_cast<POETSensor*>(arg);
+
+    for (;;) {
+        sensor->update();
+
+        unsigned long wait_ms = sensor->getTimeToNextStep();
+        if (wait_ms > 0) {
+            vTaskDelay(pdMS_TO_TICKS(wait_ms));
+        }
+    }
+}
+
+/**
+ * Conversion time required by the POET hardware for a command (from datasheet)
+ */
+uint16_t POETSensor::getConversionTime(uint8_t cmd) {
+    uint16_t delay_ms = DELAY_BASE;
+    if (cmd & CMD_TEMPERATURE) delay_ms += DELAY_TEMP;
+    if (cmd & CMD_ORP)        delay_ms += DELAY_ORP;
+    if (cmd & CMD_PH)         delay_ms += DELAY_PH;
+    if (cmd & CMD_EC)         delay_ms += DELAY_EC;
+    return delay_ms;
+}
@@ -0,0 +1,142 @@
+#ifndef POET_SENSOR_H
+#define POET_SENSOR_H
+
+#include <Arduino.h>
+#include <limits.h>
+#include "POETProtocol.h"
+#include "SensorBackend.h"
+#include "SeqLock.h"
+#include "SampleFilter.h"
+
+// Time allowed for the result read-back after the conversion delay (ms).
+// The sensor NACKs while still busy, so READ retries until this expires.
+#define POET_READ_TIMEOUT  250
+#define POET_READ_RETRY_MS   5
+
+// Default per-channel sampling periods (ms). Each channel is converted with its
+// own command, so fast channels are never gated by the 1664 ms ORP conversion.
+// Keep the summed duty cycle below 100%: temp 24% + pH 48% + EC 7% + ORP 6%.
+#define POET_TEMP_INTERVAL_MS   2000
+#define POET_ORP_INTERVAL_MS   30000
+#define POET_PH_INTERVAL_MS     1000
+#define POET_EC_INTERVAL_MS     5000
+
+// A channel is considered stale (sample invalid) once its last reading is older
+// than this many periods (plus one worst-case conversion for scheduling slack)
+#define POET_STALE_PERIODS         3
+
+// Raw-value filter windows (samples) - slow channels use short windows to limit lag
+#define POET_FILTER_WINDOW_FAST     5  // Temperature, pH
+#define POET_FILTER_WINDOW_SLOW     3  // ORP, EC
+
+// Channel noise floors in raw units, used for spike rejection
+#define POET_NOISE_TEMP_mC         50
+#define POET_NOISE_ORP_uV        5000
+#define POET_NOISE_UGS_uV        3000  // ~0.06 pH at 52 mV/pH
+#define POET_NOISE_EC_nA           50
+#define POET_NOISE_EC_uV         5000
+#define POET_NOISE_EC_PERMILLE     20  // EC noise scales with conductivity
+
+// Sampler task configuration
+#define POET_TASK_STACK_SIZE 4096
+#define POET_TASK_PRIORITY   2     // Above loopTask (1) so sampling period does not depend on loop()
+#define POET_TASK_CORE       0     // ESP32-C3 is single core
+
+// POET acquisition state machine
+enum POETState {
+    POET_IDLE,          // Waiting for the next measurement cycle
+    POET_COMMAND_SENT,  // Command byte being written to the sensor
+    POET_WAIT,          // Conversion in progress, waiting for datasheet delay
+    POET_READ,          // Reading result bytes (retried until timeout)
+    POET_PUBLISH        // Result ready to hand to consumers
+};
+
+/**
+ * POETSensor - Sentron POET pH/ORP/EC/Temperature sampler
+ *
+ * Transport is delegated to a SensorBackend: I2CSensorBackend talks to the
+ * real sensor, SimulatedSensorBackend replays CSV exports or synthetic
+ * profiles so the pipeline can run without hardware.
+ *
+ * Acquisition runs as a deadline-driven state machine
+ * (IDLE -> COMMAND_SENT -> WAIT -> READ -> PUBLISH). It can be polled with
+ * update() or run in a dedicated FreeRTOS task with startTask(), which sleeps
+ * until each state's deadline.
+ *
+ * Channels are scheduled individually: every cycle converts the single most
+ * overdue channel with its own command and merges the reading into the
+ * running sample, so e.g. pH refreshes every second while ORP (1.6 s
+ * conversion) only runs every 30 s.
+ *
+ * Raw readings pass through a per-value SampleFilter (integer median with
+ * spike rejection) before they are merged, so single-sample outliers never
+ * reach warnings, history or MQTT.
+ *
+ * Every completed measurement is published through a lock-free SeqLock slot,
+ * so consumers (web server, MQTT, display) read the newest sample with
+ * getLatest() without ever blocking the sampler.
+ *
+ * The sampler only touches the backend for the command write and the result
+ * read, never during conversion, so the I2C bus stays free for the display.
+ */
+class POETSensor {
+public:
+    explicit POETSensor(SensorBackend& backend);
+
+    // Initialize the backend and check for sensor presence
+    bool begin();
+
+    // Advance the state machine one step; returns true when a result is published
+    bool update();
+
+    // Start the dedicated sampler task (calls update() on its own schedule)
+    bool startTask();
+
+    // Copy the newest published sample; returns its sequence number (0 = none yet)
+    uint32_t getLatest(POETResult& result) const;
+
+    // Sequence number of the newest published sample (0 = none yet)
+    uint32_t getSequence() const { return latest.version(); }
+
+    // Per-channel schedule (0 disables the channel)
+    void setChannelInterval(POETChannel channel, unsigned long interval_ms);
+    unsigned long getChannelInterval(POETChannel channel) const;
+
+    POETState getState() const { return state; }
+
+    // Age of a channel's reading in a published sample (ULONG_MAX if never read)
+    static unsigned long getChannelAge(const POETResult& sample, POETChannel channel);
+
+    // Conversion time required by the POET hardware for a command (from datasheet)
+    static uint16_t getConversionTime(uint8_t command);
+
+private:
+    SensorBackend& backend;
+    POETState state;
+    int8_t currentChannel;         // Channel being converted (-1 = none)
+    unsigned long stateEnteredAt;  // millis() when the current state was entered
+    unsigned long deadlineMs;      // Time budget for the current state
+    POETResult result;             // Merged sample owned by the sampler
+    POETResult rawResult;          // Unfiltered reading of the current channel
+
+    // Filters per raw value: temp, ORP, Ugs, EC current, EC excitation
+    enum { FILTER_TEMP, FILTER_ORP, FILTER_UGS, FILTER_EC_NA, FILTER_EC_UV, FILTER_COUNT };
+    SampleFilter filters[FILTER_COUNT];
+
+    unsigned long channelIntervalMs[POET_CHANNEL_COUNT];
+    unsigned long channelStartedAt[POET_CHANNEL_COUNT];  // millis() of the channel's last command
+    bool channelScheduled[POET_CHANNEL_COUNT];           // Channel has been commanded at least once
+
+    SeqLock<POETResult> latest;    // Published samples
+    TaskHandle_t taskHandle;
+
+    void enterState(POETState newState, unsigned long deadline_ms);
+    void applyFilters(uint8_t cmd);
+    void publish();
+    int8_t selectDueChannel(unsigned long now) const;
+    unsigned long getTimeToNextStep() const;
+
+    static void taskEntry(void* arg);
+};
+
+#endif // POET_SENSOR_H
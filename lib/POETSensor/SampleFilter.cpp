@@ -0,0 +1,102 @@
+#include "SampleFilter.h"
+
+SampleFilter::SampleFilter()
+    : window(1),
+      head(0),
+      count(0),
+      consecutiveRejects(0),
+      noiseFloor(0),
+      relativeFloorPermille(0),
+      mode(FILTER_MEDIAN),
+      output(0),
+      rejectedTotal(0) {
+}
+
+void SampleFilter::configure(uint8_t newWindow, int32_t newNoiseFloor,
+                             uint16_t newRelativeFloorPermille, SampleFilterMode newMode) {
+    window = constrain(newWindow, 1, SAMPLE_FILTER_MAX_WINDOW);
+    noiseFloor = newNoiseFloor < 0 ? -newNoiseFloor : newNoiseFloor;
+    relativeFloorPermille = newRelativeFloorPermille;
+    mode = newMode;
+    reset();
+}
+
+void SampleFilter::reset() {
+    head = 0;
+    count = 0;
+    consecutiveRejects = 0;
+    output = 0;
+}
+
+int32_t SampleFilter::add(int32_t raw) {
+    // Spike rejection needs a settled output (at least half a window)
+    if (count > window / 2 && isSpike(raw)) {
+        consecutiveRejects++;
+        rejectedTotal++;
+        if (consecutiveRejects <= SAMPLE_FILTER_MAX_REJECTS) {
+            return output;
+        }
+        // Deviation persisted - accept it as a step change and start over
+        reset();
+    }
+    consecutiveRejects = 0;
+
+    ring[head] = raw;
+    head = (head + 1) % window;
+    if (count < window) {
+        count++;
+    }
+
+    output = compute();
+    return output;
+}
+
+bool SampleFilter::isSpike(int32_t raw) const {
+    int64_t floor = noiseFloor;
+    if (relativeFloorPermille > 0) {
+        int64_t magnitude = output < 0 ? -(int64_t)output : (int64_t)output;
+        int64_t relative = magnitude * relativeFloorPermille / 1000;
+        if (relative > floor) {
+            floor = relative;
+        }
+    }
+    if (floor == 0) {
+        return false;  // Spike rejection disabled
+    }
+
+    int64_t deviation = (int64_t)raw - (int64_t)output;
+    if (deviation < 0) {
+        deviation = -deviation;
+    }
+    return deviation > floor * SAMPLE_FILTER_SPIKE_FACTOR;
+}
+
+int32_t SampleFilter::compute() const {
+    // Insertion sort of a copy - window is tiny
+    int32_t sorted[SAMPLE_FILTER_MAX_WINDOW];
+    for (uint8_t i = 0; i < count; i++) {
+        int32_t v = ring[i];
+        int8_t j = i - 1;
+        while (j >= 0 && sorted[j] > v) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+
+    if (mode == FILTER_TRIMMED_MEAN && count >= 3) {
+        int64_t sum = 0;
+        for (uint8_t i = 1; i < count - 1; i++) {
+            sum += sorted[i];
+        }
+        int64_t n = count - 2;
+        // Round half away from zero
+        return (int32_t)((sum + (sum >= 0 ? n / 2 : -n / 2)) / n);
+    }
+
+    if (count % 2 == 1) {
+        return sorted[count / 2];
+    }
+    // Even count: average of the two middle samples
+    return (int32_t)(((int64_t)sorted[count / 2 - 1] + (int64_t)sorted[count / 2]) / 2);
+}
@@ -0,0 +1,74 @@
+#ifndef SAMPLE_FILTER_H
+#define SAMPLE_FILTER_H
+
+#include <Arduino.h>
+
+// Largest supported filter window (samples kept per channel)
+#define SAMPLE_FILTER_MAX_WINDOW 7
+
+// A sample further than this many noise floors from the current output is a spike
+#define SAMPLE_FILTER_SPIKE_FACTOR 4
+
+// Consecutive rejected samples accepted as a genuine step change
+#define SAMPLE_FILTER_MAX_REJECTS 2
+
+enum SampleFilterMode {
+    FILTER_MEDIAN = 0,        // Median of the window
+    FILTER_TRIMMED_MEAN = 1   // Mean of the window without its min and max
+};
+
+/**
+ * SampleFilter - Integer-only spike rejection and decimation for raw POET values
+ *
+ * Keeps a short ring of raw int32 samples (µV, nA, m°C) and outputs either the
+ * median or the trimmed mean of the ring. Before a sample enters the ring it is
+ * compared with the current output: a deviation beyond SPIKE_FACTOR noise
+ * floors is dropped as a single-sample outlier. If the deviation persists for
+ * more than MAX_REJECTS samples it is treated as a real step and accepted.
+ *
+ * The noise floor is max(absolute floor, |output| * relative floor), so
+ * channels whose noise scales with the signal (EC current) work too.
+ */
+class SampleFilter {
+public:
+    SampleFilter();
+
+    /**
+     * Configure the filter (clears the ring)
+     *
+     * @param window Samples kept in the ring (1-SAMPLE_FILTER_MAX_WINDOW, 1 = pass-through)
+     * @param noiseFloor Absolute noise floor in raw units (0 disables spike rejection)
+     * @param relativeFloorPermille Noise floor relative to the output in ‰
+     * @param mode Median or trimmed mean output
+     */
+    void configure(uint8_t window, int32_t noiseFloor, uint16_t relativeFloorPermille = 0,
+                   SampleFilterMode mode = FILTER_MEDIAN);
+
+    // Feed one raw sample; returns the filtered value
+    int32_t add(int32_t raw);
+
+    // Current filtered value (0 if no samples yet)
+    int32_t value() const { return output; }
+
+    void reset();
+
+    uint8_t getCount() const { return count; }
+    uint32_t getRejectedCount() const { return rejectedTotal; }
+
+private:
+    int32_t ring[SAMPLE_FILTER_MAX_WINDOW];
+    uint8_t window;
+    uint8_t head;
+    uint8_t count;
+    uint8_t consecutiveRejects;
+    int32_t noiseFloor;
+    uint16_t relativeFloorPermille;
+    SampleFilterMode mode;
+    int32_t output;
+    uint32_t rejectedTotal;
+
+    bool isSpike(int32_t raw) const;
+    int32_t compute() const;
+};
+
+#endif // SAMPLE_FILTER_H
@@ -0,0 +1,35 @@
+#ifndef SENSOR_BACKEND_H
+#define SENSOR_BACKEND_H
+
+#include <Arduino.h>
+#include "POETProtocol.h"
+
+/**
+ * SensorBackend - Transport used by POETSensor to run POET measurements
+ *
+ * A measurement is split in two calls so the sampler can wait for the
+ * conversion without blocking: startMeasurement() issues the command and
+ * readMeasurement() fetches the result once the datasheet delay has passed.
+ */
+class SensorBackend {
+public:
+    virtual ~SensorBackend() {}
+
+    // Initialize the transport and check for sensor presence
+    virtual bool begin() = 0;
+
+    // Issue a measurement command (CMD_* bit mask)
+    virtual bool startMeasurement(uint8_t command) = 0;
+
+    /**
+     * Fetch the result of the last command
+     * Only the fields for the channels in command are written.
+     * @return false if the result is not available (yet)
+     */
+    virtual bool readMeasurement(uint8_t command, POETResult& out) = 0;
+
+    // Short name for logs ("i2c", "simulated")
+    virtual const char* getName() const = 0;
+};
+
+#endif // SENSOR_BACKEND_H
@@ -0,0 +1,218 @@
+#include "SimulatedSensorBackend.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+SimulatedSensorBackend::SimulatedSensorBackend()
+    : profile(getDefaultProfile()),
+      loopReplay(true),
+      rngState(0x2545F491),
+      startedAt(0) {
+    for (int i = 0; i < POET_CHANNEL_COUNT; i++) {
+        cursor[i] = 0;
+        readings[i] = 0;
+    }
+}
+
+SimulatedProfile SimulatedSensorBackend::getDefaultProfile() {
+    SimulatedProfile p;
+    p.temp_c = 25.0;
+    p.ph = 7.2;
+    p.orp_mv = 250.0;
+    p.ec_ms_cm = 0.45;
+    p.temp_drift_per_hr = 0.1;
+    p.ph_drift_per_hr = -0.01;
+    p.orp_drift_per_hr = 0.0;
+    p.ec_drift_per_hr = 0.001;
+    p.temp_noise = 0.02;
+    p.ph_noise = 0.01;
+    p.orp_noise = 2.0;
+    p.ec_noise = 0.002;
+    p.ph_spike_every = 0;
+    p.ph_spike = 0.5;
+    return p;
+}
+
+void SimulatedSensorBackend::setProfile(const SimulatedProfile& newProfile) {
+    profile = newProfile;
+    rows.clear();
+}
+
+void SimulatedSensorBackend::setSeed(uint32_t seed) {
+    rngState = seed != 0 ? seed : 1;  // xorshift state must be non-zero
+}
+
+bool SimulatedSensorBackend::loadCSV(const char* path, bool loop) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        Serial.printf("[SIM] ERROR: Cannot open %s\n", path);
+        return false;
+    }
+
+    rows.clear();
+    loopReplay = loop;
+
+    // Column positions are taken from the header row
+    int colTemp = -1, colOrp = -1, colPh = -1, colEc = -1;
+    bool haveHeader = false;
+    char line[512];
+
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;  // Metadata and blank lines
+        }
+
+        if (!haveHeader) {
+            int col = 0;
+            for (char* tok = strtok(line, ","); tok != nullptr; tok = strtok(nullptr, ","), col++) {
+                if (strcmp(tok, "Temperature_C") == 0) colTemp = col;
+                else if (strcmp(tok, "ORP_mV") == 0) colOrp = col;
+                else if (strcmp(tok, "pH") == 0) colPh = col;
+                else if (strcmp(tok, "EC_mS_cm") == 0) colEc = col;
+            }
+            if (colTemp < 0 || colOrp < 0 || colPh < 0 || colEc < 0) {
+                Serial.printf("[SIM] ERROR: %s is not an aquarium CSV export\n", path);
+                fclose(file);
+                return false;
+            }
+            haveHeader = true;
+            continue;
+        }
+
+        ReplayRow row = { 0, 0, 0, 0 };
+        int col = 0;
+        // Split manually - strtok would merge empty fields
+        char* field = line;
+        while (field != nullptr) {
+            char* next = strchr(field, ',');
+            if (next != nullptr) {
+                *next++ = '\0';
+            }
+            if (col == colTemp) row.temp_c = strtof(field, nullptr);
+            else if (col == colOrp) row.orp_mv = strtof(field, nullptr);
+            else if (col == colPh) row.ph = strtof(field, nullptr);
+            else if (col == colEc) row.ec_ms_cm = strtof(field, nullptr);
+            field = next;
+            col++;
+        }
+        rows.push_back(row);
+    }
+
+    fclose(file);
+    Serial.printf("[SIM] Loaded %u rows from %s\n", (unsigned)rows.size(), path);
+    return !rows.empty();
+}
+
+bool SimulatedSensorBackend::begin() {
+    startedAt = millis();
+    for (int i = 0; i < POET_CHANNEL_COUNT; i++) {
+        cursor[i] = 0;
+        readings[i] = 0;
+    }
+    return true;
+}
+
+bool SimulatedSensorBackend::startMeasurement(uint8_t command) {
+    return (command & CMD_ALL) != 0;
+}
+
+bool SimulatedSensorBackend::readMeasurement(uint8_t command, POETResult& out) {
+    ReplayRow row = { 0, 0, 0, 0 };
+
+    if (!rows.empty()) {
+        for (int ch = 0; ch < POET_CHANNEL_COUNT; ch++) {
+            ReplayRow channelRow;
+            if (!(command & (1 << ch))) {
+                continue;
+            }
+            if (!nextReplayRow((POETChannel)ch, channelRow)) {
+                return false;  // Replay finished
+            }
+            switch (ch) {
+                case POET_CH_TEMPERATURE: row.temp_c = channelRow.temp_c; break;
+                case POET_CH_ORP: row.orp_mv = channelRow.orp_mv; break;
+                case POET_CH_PH: row.ph = channelRow.ph; break;
+                case POET_CH_EC: row.ec_ms_cm = channelRow.ec_ms_cm; break;
+            }
+        }
+    } else {
+        syntheticValues(row, command);
+    }
+
+    // Convert back to raw POET units (inverse of uncalibrated conversion)
+    if (command & CMD_TEMPERATURE) {
+        out.temp_mC = (int32_t)lroundf(row.temp_c * 1000.0f);
+    }
+    if (command & CMD_ORP) {
+        out.orp_uV = (int32_t)lroundf(row.orp_mv * 1000.0f);
+    }
+    if (command & CMD_PH) {
+        out.ugs_uV = (int32_t)lroundf((row.ph - 7.0f) * 52.0f * 1000.0f);
+    }
+    if (command & CMD_EC) {
+        out.ec_uV = SIM_EC_EXCITATION_uV;
+        out.ec_nA = (int32_t)lroundf(row.ec_ms_cm * (SIM_EC_EXCITATION_uV / 1000.0f));
+    }
+
+    for (int ch = 0; ch < POET_CHANNEL_COUNT; ch++) {
+        if (command & (1 << ch)) {
+            readings[ch]++;
+        }
+    }
+    return true;
+}
+
+bool SimulatedSensorBackend::nextReplayRow(POETChannel channel, ReplayRow& row) {
+    if (cursor[channel] >= rows.size()) {
+        if (!loopReplay) {
+            return false;
+        }
+        cursor[channel] = 0;
+    }
+    row = rows[cursor[channel]++];
+    return true;
+}
+
+void SimulatedSensorBackend::syntheticValues(ReplayRow& row, uint8_t command) {
+    float hours = (millis() - startedAt) / 3600000.0f;
+
+    if (command & CMD_TEMPERATURE) {
+        row.temp_c = profile.temp_c + profile.temp_drift_per_hr * hours + noise(profile.temp_noise);
+    }
+    if (command & CMD_ORP) {
+        row.orp_mv = profile.orp_mv + profile.orp_drift_per_hr * hours + noise(profile.orp_noise);
+    }
+    if (command & CMD_PH) {
+        row.ph = profile.ph + profile.ph_drift_per_hr * hours + noise(profile.ph_noise);
+        if (profile.ph_spike_every > 0 && (readings[POET_CH_PH] + 1) % profile.ph_spike_every == 0) {
+            row.ph += profile.ph_spike;
+        }
+    }
+    if (command & CMD_EC) {
+        row.ec_ms_cm = profile.ec_ms_cm + profile.ec_drift_per_hr * hours + noise(profile.ec_noise);
+        if (row.ec_ms_cm < 0.0f) {
+            row.ec_ms_cm = 0.0f;
+        }
+    }
+}
+
+float SimulatedSensorBackend::noise(float amplitude) {
+    if (amplitude <= 0.0f) {
+        return 0.0f;
+    }
+    // Uniform in [-amplitude, +amplitude]
+    float unit = (nextRandom() & 0xFFFFFF) / (float)0xFFFFFF;
+    return (unit * 2.0f - 1.0f) * amplitude;
+}
+
+uint32_t SimulatedSensorBackend::nextRandom() {
+    // xorshift32 - small, fast and reproducible on every platform
+    uint32_t x = rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rngState = x;
+    return x;
+}
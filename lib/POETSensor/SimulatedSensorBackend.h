@@ -0,0 +1,97 @@
+#ifndef SIMULATED_SENSOR_BACKEND_H
+#define SIMULATED_SENSOR_BACKEND_H
+
+#include <Arduino.h>
+#include <vector>
+#include "SensorBackend.h"
+
+// Excitation voltage reported by the simulator (1 V gives 1 nA per µS/cm)
+#define SIM_EC_EXCITATION_uV 1000000
+
+// Synthetic profile in engineering units
+struct SimulatedProfile {
+    // Starting values
+    float temp_c;
+    float ph;
+    float orp_mv;
+    float ec_ms_cm;
+    // Linear drift per hour
+    float temp_drift_per_hr;
+    float ph_drift_per_hr;
+    float orp_drift_per_hr;
+    float ec_drift_per_hr;
+    // Peak uniform noise amplitude
+    float temp_noise;
+    float ph_noise;
+    float orp_noise;
+    float ec_noise;
+    // Inject a single-sample pH spike of this size every N pH readings (0 = never)
+    uint16_t ph_spike_every;
+    float ph_spike;
+};
+
+/**
+ * SimulatedSensorBackend - Deterministic stand-in for the POET sensor
+ *
+ * Two sources are supported:
+ * - CSV replay: a file in the format produced by /api/export/csv (or the
+ *   console "dump csv" command). Every channel walks through the rows on its
+ *   own, one row per reading, so each channel replays the whole file at its
+ *   own scheduling rate.
+ * - Synthetic profile: starting values with linear drift, seeded uniform
+ *   noise and optional periodic pH spikes.
+ *
+ * Values are converted back to raw POET units assuming uncalibrated
+ * CalibrationManager defaults (pH 7.0 at 0 mV, 52 mV/pH, cell constant 1 /cm),
+ * so the downstream pipeline reproduces the exported values.
+ */
+class SimulatedSensorBackend : public SensorBackend {
+public:
+    SimulatedSensorBackend();
+
+    // Use a synthetic profile (default: stable freshwater tank)
+    void setProfile(const SimulatedProfile& profile);
+
+    /**
+     * Replay a CSV export instead of the synthetic profile
+     * @param path File path (host path, or VFS path such as /littlefs/... on target)
+     * @param loop Restart from the first row at end of file
+     * @return true if at least one row was loaded
+     */
+    bool loadCSV(const char* path, bool loop = true);
+
+    // Seed for the noise generator (same seed = same sequence)
+    void setSeed(uint32_t seed);
+
+    size_t getRowCount() const { return rows.size(); }
+
+    bool begin() override;
+    bool startMeasurement(uint8_t command) override;
+    bool readMeasurement(uint8_t command, POETResult& out) override;
+    const char* getName() const override { return "simulated"; }
+
+    static SimulatedProfile getDefaultProfile();
+
+private:
+    struct ReplayRow {
+        float temp_c;
+        float orp_mv;
+        float ph;
+        float ec_ms_cm;
+    };
+
+    SimulatedProfile profile;
+    std::vector<ReplayRow> rows;
+    bool loopReplay;
+    size_t cursor[POET_CHANNEL_COUNT];
+    uint32_t readings[POET_CHANNEL_COUNT];
+    uint32_t rngState;
+    unsigned long startedAt;
+
+    bool nextReplayRow(POETChannel channel, ReplayRow& row);
+    void syntheticValues(ReplayRow& row, uint8_t command);
+    float noise(float amplitude);
+    uint32_t nextRandom();
+};
+
+#endif // SIMULATED_SENSOR_BACKEND_H
@@ -0,0 +1,104 @@
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * SeqCount - Sequence counter guarding data with a single writer
+ *
+ * The writer never blocks: beginWrite() bumps the sequence to an odd value,
+ * endWrite() to the next even value. Readers take a token with readBegin(),
+ * copy what they need and start over if readRetry() reports that a write
+ * overlapped the copy, so they never act on a half-written state.
+ *
+ * The ESP32-C3 is single core, so a reader that preempted the writer in the
+ * middle of an update backs off with delay(1) to let the writer finish instead
+ * of spinning at a higher priority.
+ */
+class SeqCount {
+public:
+    SeqCount() : sequence(0) {}
+
+    // Start an update (single writer only)
+    void beginWrite() {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    // Finish the update started by beginWrite()
+    void endWrite() {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Wait until no write is in progress; returns the token for readRetry()
+    uint32_t readBegin() const {
+        while (true) {
+            uint32_t seq = sequence.load(std::memory_order_acquire);
+            if (!(seq & 1)) {
+                return seq;
+            }
+            delay(1);  // Writer in progress
+        }
+    }
+
+    // True if a write overlapped the reads since readBegin() (copy again)
+    bool readRetry(uint32_t token) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence.load(std::memory_order_relaxed) != token;
+    }
+
+    // Number of completed writes
+    uint32_t version() const {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    std::atomic<uint32_t> sequence;
+};
+
+/**
+ * SeqLock - Single-writer / multi-reader lock-free value slot
+ *
+ * A value guarded by a SeqCount: write() publishes a new copy without ever
+ * blocking, read() returns a consistent copy of the latest complete write.
+ */
+template <typename T>
+class SeqLock {
+public:
+    SeqLock() : value() {}
+
+    // Publish a new value (single writer only)
+    void write(const T& newValue) {
+        count.beginWrite();
+        value = newValue;
+        count.endWrite();
+    }
+
+    /**
+     * Copy the latest value
+     * @param out Receives a consistent copy of the value
+     * @return Version of the copied value (0 if nothing was written yet)
+     */
+    uint32_t read(T& out) const {
+        while (true) {
+            uint32_t token = count.readBegin();
+            out = value;
+            if (!count.readRetry(token)) {
+                return token / 2;
+            }
+        }
+    }
+
+    // Version of the latest complete write (0 if nothing was written yet)
+    uint32_t version() const {
+        return count.version();
+    }
+
+private:
+    SeqCount count;
+    T value;
+};
+
+#endif // SEQ_LOCK_H
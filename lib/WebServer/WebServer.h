@@ -5,6 +5,9 @@
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
 #include <time.h>
+#include "TieredHistory.h"
+#include "RollingStats.h"
+#include "SeqLock.h"
 
 // Forward declaration
 struct POETResult;
@@ -14,16 +17,47 @@ class MQTTManager;
 class TankSettingsManager;
 class WarningManager;
 
-// Data history configuration
-#define HISTORY_SIZE 288  // 288 points = 24 hours at 5-minute intervals (or 24 min at 5s intervals)
-#define HISTORY_INTERVAL_MS 5000  // 5 seconds between data points
+// Responses built in RAM (JSON history, exports) serve at most this many of the newest points
+#define HISTORY_RESPONSE_MAX_POINTS 288
 
-struct DataPoint {
-    time_t timestamp;
+// History queries (range, from/to, step) widen the step to stay within this many points
+#define HISTORY_RANGE_MAX_POINTS 180
+
+// maxPoints= (LTTB downsampling) is capped at this many points per field
+#define HISTORY_LTTB_MAX_POINTS 500
+
+// Delay before a browser reconnects a dropped /api/events stream
+#define SSE_RECONNECT_MS 5000
+
+// Browsers reuse a cached page for max-age seconds, then revalidate it with If-None-Match
+#define WEB_PAGE_CACHE_CONTROL "max-age=300"
+
+// Vendor scripts have the version in their path and never change
+#define WEB_SCRIPT_CACHE_CONTROL "public, max-age=31536000, immutable"
+
+/**
+ * Latest reading and the metrics derived from it, published as one unit
+ *
+ * updateSensorData() (main loop) fills a private copy and publishes it
+ * through a SeqLock; HTTP handlers (AsyncTCP task) take a copy with
+ * getSnapshot(), so they never block the sampler and never mix fields of two
+ * different readings.
+ */
+struct SensorSnapshot {
+    // Raw POET readings
+    int32_t raw_temp_mC;
+    int32_t raw_orp_uV;
+    int32_t raw_ugs_uV;
+    int32_t raw_ec_nA;
+    int32_t raw_ec_uV;
+    unsigned long channelUpdatedAt[4];  // millis() of each POET channel's last reading
+
+    // Converted values
     float temp_c;
     float orp_mv;
     float ph;
     float ec_ms_cm;
+
     // Derived metrics
     float tds_ppm;
     float co2_ppm;
@@ -31,14 +65,9 @@ struct DataPoint {
     float nh3_ppm;
     float max_do_mg_l;
     float stocking_density;
+
+    unsigned long lastUpdate;  // millis() of the reading
     bool valid;
-    // Warning states (0=unknown, 1=normal, 2=warning, 3=critical)
-    uint8_t temp_state;
-    uint8_t ph_state;
-    uint8_t nh3_state;
-    uint8_t orp_state;
-    uint8_t ec_state;
-    uint8_t do_state;
 };
 
 class AquariumWebServer {
@@ -57,13 +86,14 @@ public:
     // Initialize NTP time synchronization
     void initNTP();
 
+    // Restart the device from loop() after delayMs, flushing the history log first (safe from handlers)
+    void requestRestart(unsigned long delayMs);
+
     // Get server instance
     AsyncWebServer* getServer() { return &server; }
 
     // Get history data (for console dumps)
-    const DataPoint* getHistory() const { return history; }
-    int getHistoryCount() const { return historyCount; }
-    int getHistoryHead() const { return historyHead; }
+    const HistoryStore& getHistory() const { return history.getRaw(); }
 
     // Set tank settings manager
     void setTankSettingsManager(TankSettingsManager* mgr);
@@ -79,34 +109,32 @@ private:
     TankSettingsManager* tankSettingsManager;
     WarningManager* warningManager;
 
-    // Latest sensor readings (raw)
-    int32_t raw_temp_mC;
-    int32_t raw_orp_uV;
-    int32_t raw_ugs_uV;
-    int32_t raw_ec_nA;
-    int32_t raw_ec_uV;
+    // Latest reading: working copy owned by the main loop, and the copy published to handlers
+    SensorSnapshot sample;
+    SeqLock<SensorSnapshot> published;
 
-    // Converted values
-    float temp_c;
-    float orp_mv;
-    float ph;
-    float ec_ms_cm;
-    unsigned long lastUpdate;
-    bool dataValid;
+    // Data history (raw ring + min/max/mean rollup tiers)
+    TieredHistory history;
+    HistoryLog historyLog;  // Flash copy of the 1-minute tier (LittleFS)
+    unsigned long lastHistoryUpdate;
+    uint32_t historyCursorBase;  // Added to raw sequence numbers to form since= cursors
 
-    // Derived metrics (calculated on each sensor update)
-    float tds_ppm;
-    float co2_ppm;
-    float toxic_ammonia_ratio;
-    float nh3_ppm;
-    float max_do_mg_l;
-    float stocking_density;
+    // Planned restart, set by requestRestart() and carried out by loop()
+    volatile bool restartPending;
+    volatile unsigned long restartAt;
 
-    // Data history (circular buffer)
-    DataPoint history[HISTORY_SIZE];
-    int historyHead;
-    int historyCount;
-    unsigned long lastHistoryUpdate;
+    // 1 h / 24 h / 7 d statistics, updated with each history point and published to /api/stats
+    RollingStats stats;
+    SeqLock<RollingStatsSnapshot> publishedStats;
+
+    // Server-Sent Events push channel (/api/events)
+    AsyncEventSource events;
+    uint32_t lastWarningSignature;  // Warning states last pushed (3 bits per metric)
+    bool lastMQTTConnected;
+    String lastMQTTStatus;
+
+    // Binary telemetry for dashboards (/ws/telemetry, one HistoryBinary point frame per new point)
+    AsyncWebSocket telemetrySocket;
 
     // NTP synchronization
     bool ntpInitialized;
@@ -133,6 +161,9 @@ private:
     void handleClearEcCalibration(AsyncWebServerRequest *request);
     void handleGetRawReadings(AsyncWebServerRequest *request);
     void handleGetHistory(AsyncWebServerRequest *request);
+    void handleGetHistoryQuery(AsyncWebServerRequest *request);
+    void handleGetHistoryBinary(AsyncWebServerRequest *request);
+    void handleGetStats(AsyncWebServerRequest *request);
     void handleChartsPage(AsyncWebServerRequest *request);
     void handleExportCSV(AsyncWebServerRequest *request);
     void handleExportJSON(AsyncWebServerRequest *request);
@@ -152,14 +183,28 @@ private:
     void handleSaveWarningProfile(AsyncWebServerRequest *request);
     void handleGetWarningStates(AsyncWebServerRequest *request);
 
-    // HTML page generators
-    String generateHomePage();
+    // HTML pages (charts and calibration are gzipped into web_pages.h at build time)
     String generateProvisioningPage();
-    String generateCalibrationPage();
-    String generateChartsPage();
+    void sendGzipPage(AsyncWebServerRequest *request, const uint8_t *page, size_t length, const char *etag);
+
+    // Consistent copy of the latest published reading (any task)
+    void getSnapshot(SensorSnapshot& snapshot) const { published.read(snapshot); }
+
+    // JSON bodies shared by the REST handlers and the event stream
+    void buildSampleJson(JsonDocument& doc, const SensorSnapshot& snapshot);
+    void buildWarningStatesJson(JsonDocument& doc, const SensorSnapshot& snapshot);
+    void buildMQTTStatusJson(JsonDocument& doc);
+
+    // Event stream
+    void sendEvent(const char* event, JsonDocument& doc);
+    void publishLiveEvents();
+    void publishHistoryEvent(const DataPoint& dp);
+    void publishStats();
+    uint32_t getWarningSignature();
 
     // History management
     void addDataPointToHistory();
+    void getResponseRange(uint32_t& first, uint32_t& end) const;
 
     // Helper methods
     String getUnitName();
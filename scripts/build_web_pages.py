@@ -0,0 +1,179 @@
+# Minifies and gzips the web UI pages in web/*.html into PROGMEM arrays in
+# lib/WebServer/web_pages.h, so they are served straight from flash with
+# Content-Encoding: gzip instead of being assembled in RAM per request.
+# Each page also gets an ETag (hash of the minified content) so browsers can
+# revalidate with If-None-Match and receive a 304 after the first load.
+#
+# Third-party scripts (Chart.js and its date adapter) are embedded the same
+# way so the UI works without internet access (AP mode, isolated VLANs).
+# They are pinned to a version, downloaded once into web/vendor/ (not
+# committed) and served under versioned /js/ paths with immutable caching.
+# To build offline, copy the files listed in VENDOR_SCRIPTS into web/vendor/.
+#
+# Runs as a PlatformIO pre-script; can also be run directly:
+#   python3 scripts/build_web_pages.py
+#
+# The minifier is deliberately conservative (no line joining): it strips
+# indentation, blank lines, HTML/CSS comments and whole-line // comments in
+# scripts. gzip does the rest. Vendor scripts are already minified.
+import gzip
+import hashlib
+import os
+import re
+import sys
+import urllib.request
+
+try:
+    Import("env")
+    PROJECT_DIR = env.subst("$PROJECT_DIR")
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+WEB_DIR = os.path.join(PROJECT_DIR, "web")
+VENDOR_DIR = os.path.join(WEB_DIR, "vendor")
+OUTPUT = os.path.join(PROJECT_DIR, "lib", "WebServer", "web_pages.h")
+
+# (file name in web/vendor and under /js/, pinned download URL)
+VENDOR_SCRIPTS = [
+    ("chart-4.4.0.umd.min.js",
+     "https://cdn.jsdelivr.net/npm/chart.js@4.4.0/dist/chart.umd.min.js"),
+    ("chartjs-adapter-date-fns-3.0.0.bundle.min.js",
+     "https://cdn.jsdelivr.net/npm/chartjs-adapter-date-fns@3.0.0/dist/chartjs-adapter-date-fns.bundle.min.js"),
+]
+
+BLOCK_RE = re.compile(r"(<script\b[^>]*>)(.*?)(</script>)|(<style\b[^>]*>)(.*?)(</style>)",
+                      re.S | re.I)
+
+
+def strip_lines(text, drop=None):
+    lines = []
+    for line in text.splitlines():
+        line = line.strip()
+        if line and not (drop and drop(line)):
+            lines.append(line)
+    return "\n".join(lines)
+
+
+def minify_html(text):
+    return strip_lines(re.sub(r"<!--.*?-->", "", text, flags=re.S))
+
+
+def minify_css(text):
+    return strip_lines(re.sub(r"/\*.*?\*/", "", text, flags=re.S))
+
+
+def minify_js(text):
+    return strip_lines(text, drop=lambda line: line.startswith("//"))
+
+
+def minify(page):
+    parts = []
+    position = 0
+    for match in BLOCK_RE.finditer(page):
+        parts.append(minify_html(page[position:match.start()]))
+        if match.group(1):
+            parts.append(match.group(1) + "\n" + minify_js(match.group(2)) + "\n" + match.group(3))
+        else:
+            parts.append(match.group(4) + "\n" + minify_css(match.group(5)) + "\n" + match.group(6))
+        position = match.end()
+    parts.append(minify_html(page[position:]))
+    return "\n".join(part for part in parts if part)
+
+
+def symbol_for(file_name):
+    return re.sub(r"[^A-Za-z0-9]", "_", file_name).upper() + "_GZ"
+
+
+def c_array(data):
+    rows = []
+    for offset in range(0, len(data), 20):
+        rows.append("    " + ", ".join("0x%02x" % byte for byte in data[offset:offset + 20]) + ",")
+    return "\n".join(rows)
+
+
+def fetch_vendor(name, url):
+    path = os.path.join(VENDOR_DIR, name)
+    if not os.path.exists(path):
+        print("Web pages: downloading " + url)
+        os.makedirs(VENDOR_DIR, exist_ok=True)
+        try:
+            with urllib.request.urlopen(url, timeout=30) as response:
+                data = response.read()
+        except OSError as error:
+            sys.stderr.write("Cannot download %s (%s); copy it to %s to build offline\n" %
+                             (url, error, path))
+            raise
+        with open(path + ".tmp", "wb") as output:
+            output.write(data)
+        os.replace(path + ".tmp", path)
+    with open(path, "rb") as source:
+        return source.read()
+
+
+def emit(out, name, original_size, content):
+    compressed = gzip.compress(content, compresslevel=9, mtime=0)
+    etag = hashlib.sha1(content).hexdigest()[:16]
+    symbol = symbol_for(name)
+
+    out.append("// %s: %d bytes, %d minified, %d gzipped" %
+               (name, original_size, len(content), len(compressed)))
+    out.append("const uint8_t %s[] PROGMEM = {" % symbol)
+    out.append(c_array(compressed))
+    out.append("};")
+    out.append("const size_t %s_LEN = sizeof(%s);" % (symbol, symbol))
+    out.append("const char %s_ETAG[] = \"\\\"%s\\\"\";" % (symbol, etag))
+    out.append("")
+    return "%s %d B" % (name, len(compressed))
+
+
+def build():
+    pages = sorted(name for name in os.listdir(WEB_DIR) if name.endswith(".html"))
+
+    out = [
+        "// Generated by scripts/build_web_pages.py from web/ - do not edit",
+        "#ifndef WEB_PAGES_H",
+        "#define WEB_PAGES_H",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "// Embedded file served at a fixed path",
+        "struct WebAsset {",
+        "    const char* path;",
+        "    const uint8_t* data;",
+        "    size_t length;",
+        "};",
+        "",
+    ]
+    summary = []
+    for name in pages:
+        with open(os.path.join(WEB_DIR, name), encoding="utf-8") as source:
+            page = source.read()
+        summary.append(emit(out, name, len(page.encode("utf-8")), minify(page).encode("utf-8")))
+
+    for name, url in VENDOR_SCRIPTS:
+        script = fetch_vendor(name, url)
+        summary.append(emit(out, name, len(script), script))
+
+    out.append("// Vendor scripts, served under /js/ with immutable caching (versioned names)")
+    out.append("const WebAsset WEB_SCRIPTS[] = {")
+    for name, url in VENDOR_SCRIPTS:
+        out.append("    {\"/js/%s\", %s, sizeof(%s)}," % (name, symbol_for(name), symbol_for(name)))
+    out.append("};")
+    out.append("const size_t WEB_SCRIPT_COUNT = sizeof(WEB_SCRIPTS) / sizeof(WEB_SCRIPTS[0]);")
+    out.append("")
+
+    out.append("#endif // WEB_PAGES_H")
+    out.append("")
+    content = "\n".join(out)
+
+    # Leave the header untouched when nothing changed so it does not force a rebuild
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT, encoding="utf-8") as existing:
+            if existing.read() == content:
+                return
+    with open(OUTPUT, "w", encoding="utf-8") as output:
+        output.write(content)
+    print("Web pages: " + ", ".join(summary))
+
+
+build()
@@ -0,0 +1,11 @@
+# Adds -fsanitize flags to both compile and link steps of the native envs.
+# build_flags alone only reach the compiler, so the sanitizer runtimes would
+# not be linked. Sanitizers are taken from the env's custom_sanitizers option.
+Import("env")
+
+sanitizers = env.GetProjectOption("custom_sanitizers", "").strip()
+
+if sanitizers:
+    flag = "-fsanitize=" + sanitizers
+    env.Append(CCFLAGS=[flag], LINKFLAGS=[flag])
+    print("Native sanitizers: " + sanitizers)
@@ -0,0 +1,124 @@
+#include "Arduino.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+namespace {
+
+const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+std::atomic<unsigned long long> advancedUs(0);
+
+unsigned long long elapsedMicros() {
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() +
+           advancedUs.load();
+}
+
+struct TaskStart {
+    TaskFunction_t function;
+    void* parameters;
+};
+
+} // namespace
+
+unsigned long millis() {
+    return (unsigned long)(elapsedMicros() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)elapsedMicros();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+void shimAdvanceMillis(unsigned long ms) {
+    advancedUs += (unsigned long long)ms * 1000;
+}
+
+long random(long max) {
+    return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+    return min >= max ? min : min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+    srand((unsigned int)seed);
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (!muted) {
+        fputc(c, stdout);
+    }
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (!muted) {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+size_t HardwareSerial::print(const char* str) {
+    if (str == nullptr) {
+        return 0;
+    }
+    return write(reinterpret_cast<const uint8_t*>(str), strlen(str));
+}
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = muted ? vsnprintf(nullptr, 0, format, args) : vprintf(format, args);
+    va_end(args);
+    return n < 0 ? 0 : (size_t)n;
+}
+
+void EspClass::restart() {
+    fflush(stdout);
+    exit(0);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t coreId) {
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    (void)coreId;
+
+    TaskStart start = {function, parameters};
+    std::thread* thread = new std::thread([start]() { start.function(start.parameters); });
+    thread->detach();
+    if (handle != nullptr) {
+        *handle = thread;
+    }
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks);
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)millis();
+}
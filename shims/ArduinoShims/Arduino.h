@@ -0,0 +1,175 @@
+#ifndef SHIM_ARDUINO_H
+#define SHIM_ARDUINO_H
+
+/**
+ * Host (env:native) replacement for the ESP32 Arduino core header
+ *
+ * Provides the parts of the framework the firmware libraries depend on:
+ * String, Serial, millis()/delay(), the common Arduino macros, ESP and a
+ * thread-backed subset of the FreeRTOS task API. Hardware-facing headers
+ * (Wire, WiFi, PubSubClient, Preferences) live alongside this one.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <cmath>
+#include <cstdlib>
+#include <type_traits>
+#include "WString.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// By-value min/max so in-class static const members are not ODR-used. The result
+// is a value too: decltype of the conditional would be T& for equal types and
+// refer to a parameter that is gone once the call returns.
+template <typename T, typename U>
+inline typename std::common_type<T, U>::type min(T a, U b) { return b < a ? b : a; }
+template <typename T, typename U>
+inline typename std::common_type<T, U>::type max(T a, U b) { return a < b ? b : a; }
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+// Time. millis() starts at 0 when the process starts.
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// Host-only: shift millis()/micros() forward without sleeping (tests of timed logic)
+void shimAdvanceMillis(unsigned long ms);
+
+// GPIO no-ops
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline int analogRead(uint8_t) { return 0; }
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+/**
+ * HardwareSerial - Writes to stdout; never has input
+ */
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+    void end() {}
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+    void flush();
+    String readStringUntil(char) { return String(); }
+    operator bool() const { return true; }
+
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return print(str); }
+
+    size_t print(const char* str);
+    size_t print(const String& str) { return print(str.c_str()); }
+    size_t print(const __FlashStringHelper* str) { return print(reinterpret_cast<const char*>(str)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(long long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned long long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(double value, int digits = 2) { return print(String(value, (unsigned int)digits)); }
+
+    size_t println() { return print("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    // Host-only: silence console output (benchmarks)
+    void setMuted(bool mute) { muted = mute; }
+
+private:
+    bool muted = false;
+};
+
+extern HardwareSerial Serial;
+
+/**
+ * EspClass - Chip information with fixed host values
+ */
+class EspClass {
+public:
+    uint64_t getEfuseMac() const { return 0x0000F6E5D4C3B2A1ULL; }
+    uint32_t getFreeHeap() const { return 320 * 1024; }
+    uint32_t getMinFreeHeap() const { return 320 * 1024; }
+    uint32_t getMaxAllocHeap() const { return 320 * 1024; }
+    const char* getChipModel() const { return "native"; }
+    void restart();
+};
+
+extern EspClass ESP;
+
+// FreeRTOS subset - tasks map to detached std::threads, ticks are milliseconds
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t coreId);
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                              void* parameters, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(function, name, stackDepth, parameters, priority, handle, tskNO_AFFINITY);
+}
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+inline void taskYIELD() { yield(); }
+
+#endif // SHIM_ARDUINO_H
@@ -0,0 +1,20 @@
+#ifndef SHIM_CLIENT_H
+#define SHIM_CLIENT_H
+
+#include <Arduino.h>
+
+/**
+ * Client - Network client interface (no real sockets on the host)
+ */
+class Client {
+public:
+    virtual ~Client() {}
+    virtual int connect(const char* host, uint16_t port) { (void)host; (void)port; return 1; }
+    virtual uint8_t connected() { return 0; }
+    virtual void stop() {}
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual size_t write(const uint8_t* buf, size_t size) { (void)buf; return size; }
+};
+
+#endif // SHIM_CLIENT_H
@@ -0,0 +1,227 @@
+#include "FS.h"
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+
+namespace fs {
+
+class FileImpl {
+public:
+    FILE* file = nullptr;
+    std::string path;        // Path within the file system
+    std::string name;        // Last path component
+    std::string hostPath;    // Path on the host disk
+    bool directory = false;
+    std::vector<std::string> entries;  // Directory entries (file system paths)
+    size_t nextEntry = 0;
+    const FS* owner = nullptr;
+
+    ~FileImpl() {
+        if (file != nullptr) {
+            fclose(file);
+        }
+    }
+};
+
+} // namespace fs
+
+using namespace fs;
+
+namespace {
+
+long writeBudget = -1;  // Bytes left before writes fail (negative for no limit)
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+} // namespace
+
+// ============================================================================
+// File
+// ============================================================================
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    if (!impl || impl->file == nullptr) {
+        return 0;
+    }
+    if (writeBudget >= 0) {
+        size = std::min(size, (size_t)writeBudget);
+        writeBudget -= size;
+    }
+    return fwrite(buf, 1, size, impl->file);
+}
+
+int File::available() {
+    if (!impl || impl->file == nullptr) {
+        return 0;
+    }
+    return (int)(size() - position());
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    if (!impl || impl->file == nullptr) {
+        return 0;
+    }
+    return fread(buf, 1, size, impl->file);
+}
+
+void File::flush() {
+    if (impl && impl->file != nullptr) {
+        fflush(impl->file);
+    }
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!impl || impl->file == nullptr) {
+        return false;
+    }
+    int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+    return fseek(impl->file, (long)pos, whence) == 0;
+}
+
+size_t File::position() const {
+    if (!impl || impl->file == nullptr) {
+        return 0;
+    }
+    long pos = ftell(impl->file);
+    return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+    if (!impl || impl->file == nullptr) {
+        return 0;
+    }
+    long pos = ftell(impl->file);
+    fseek(impl->file, 0, SEEK_END);
+    long end = ftell(impl->file);
+    fseek(impl->file, pos, SEEK_SET);
+    return end < 0 ? 0 : (size_t)end;
+}
+
+void File::close() {
+    impl.reset();
+}
+
+File::operator bool() const {
+    return impl && (impl->file != nullptr || impl->directory);
+}
+
+const char* File::path() const {
+    return impl ? impl->path.c_str() : nullptr;
+}
+
+const char* File::name() const {
+    return impl ? impl->name.c_str() : nullptr;
+}
+
+bool File::isDirectory() const {
+    return impl && impl->directory;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!impl || !impl->directory || impl->nextEntry >= impl->entries.size()) {
+        return File();
+    }
+    const std::string& entry = impl->entries[impl->nextEntry++];
+    return const_cast<FS*>(impl->owner)->open(entry.c_str(), mode);
+}
+
+// ============================================================================
+// FS
+// ============================================================================
+
+std::string FS::hostPath(const char* path) const {
+    std::string p = path != nullptr ? path : "";
+    if (p.empty() || p[0] != '/') {
+        p = "/" + p;
+    }
+    return rootDir() + p;
+}
+
+File FS::open(const char* path, const char* mode, const bool create) {
+    if (!mounted() || path == nullptr || path[0] != '/') {
+        return File();
+    }
+
+    std::error_code ec;
+    std::string host = hostPath(path);
+    auto impl = std::make_shared<FileImpl>();
+    impl->path = path;
+    impl->name = baseName(path);
+    impl->hostPath = host;
+    impl->owner = this;
+
+    bool reading = mode == nullptr || mode[0] == 'r';
+    if (reading && std::filesystem::is_directory(host, ec)) {
+        impl->directory = true;
+        std::string prefix = impl->path;
+        if (prefix.size() > 1 && prefix.back() == '/') {
+            prefix.pop_back();
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(host, ec)) {
+            std::string child = entry.path().filename().string();
+            impl->entries.push_back(prefix == "/" ? "/" + child : prefix + "/" + child);
+        }
+        std::sort(impl->entries.begin(), impl->entries.end());
+        return File(impl);
+    }
+
+    if (!reading && create) {
+        std::filesystem::create_directories(std::filesystem::path(host).parent_path(), ec);
+    }
+
+    // Binary modes: "r" -> rb, "w" -> wb, "a" -> ab (plus "+" variants)
+    std::string stdioMode = mode != nullptr ? mode : "r";
+    stdioMode.insert(1, "b");
+    impl->file = fopen(host.c_str(), stdioMode.c_str());
+    if (impl->file == nullptr) {
+        return File();
+    }
+    return File(impl);
+}
+
+bool FS::exists(const char* path) {
+    std::error_code ec;
+    return mounted() && std::filesystem::exists(hostPath(path), ec);
+}
+
+bool FS::remove(const char* path) {
+    std::error_code ec;
+    return mounted() && std::filesystem::is_regular_file(hostPath(path), ec) &&
+           std::filesystem::remove(hostPath(path), ec);
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+    std::error_code ec;
+    if (!mounted()) {
+        return false;
+    }
+    std::filesystem::rename(hostPath(pathFrom), hostPath(pathTo), ec);
+    return !ec;
+}
+
+bool FS::mkdir(const char* path) {
+    std::error_code ec;
+    if (!mounted()) {
+        return false;
+    }
+    std::filesystem::create_directory(hostPath(path), ec);
+    return !ec && std::filesystem::is_directory(hostPath(path), ec);
+}
+
+bool FS::rmdir(const char* path) {
+    std::error_code ec;
+    return mounted() && std::filesystem::is_directory(hostPath(path), ec) &&
+           std::filesystem::remove(hostPath(path), ec);
+}
+
+void shimSetFsWriteBudget(long bytes) {
+    writeBudget = bytes;
+}
@@ -0,0 +1,93 @@
+#ifndef SHIM_FS_H
+#define SHIM_FS_H
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+class FileImpl;
+
+/**
+ * File - Host implementation of the ESP32 fs::File handle
+ *
+ * Regular files wrap a stdio FILE, directories iterate their entries with
+ * openNextFile(). Copies share the underlying handle like on the device.
+ */
+class File {
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : impl(impl) {}
+
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size);
+    int available();
+    int read();
+    size_t read(uint8_t* buf, size_t size);
+    void flush();
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    operator bool() const;
+    const char* path() const;
+    const char* name() const;
+    bool isDirectory() const;
+    File openNextFile(const char* mode = FILE_READ);
+
+private:
+    std::shared_ptr<FileImpl> impl;
+};
+
+/**
+ * FS - Host file system rooted at a directory on disk
+ *
+ * Paths are absolute within the file system ("/hist/00000001.log") and are
+ * mapped below the root directory given by the concrete file system.
+ */
+class FS {
+public:
+    File open(const char* path, const char* mode = FILE_READ, const bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, const bool create = false) {
+        return open(path.c_str(), mode, create);
+    }
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* pathFrom, const char* pathTo);
+    bool mkdir(const char* path);
+    bool rmdir(const char* path);
+
+protected:
+    virtual std::string rootDir() const = 0;
+    virtual bool mounted() const = 0;
+    virtual ~FS() {}
+
+private:
+    std::string hostPath(const char* path) const;
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+// Host-only: accept at most bytes more file data, then short-write like a full partition
+// (negative for no limit)
+void shimSetFsWriteBudget(long bytes);
+
+#endif // SHIM_FS_H
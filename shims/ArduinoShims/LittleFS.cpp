@@ -0,0 +1,47 @@
+#include "LittleFS.h"
+#include <filesystem>
+
+// Size of the default XIAO ESP32-C3 data partition (0x160000)
+#define NATIVE_FS_TOTAL_BYTES 0x160000
+
+LittleFSFS LittleFS;
+
+std::string LittleFSFS::rootDir() const {
+    const char* dir = getenv("NATIVE_FS_DIR");
+    return (dir != nullptr && dir[0] != '\0') ? dir : ".pio/native_fs";
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles,
+                       const char* partitionLabel) {
+    (void)formatOnFail;
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+
+    std::error_code ec;
+    std::filesystem::create_directories(rootDir(), ec);
+    isMounted = !ec;
+    return isMounted;
+}
+
+bool LittleFSFS::format() {
+    std::error_code ec;
+    std::filesystem::remove_all(rootDir(), ec);
+    std::filesystem::create_directories(rootDir(), ec);
+    return !ec;
+}
+
+size_t LittleFSFS::totalBytes() {
+    return NATIVE_FS_TOTAL_BYTES;
+}
+
+size_t LittleFSFS::usedBytes() {
+    std::error_code ec;
+    size_t used = 0;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(rootDir(), ec)) {
+        if (entry.is_regular_file(ec)) {
+            used += entry.file_size(ec);
+        }
+    }
+    return used;
+}
@@ -0,0 +1,35 @@
+#ifndef SHIM_LITTLEFS_H
+#define SHIM_LITTLEFS_H
+
+#include "FS.h"
+
+/**
+ * LittleFS - Directory-backed host implementation of the ESP32 LittleFS
+ *
+ * Files live under the directory named by the NATIVE_FS_DIR environment
+ * variable (default .pio/native_fs), so data written by one test survives
+ * into the next begin() like a flash partition survives a reboot.
+ * totalBytes() reports the size of the default XIAO ESP32-C3 data partition.
+ */
+class LittleFSFS : public fs::FS {
+public:
+    LittleFSFS() : isMounted(false) {}
+
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+               uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs");
+    void end() { isMounted = false; }
+    bool format();
+    size_t totalBytes();
+    size_t usedBytes();
+
+protected:
+    std::string rootDir() const override;
+    bool mounted() const override { return isMounted; }
+
+private:
+    bool isMounted;
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // SHIM_LITTLEFS_H
@@ -0,0 +1,208 @@
+#include "Preferences.h"
+#include <filesystem>
+
+// NVS limit for namespace and key names (excluding the terminator)
+#define NVS_KEY_NAME_MAX 15
+
+namespace {
+
+bool validName(const char* name) {
+    return name != nullptr && name[0] != '\0' && strlen(name) <= NVS_KEY_NAME_MAX;
+}
+
+} // namespace
+
+std::string Preferences::storageDir() {
+    const char* dir = getenv("NATIVE_NVS_DIR");
+    return (dir != nullptr && dir[0] != '\0') ? dir : ".pio/native_nvs";
+}
+
+void Preferences::eraseAll() {
+    std::error_code ec;
+    std::filesystem::remove_all(storageDir(), ec);
+}
+
+bool Preferences::begin(const char* name, bool openReadOnly, const char* partitionLabel) {
+    (void)partitionLabel;
+    if (opened) {
+        return false;
+    }
+    if (!validName(name)) {
+        Serial.printf("[Preferences] ERROR: Invalid namespace '%s'\n", name ? name : "(null)");
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(storageDir(), ec);
+    path = storageDir() + "/" + name + ".nvs";
+    readOnly = openReadOnly;
+    entries.clear();
+    if (!load()) {
+        return false;
+    }
+    opened = true;
+    return true;
+}
+
+void Preferences::end() {
+    opened = false;
+    entries.clear();
+}
+
+bool Preferences::clear() {
+    if (!opened || readOnly) {
+        return false;
+    }
+    entries.clear();
+    return save();
+}
+
+bool Preferences::remove(const char* key) {
+    if (!opened || readOnly || !validName(key)) {
+        return false;
+    }
+    if (entries.erase(key) == 0) {
+        return false;
+    }
+    return save();
+}
+
+bool Preferences::isKey(const char* key) {
+    return opened && validName(key) && entries.count(key) > 0;
+}
+
+PreferenceType Preferences::getType(const char* key) {
+    if (!isKey(key)) {
+        return PT_INVALID;
+    }
+    return entries[key].type;
+}
+
+size_t Preferences::putValue(const char* key, PreferenceType type, const void* value, size_t len) {
+    if (!opened || readOnly || !validName(key) || (value == nullptr && len > 0)) {
+        return 0;
+    }
+    Entry& entry = entries[key];
+    entry.type = type;
+    entry.data.assign((const uint8_t*)value, (const uint8_t*)value + len);
+    return save() ? len : 0;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    if (value == nullptr) {
+        return 0;
+    }
+    // Stored with its terminator, like NVS; the return value excludes it
+    size_t len = strlen(value);
+    return putValue(key, PT_STR, value, len + 1) ? len : 0;
+}
+
+const Preferences::Entry* Preferences::find(const char* key, PreferenceType type) const {
+    if (!opened || !validName(key)) {
+        return nullptr;
+    }
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.type != type) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    const Entry* entry = find(key, PT_STR);
+    if (entry == nullptr || value == nullptr || entry->data.size() > maxLen) {
+        return 0;
+    }
+    memcpy(value, entry->data.data(), entry->data.size());
+    return entry->data.size();  // Includes the terminator, like nvs_get_str
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+    const Entry* entry = find(key, PT_STR);
+    if (entry == nullptr) {
+        return defaultValue;
+    }
+    return String((const char*)entry->data.data());
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    const Entry* entry = find(key, PT_BLOB);
+    return entry == nullptr ? 0 : entry->data.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    const Entry* entry = find(key, PT_BLOB);
+    if (entry == nullptr || buf == nullptr || entry->data.size() > maxLen) {
+        return 0;
+    }
+    memcpy(buf, entry->data.data(), entry->data.size());
+    return entry->data.size();
+}
+
+/**
+ * File format, per entry: key length (u8), key, type (u8), data length (u32 LE), data
+ */
+bool Preferences::load() {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        return true;  // Namespace not written yet
+    }
+
+    bool ok = true;
+    while (true) {
+        int keyLen = fgetc(f);
+        if (keyLen == EOF) {
+            break;
+        }
+        char key[NVS_KEY_NAME_MAX + 1];
+        uint8_t type;
+        uint8_t lenBytes[4];
+        if (keyLen > NVS_KEY_NAME_MAX || fread(key, 1, keyLen, f) != (size_t)keyLen ||
+            fread(&type, 1, 1, f) != 1 || fread(lenBytes, 1, 4, f) != 4) {
+            ok = false;
+            break;
+        }
+        key[keyLen] = '\0';
+        uint32_t len = lenBytes[0] | (lenBytes[1] << 8) | (lenBytes[2] << 16) | ((uint32_t)lenBytes[3] << 24);
+
+        Entry& entry = entries[key];
+        entry.type = (PreferenceType)type;
+        entry.data.resize(len);
+        if (len > 0 && fread(entry.data.data(), 1, len, f) != len) {
+            ok = false;
+            break;
+        }
+    }
+    fclose(f);
+
+    if (!ok) {
+        Serial.printf("[Preferences] ERROR: Corrupt namespace file %s\n", path.c_str());
+        entries.clear();
+    }
+    return ok;
+}
+
+bool Preferences::save() const {
+    std::string tmpPath = path + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (f == nullptr) {
+        return false;
+    }
+
+    bool ok = true;
+    for (const auto& item : entries) {
+        uint8_t keyLen = (uint8_t)item.first.size();
+        uint8_t type = (uint8_t)item.second.type;
+        uint32_t len = (uint32_t)item.second.data.size();
+        uint8_t lenBytes[4] = {(uint8_t)len, (uint8_t)(len >> 8), (uint8_t)(len >> 16), (uint8_t)(len >> 24)};
+        ok &= fwrite(&keyLen, 1, 1, f) == 1;
+        ok &= fwrite(item.first.data(), 1, keyLen, f) == keyLen;
+        ok &= fwrite(&type, 1, 1, f) == 1;
+        ok &= fwrite(lenBytes, 1, 4, f) == 4;
+        ok &= len == 0 || fwrite(item.second.data.data(), 1, len, f) == len;
+    }
+    ok &= fclose(f) == 0;
+
+    // Replace atomically so a crashed test never leaves a torn namespace
+    return ok && rename(tmpPath.c_str(), path.c_str()) == 0;
+}
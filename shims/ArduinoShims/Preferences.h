@@ -0,0 +1,105 @@
+#ifndef SHIM_PREFERENCES_H
+#define SHIM_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef enum {
+    PT_I8, PT_U8, PT_I16, PT_U16, PT_I32, PT_U32, PT_I64, PT_U64, PT_STR, PT_BLOB, PT_INVALID
+} PreferenceType;
+
+/**
+ * Preferences - File-backed host implementation of the ESP32 NVS API
+ *
+ * Each namespace is stored in its own file under the directory named by the
+ * NATIVE_NVS_DIR environment variable (default .pio/native_nvs) and rewritten
+ * on every put, so settings survive between test runs exactly like NVS
+ * survives a reboot. Entries are typed like NVS (floats and doubles are
+ * blobs) and keys/namespaces over 15 characters are rejected, so code that
+ * would fail on the device fails here too.
+ */
+class Preferences {
+public:
+    Preferences() : opened(false), readOnly(false) {}
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+    PreferenceType getType(const char* key);
+    size_t freeEntries() { return opened ? 630 - entries.size() : 0; }
+
+    size_t putChar(const char* key, int8_t value) { return putValue(key, PT_I8, &value, sizeof(value)); }
+    size_t putUChar(const char* key, uint8_t value) { return putValue(key, PT_U8, &value, sizeof(value)); }
+    size_t putShort(const char* key, int16_t value) { return putValue(key, PT_I16, &value, sizeof(value)); }
+    size_t putUShort(const char* key, uint16_t value) { return putValue(key, PT_U16, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putValue(key, PT_I32, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putValue(key, PT_U32, &value, sizeof(value)); }
+    size_t putLong(const char* key, int32_t value) { return putInt(key, value); }
+    size_t putULong(const char* key, uint32_t value) { return putUInt(key, value); }
+    size_t putLong64(const char* key, int64_t value) { return putValue(key, PT_I64, &value, sizeof(value)); }
+    size_t putULong64(const char* key, uint64_t value) { return putValue(key, PT_U64, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return putValue(key, PT_BLOB, &value, sizeof(value)); }
+    size_t putDouble(const char* key, double value) { return putValue(key, PT_BLOB, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    size_t putString(const char* key, const char* value);
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char* key, const void* value, size_t len) { return putValue(key, PT_BLOB, value, len); }
+
+    int8_t getChar(const char* key, int8_t defaultValue = 0) { return getTyped(key, PT_I8, defaultValue); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getTyped(key, PT_U8, defaultValue); }
+    int16_t getShort(const char* key, int16_t defaultValue = 0) { return getTyped(key, PT_I16, defaultValue); }
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getTyped(key, PT_U16, defaultValue); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return getTyped(key, PT_I32, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getTyped(key, PT_U32, defaultValue); }
+    int32_t getLong(const char* key, int32_t defaultValue = 0) { return getInt(key, defaultValue); }
+    uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getUInt(key, defaultValue); }
+    int64_t getLong64(const char* key, int64_t defaultValue = 0) { return getTyped(key, PT_I64, defaultValue); }
+    uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return getTyped(key, PT_U64, defaultValue); }
+    float getFloat(const char* key, float defaultValue = NAN) { return getTyped(key, PT_BLOB, defaultValue); }
+    double getDouble(const char* key, double defaultValue = NAN) { return getTyped(key, PT_BLOB, defaultValue); }
+    bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+    size_t getString(const char* key, char* value, size_t maxLen);
+    String getString(const char* key, const String& defaultValue = String());
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+    // Host-only: delete every stored namespace (fresh "flash" for a test)
+    static void eraseAll();
+
+private:
+    struct Entry {
+        PreferenceType type;
+        std::vector<uint8_t> data;
+    };
+
+    bool opened;
+    bool readOnly;
+    std::string path;
+    std::map<std::string, Entry> entries;
+
+    size_t putValue(const char* key, PreferenceType type, const void* value, size_t len);
+    const Entry* find(const char* key, PreferenceType type) const;
+    bool load();
+    bool save() const;
+
+    template <typename T>
+    T getTyped(const char* key, PreferenceType type, T defaultValue) {
+        const Entry* entry = find(key, type);
+        if (entry == nullptr || entry->data.size() != sizeof(T)) {
+            return defaultValue;
+        }
+        T value;
+        memcpy(&value, entry->data.data(), sizeof(T));
+        return value;
+    }
+
+    static std::string storageDir();
+};
+
+#endif // SHIM_PREFERENCES_H
@@ -0,0 +1,86 @@
+#include "PubSubClient.h"
+#include "WiFi.h"
+
+bool PubSubClient::brokerAvailable = true;
+
+std::vector<PubSubMessage>& PubSubClient::published() {
+    static std::vector<PubSubMessage> messages;
+    return messages;
+}
+
+void PubSubClient::setBrokerAvailable(bool available) {
+    brokerAvailable = available;
+}
+
+PubSubClient& PubSubClient::setServer(const char* domain, uint16_t serverPort) {
+    server = domain ? domain : "";
+    port = serverPort;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+    this->callback = callback;
+    return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+    if (size == 0) {
+        return false;
+    }
+    bufferSize = size;
+    return true;
+}
+
+bool PubSubClient::connect(const char* id) {
+    return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+    return connect(id, user, pass, nullptr, 0, false, nullptr);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass, const char* willTopic,
+                           uint8_t willQos, bool willRetain, const char* willMessage) {
+    (void)id;
+    (void)user;
+    (void)pass;
+    (void)willTopic;
+    (void)willQos;
+    (void)willRetain;
+    (void)willMessage;
+
+    if (server.empty() || !brokerAvailable || !WiFi.isConnected()) {
+        state_ = MQTT_CONNECT_FAILED;
+        return false;
+    }
+    state_ = MQTT_CONNECTED;
+    return true;
+}
+
+void PubSubClient::disconnect() {
+    state_ = MQTT_DISCONNECTED;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload) {
+    return publish(topic, (const uint8_t*)payload, payload ? strlen(payload) : 0, false);
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+    return publish(topic, (const uint8_t*)payload, payload ? strlen(payload) : 0, retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length) {
+    return publish(topic, payload, length, false);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained) {
+    if (!connected() || topic == nullptr) {
+        return false;
+    }
+    // Same limit as the library: header + topic length field + topic + payload must fit the buffer
+    if (bufferSize < MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + length) {
+        return false;
+    }
+    published().push_back({topic, std::string((const char*)payload, length), retained});
+    return true;
+}
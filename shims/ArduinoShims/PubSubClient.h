@@ -0,0 +1,81 @@
+#ifndef SHIM_PUBSUBCLIENT_H
+#define SHIM_PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Client.h"
+
+#define MQTT_CONNECTION_TIMEOUT     -4
+#define MQTT_CONNECTION_LOST        -3
+#define MQTT_CONNECT_FAILED         -2
+#define MQTT_DISCONNECTED           -1
+#define MQTT_CONNECTED               0
+
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_MAX_HEADER_SIZE 5
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+// A message accepted by PubSubClient::publish() on the host
+struct PubSubMessage {
+    std::string topic;
+    std::string payload;
+    bool retained;
+};
+
+/**
+ * PubSubClient - Broker-less host stub of knolleary/PubSubClient
+ *
+ * connect() succeeds once a server is set (unless the broker is marked down),
+ * and publish() applies the library's packet-size check against the buffer
+ * size, then records the message instead of sending it. Recorded messages are
+ * shared by all instances so tests can inspect what a manager published.
+ */
+class PubSubClient {
+public:
+    PubSubClient() : client(nullptr) {}
+    explicit PubSubClient(Client& netClient) : client(&netClient) {}
+
+    PubSubClient& setServer(const char* domain, uint16_t port);
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+    PubSubClient& setClient(Client& netClient) { client = &netClient; return *this; }
+    PubSubClient& setKeepAlive(uint16_t) { return *this; }
+    PubSubClient& setSocketTimeout(uint16_t) { return *this; }
+    bool setBufferSize(uint16_t size);
+    uint16_t getBufferSize() const { return bufferSize; }
+
+    bool connect(const char* id);
+    bool connect(const char* id, const char* user, const char* pass);
+    bool connect(const char* id, const char* user, const char* pass, const char* willTopic,
+                 uint8_t willQos, bool willRetain, const char* willMessage);
+    void disconnect();
+    bool connected() const { return state_ == MQTT_CONNECTED; }
+    int state() const { return state_; }
+    bool loop() { return connected(); }
+
+    bool publish(const char* topic, const char* payload);
+    bool publish(const char* topic, const char* payload, bool retained);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained);
+
+    bool subscribe(const char* topic, uint8_t qos = 0) { (void)topic; (void)qos; return connected(); }
+    bool unsubscribe(const char* topic) { (void)topic; return connected(); }
+
+    // Host-only: inspect published messages and simulate broker availability
+    static std::vector<PubSubMessage>& published();
+    static void setBrokerAvailable(bool available);
+
+private:
+    Client* client;
+    std::string server;
+    uint16_t port = 1883;
+    uint16_t bufferSize = MQTT_MAX_PACKET_SIZE;
+    int state_ = MQTT_DISCONNECTED;
+    std::function<void(char*, uint8_t*, unsigned int)> callback;
+
+    static bool brokerAvailable;
+};
+
+#endif // SHIM_PUBSUBCLIENT_H
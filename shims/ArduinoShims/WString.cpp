@@ -0,0 +1,201 @@
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+
+namespace {
+
+std::string formatUnsigned(unsigned long long value, unsigned char base) {
+    if (base < 2 || base > 36) {
+        base = 10;
+    }
+    char digits[65];
+    int pos = sizeof(digits) - 1;
+    digits[pos] = '\0';
+    do {
+        unsigned d = value % base;
+        digits[--pos] = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+        value /= base;
+    } while (value > 0);
+    return std::string(&digits[pos]);
+}
+
+std::string formatSigned(long long value, unsigned char base) {
+    // Arduino only prints a sign in base 10; other bases show the two's complement
+    if (base == 10 && value < 0) {
+        return "-" + formatUnsigned(0ULL - (unsigned long long)value, base);
+    }
+    return formatUnsigned((unsigned long long)value, base);
+}
+
+std::string formatFloat(double value, unsigned int decimalPlaces) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    return std::string(buf);
+}
+
+} // namespace
+
+String::String(unsigned char value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(int value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(long value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(long long value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(float value, unsigned int decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {}
+
+bool String::equalsIgnoreCase(const String& s) const {
+    return buffer.length() == s.buffer.length() && strcasecmp(buffer.c_str(), s.buffer.c_str()) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    if (suffix.buffer.length() > buffer.length()) {
+        return false;
+    }
+    return buffer.compare(buffer.length() - suffix.buffer.length(), suffix.buffer.length(), suffix.buffer) == 0;
+}
+
+int String::indexOf(char c, unsigned int fromIndex) const {
+    size_t pos = buffer.find(c, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+    size_t pos = buffer.find(str.buffer, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t pos = buffer.rfind(c);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& str) const {
+    size_t pos = buffer.rfind(str.buffer);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex) const {
+    return substring(beginIndex, length());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+    // Arduino swaps reversed bounds and clamps to the string length
+    if (beginIndex > endIndex) {
+        unsigned int tmp = beginIndex;
+        beginIndex = endIndex;
+        endIndex = tmp;
+    }
+    if (beginIndex >= buffer.length()) {
+        return String();
+    }
+    if (endIndex > buffer.length()) {
+        endIndex = buffer.length();
+    }
+    return String(buffer.substr(beginIndex, endIndex - beginIndex));
+}
+
+void String::replace(char find, char replaceWith) {
+    for (char& c : buffer) {
+        if (c == find) {
+            c = replaceWith;
+        }
+    }
+}
+
+void String::replace(const String& find, const String& replaceWith) {
+    if (find.buffer.empty()) {
+        return;
+    }
+    size_t pos = 0;
+    while ((pos = buffer.find(find.buffer, pos)) != std::string::npos) {
+        buffer.replace(pos, find.buffer.length(), replaceWith.buffer);
+        pos += replaceWith.buffer.length();
+    }
+}
+
+void String::remove(unsigned int index) {
+    if (index < buffer.length()) {
+        buffer.erase(index);
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < buffer.length()) {
+        buffer.erase(index, count);
+    }
+}
+
+void String::toLowerCase() {
+    for (char& c : buffer) {
+        c = (char)tolower((unsigned char)c);
+    }
+}
+
+void String::toUpperCase() {
+    for (char& c : buffer) {
+        c = (char)toupper((unsigned char)c);
+    }
+}
+
+void String::trim() {
+    size_t first = 0;
+    while (first < buffer.length() && isspace((unsigned char)buffer[first])) {
+        first++;
+    }
+    size_t last = buffer.length();
+    while (last > first && isspace((unsigned char)buffer[last - 1])) {
+        last--;
+    }
+    buffer = buffer.substr(first, last - first);
+}
+
+long String::toInt() const {
+    return atol(buffer.c_str());
+}
+
+float String::toFloat() const {
+    return (float)atof(buffer.c_str());
+}
+
+double String::toDouble() const {
+    return atof(buffer.c_str());
+}
+
+StringSumHelper operator+(const String& lhs, const String& rhs) {
+    StringSumHelper sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+StringSumHelper operator+(const String& lhs, const char* rhs) {
+    StringSumHelper sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+StringSumHelper operator+(const char* lhs, const String& rhs) {
+    StringSumHelper sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+#define SHIM_STRING_SUM(type)                                  \
+    StringSumHelper operator+(const String& lhs, type rhs) {   \
+        StringSumHelper sum(lhs);                              \
+        sum.concat(rhs);                                       \
+        return sum;                                            \
+    }
+
+SHIM_STRING_SUM(char)
+SHIM_STRING_SUM(int)
+SHIM_STRING_SUM(unsigned int)
+SHIM_STRING_SUM(long)
+SHIM_STRING_SUM(unsigned long)
+SHIM_STRING_SUM(long long)
+SHIM_STRING_SUM(unsigned long long)
+SHIM_STRING_SUM(float)
+SHIM_STRING_SUM(double)
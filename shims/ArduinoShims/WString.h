@@ -0,0 +1,123 @@
+#ifndef SHIM_WSTRING_H
+#define SHIM_WSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class __FlashStringHelper;
+class StringSumHelper;
+
+/**
+ * String - Host implementation of the Arduino String class
+ *
+ * Backed by std::string. Covers the subset of the Arduino API used by the
+ * firmware libraries (and by ArduinoJson with ARDUINOJSON_ENABLE_ARDUINO_STRING).
+ * Numeric constructors are explicit, matching the ESP32 core.
+ */
+class String {
+public:
+    String(const char* cstr = "") : buffer(cstr ? cstr : "") {}
+    String(const char* cstr, unsigned int length) : buffer(cstr ? cstr : "", cstr ? length : 0) {}
+    String(const std::string& str) : buffer(str) {}
+    String(const __FlashStringHelper* str) : String(reinterpret_cast<const char*>(str)) {}
+    explicit String(char c) : buffer(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimalPlaces = 2);
+    explicit String(double value, unsigned int decimalPlaces = 2);
+
+    unsigned int length() const { return (unsigned int)buffer.length(); }
+    bool isEmpty() const { return buffer.empty(); }
+    bool reserve(unsigned int size) { buffer.reserve(size); return true; }
+    const char* c_str() const { return buffer.c_str(); }
+    char* begin() { return &buffer[0]; }
+    char* end() { return &buffer[0] + buffer.length(); }
+
+    bool concat(const String& str) { buffer += str.buffer; return true; }
+    bool concat(const char* cstr) { if (cstr) buffer += cstr; return cstr != nullptr; }
+    bool concat(const char* cstr, unsigned int length) { if (cstr) buffer.append(cstr, length); return cstr != nullptr; }
+    bool concat(char c) { buffer += c; return true; }
+    bool concat(unsigned char value) { return concat(String(value)); }
+    bool concat(int value) { return concat(String(value)); }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(long value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+    bool concat(long long value) { return concat(String(value)); }
+    bool concat(unsigned long long value) { return concat(String(value)); }
+    bool concat(float value) { return concat(String(value)); }
+    bool concat(double value) { return concat(String(value)); }
+
+    template <typename T>
+    String& operator+=(const T& rhs) { concat(rhs); return *this; }
+
+    int compareTo(const String& s) const { return buffer.compare(s.buffer); }
+    bool equals(const String& s) const { return buffer == s.buffer; }
+    bool equals(const char* cstr) const { return buffer == (cstr ? cstr : ""); }
+    bool equalsIgnoreCase(const String& s) const;
+    bool operator==(const String& rhs) const { return equals(rhs); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& rhs) const { return !equals(rhs); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& rhs) const { return compareTo(rhs) < 0; }
+    bool operator>(const String& rhs) const { return compareTo(rhs) > 0; }
+    bool startsWith(const String& prefix) const { return buffer.compare(0, prefix.buffer.length(), prefix.buffer) == 0; }
+    bool endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const { return index < buffer.length() ? buffer[index] : 0; }
+    void setCharAt(unsigned int index, char c) { if (index < buffer.length()) buffer[index] = c; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return buffer[index]; }
+
+    int indexOf(char c, unsigned int fromIndex = 0) const;
+    int indexOf(const String& str, unsigned int fromIndex = 0) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(const String& str) const;
+    String substring(unsigned int beginIndex) const;
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void replace(char find, char replaceWith);
+    void replace(const String& find, const String& replaceWith);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+    // Host-only convenience for tests
+    const std::string& str() const { return buffer; }
+
+private:
+    std::string buffer;
+};
+
+// Temporary produced by operator+ (ArduinoJson checks for this type by name)
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& s) : String(s) {}
+    StringSumHelper(const char* p) : String(p) {}
+};
+
+StringSumHelper operator+(const String& lhs, const String& rhs);
+StringSumHelper operator+(const String& lhs, const char* rhs);
+StringSumHelper operator+(const char* lhs, const String& rhs);
+StringSumHelper operator+(const String& lhs, char rhs);
+StringSumHelper operator+(const String& lhs, int rhs);
+StringSumHelper operator+(const String& lhs, unsigned int rhs);
+StringSumHelper operator+(const String& lhs, long rhs);
+StringSumHelper operator+(const String& lhs, unsigned long rhs);
+StringSumHelper operator+(const String& lhs, long long rhs);
+StringSumHelper operator+(const String& lhs, unsigned long long rhs);
+StringSumHelper operator+(const String& lhs, float rhs);
+StringSumHelper operator+(const String& lhs, double rhs);
+
+#endif // SHIM_WSTRING_H
@@ -0,0 +1,39 @@
+#ifndef SHIM_WIFI_H
+#define SHIM_WIFI_H
+
+#include <Arduino.h>
+#include "Client.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class WiFiClient : public Client {};
+
+/**
+ * WiFiClass - Station state stub; connected by default, tests can toggle it
+ */
+class WiFiClass {
+public:
+    bool isConnected() const { return linkUp; }
+    wl_status_t status() const { return linkUp ? WL_CONNECTED : WL_DISCONNECTED; }
+    int8_t RSSI() const { return linkUp ? rssi : 0; }
+    String SSID() const { return linkUp ? String("native") : String(); }
+
+    // Host-only: simulate link changes and signal strength
+    void setConnected(bool connected) { linkUp = connected; }
+    void setRSSI(int8_t value) { rssi = value; }
+
+private:
+    bool linkUp = true;
+    int8_t rssi = -60;
+};
+
+extern WiFiClass WiFi;
+
+#endif // SHIM_WIFI_H
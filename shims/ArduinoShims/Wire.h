@@ -0,0 +1,30 @@
+#ifndef SHIM_WIRE_H
+#define SHIM_WIRE_H
+
+#include <Arduino.h>
+
+/**
+ * TwoWire - I2C bus stub with no devices attached (every address NACKs)
+ */
+class TwoWire {
+public:
+    bool begin() { return true; }
+    bool begin(int sda, int scl, uint32_t frequency = 0) { (void)sda; (void)scl; (void)frequency; return true; }
+    bool setClock(uint32_t frequency) { (void)frequency; return true; }
+    void beginTransmission(uint16_t address) { (void)address; }
+    size_t write(uint8_t data) { (void)data; return 1; }
+    size_t write(const uint8_t* data, size_t size) { (void)data; return size; }
+    uint8_t endTransmission(bool sendStop = true) { (void)sendStop; return 2; }  // Address NACK
+    uint8_t requestFrom(uint16_t address, uint8_t size, bool sendStop = true) {
+        (void)address;
+        (void)size;
+        (void)sendStop;
+        return 0;
+    }
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
+extern TwoWire Wire;
+
+#endif // SHIM_WIRE_H
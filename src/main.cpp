@@ -1,6 +1,7 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <ESPmDNS.h>
+#include <LittleFS.h>
 #include "WiFiManager.h"
 #include "WebServer.h"
 #include "CalibrationManager.h"
@@ -9,35 +10,9 @@
 #include "WarningManager.h"
 #include "DerivedMetrics.h"
 #include "DisplayManager.h"
-
-// POET Sensor I2C Configuration
-#define POET_I2C_ADDR 0x1F
-#define I2C_FREQ 400000  // 400 kHz - max supported by POET
-
-// Command byte bits
-#define CMD_TEMPERATURE (1 << 0)  // bit 0
-#define CMD_ORP         (1 << 1)  // bit 1
-#define CMD_PH          (1 << 2)  // bit 2
-#define CMD_EC          (1 << 3)  // bit 3
-#define CMD_ALL         0x0F      // All measurements
-
-// Measurement delays (ms) - from datasheet
-#define DELAY_BASE        100
-#define DELAY_TEMP        384
-#define DELAY_ORP        1664
-#define DELAY_PH          384
-#define DELAY_EC          256
-#define DELAY_ALL_TOTAL  2788  // 100 + 384 + 1664 + 384 + 256
-
-// Structure to hold POET measurement results
-struct POETResult {
-  int32_t temp_mC;   // Temperature in milli-degrees Celsius
-  int32_t orp_uV;    // ORP in micro-volts
-  int32_t ugs_uV;    // pH gate-source potential in micro-volts
-  int32_t ec_nA;     // EC sensor current in nano-Amps
-  int32_t ec_uV;     // EC excitation in micro-volts
-  bool valid;        // Indicates if reading was successful
-};
+#include "POETSensor.h"
+#include "I2CSensorBackend.h"
+#include "SimulatedSensorBackend.h"
 
 // Global objects
 WiFiManager wifiManager;
@@ -46,16 +21,34 @@ MQTTManager mqttManager;
 TankSettingsManager tankSettingsManager;
 WarningManager warningManager;
 DisplayManager displayManager;
+#ifdef POET_SIMULATED
+SimulatedSensorBackend poetBackend;  // Build with -DPOET_SIMULATED to run without hardware
+#else
+I2CSensorBackend poetBackend;
+#endif
+POETSensor poetSensor(poetBackend);
 AquariumWebServer* webServer = nullptr;
 
-// Timing for non-blocking sensor reads
-unsigned long lastSensorRead = 0;
-const unsigned long SENSOR_READ_INTERVAL = 5000; // 5 seconds
+// The history log and the MQTT spill file share the LittleFS data partition
+// (0x160000 bytes in the default ESP32-C3 partition table). Both caps together
+// must leave headroom for LittleFS metadata and copy-on-write blocks.
+const size_t DATA_PARTITION_BYTES = 0x160000;
+const size_t DATA_PARTITION_HEADROOM = 128 * 1024;
+static_assert((size_t)HISTORY_LOG_MAX_SEGMENTS * HISTORY_LOG_SEGMENT_RECORDS * sizeof(HistoryLogRecord) +
+              (size_t)MQTT_OUTBOX_SPILL_MAX_RECORDS * sizeof(MQTTOutboxRecord) +
+              DATA_PARTITION_HEADROOM <= DATA_PARTITION_BYTES,
+              "History log and MQTT spill caps exceed the LittleFS data partition");
+
+// Console measurement report period (sampling itself is scheduled per channel by POETSensor)
+const unsigned long CONSOLE_REPORT_INTERVAL = 5000; // 5 seconds
+unsigned long lastConsoleReport = 0;
+
+// Sequence number of the last sample consumed by loop()
+uint32_t lastSampleSequence = 0;
 
 // Function prototypes
-bool poetInit();
-bool poetMeasure(uint8_t command, POETResult &result);
-int32_t readInt32LE();
+void processMeasurement(const POETResult &result);
+void printMeasurementReport(const POETResult &result, const SensorData &data, bool mqttPublished);
 void printPOETResult(const POETResult &result);
 void processSerialCommands();
 void printHelp();
@@ -117,6 +110,11 @@ void setup() {
   webServer->setWarningManager(&warningManager);
   webServer->begin();
 
+  // Let the MQTT backfill outbox spill to flash (LittleFS is mounted by the web server)
+  if (LittleFS.begin(false)) {
+    mqttManager.setOutboxStorage(LittleFS);
+  }
+
   if (wifiConnected) {
     Serial.println("\n=== System Ready ===");
     Serial.println("Access web interface at:");
@@ -134,7 +132,7 @@ void setup() {
   Serial.println();
 
   // Initialize I2C
-  if (!poetInit()) {
+  if (!poetSensor.begin()) {
     Serial.println("ERROR: Failed to initialize POET sensor!");
     Serial.println("Please check:");
     Serial.println("  - I2C connections (SDA/SCL)");
@@ -150,6 +148,9 @@ void setup() {
     Serial.println("WARNING: OLED display not detected - continuing without display");
   }
 
+  // Start sensor acquisition in its own task so sampling never waits on loop()
+  poetSensor.startTask();
+
   Serial.println();
 }
 
@@ -168,133 +169,11 @@ void loop() {
   // Handle OLED display metric cycling
   displayManager.loop();
 
-  // Non-blocking sensor reading - only read every SENSOR_READ_INTERVAL milliseconds
-  unsigned long currentMillis = millis();
-  if (currentMillis - lastSensorRead >= SENSOR_READ_INTERVAL) {
-    lastSensorRead = currentMillis;
-
+  // Consume the newest sample published by the sampler task (lock-free)
+  if (poetSensor.getSequence() != lastSampleSequence) {
     POETResult result;
-
-    Serial.println("========================================");
-    Serial.println("Starting new measurement cycle...");
-
-    // Perform all measurements
-    if (poetMeasure(CMD_ALL, result)) {
-      // Update web server with new data
-      if (webServer != nullptr) {
-        webServer->updateSensorData(result);
-      }
-
-      printPOETResult(result);
-
-      // Calculate and display engineering units
-      Serial.println("\n--- Converted Values ---");
-
-      // Temperature
-      float temp_C = result.temp_mC / 1000.0;
-      Serial.print("Temperature: ");
-      Serial.print(temp_C, 2);
-      Serial.println(" °C");
-
-      // ORP
-      float orp_mV = result.orp_uV / 1000.0;
-      Serial.print("ORP:         ");
-      Serial.print(orp_mV, 2);
-      Serial.println(" mV");
-
-      // pH (uses calibration if available)
-      float ugs_mV = result.ugs_uV / 1000.0;
-      float pH = calibrationManager.calculatePH(ugs_mV);
-      Serial.print("pH:          ");
-      Serial.print(pH, 2);
-      if (!calibrationManager.hasValidPHCalibration()) {
-        Serial.println(" (uncalibrated - needs buffer calibration!)");
-      } else {
-        Serial.println(" (calibrated)");
-      }
-
-      // EC (uses calibration if available)
-      float ec_mS_cm = calibrationManager.calculateEC(result.ec_nA, result.ec_uV, temp_C);
-      Serial.print("EC:          ");
-      Serial.print(ec_mS_cm, 3);
-      if (!calibrationManager.hasValidECCalibration()) {
-        Serial.println(" mS/cm (uncalibrated - needs known solution!)");
-      } else {
-        Serial.println(" mS/cm (calibrated)");
-      }
-
-      // Update OLED display with sensor data
-      displayManager.updateSensorData(temp_C, orp_mV, pH, ec_mS_cm, result.valid);
-
-      // Calculate derived metrics
-      TankSettings& settings = tankSettingsManager.getSettings();
-      float tds_ppm = DerivedMetrics::calculateTDS(ec_mS_cm, settings.tds_conversion_factor);
-      float co2_ppm = DerivedMetrics::calculateCO2(pH, settings.manual_kh_dkh);
-      float toxic_ammonia_ratio = DerivedMetrics::calculateToxicAmmoniaRatio(temp_C, pH);
-      float nh3_ppm = DerivedMetrics::calculateActualNH3(settings.manual_tan_ppm, toxic_ammonia_ratio);
-      float max_do_mg_l = DerivedMetrics::calculateMaxDO(temp_C);
-
-      float total_fish_length = tankSettingsManager.getTotalStockingLength();
-      float tank_volume = settings.calculated_volume_liters;
-      if (tank_volume <= 0.0 && settings.manual_volume_liters > 0.0) {
-        tank_volume = settings.manual_volume_liters;
-      }
-      float stocking_density = DerivedMetrics::calculateStockingDensity(total_fish_length, tank_volume);
-
-      // Publish to MQTT if connected
-      SensorData sensorData;
-      sensorData.temp_c = temp_C;
-      sensorData.orp_mv = orp_mV;
-      sensorData.ph = pH;
-      sensorData.ec_ms_cm = ec_mS_cm;
-      sensorData.tds_ppm = tds_ppm;
-      sensorData.co2_ppm = co2_ppm;
-      sensorData.nh3_ratio = toxic_ammonia_ratio;
-      sensorData.nh3_ppm = nh3_ppm;
-      sensorData.max_do_mg_l = max_do_mg_l;
-      sensorData.stocking_density = stocking_density;
-      sensorData.valid = result.valid;
-
-      // Add warning states
-      SensorWarningState warningStates = warningManager.getSensorState();
-      sensorData.temp_state = (uint8_t)warningStates.temperature.state;
-      sensorData.ph_state = (uint8_t)warningStates.ph.state;
-      sensorData.nh3_state = (uint8_t)warningStates.nh3.state;
-      sensorData.orp_state = (uint8_t)warningStates.orp.state;
-      sensorData.ec_state = (uint8_t)warningStates.conductivity.state;
-      sensorData.do_state = (uint8_t)warningStates.dissolved_oxygen.state;
-
-      if (mqttManager.publishSensorData(sensorData)) {
-        Serial.println("\nMQTT: Sensor data published (including derived metrics)");
-      } else if (mqttManager.isConnected()) {
-        Serial.println("\nMQTT: Failed to publish (will retry)");
-      }
-
-      // Calculate resistance for EC measurement
-      if (result.ec_nA != 0) {
-        float resistance_ohm = (float)result.ec_uV / (float)result.ec_nA;
-        Serial.print("EC Resistance: ");
-        Serial.print(resistance_ohm, 1);
-        Serial.println(" Ohm");
-      }
-
-      // Display WiFi status
-      if (wifiManager.isConnected()) {
-        Serial.print("\nWiFi: Connected (");
-        Serial.print(WiFi.RSSI());
-        Serial.println(" dBm)");
-      } else if (wifiManager.isAPMode()) {
-        Serial.print("\nWiFi: AP Mode - Clients: ");
-        Serial.println(WiFi.softAPgetStationNum());
-      }
-
-    } else {
-      Serial.println("ERROR: Failed to read sensor!");
-      // Still update web server with invalid data
-      if (webServer != nullptr) {
-        webServer->updateSensorData(result);
-      }
-    }
+    lastSampleSequence = poetSensor.getLatest(result);
+    processMeasurement(result);
   }
 
   // Small delay to prevent tight looping and allow background tasks
@@ -302,113 +181,144 @@ void loop() {
 }
 
 /**
- * Initialize I2C and check for POET sensor presence
+ * Convert and distribute a finished measurement to all consumers
  */
-bool poetInit() {
-  // Initialize I2C with standard SDA/SCL pins
-  Wire.begin();
-  Wire.setClock(I2C_FREQ);
+void processMeasurement(const POETResult &result) {
+  // Console report is throttled - fast channels publish several samples per second
+  bool report = (millis() - lastConsoleReport >= CONSOLE_REPORT_INTERVAL);
+  if (report) {
+    lastConsoleReport = millis();
+  }
 
-  // Check if device responds
-  Wire.beginTransmission(POET_I2C_ADDR);
-  uint8_t error = Wire.endTransmission();
+  // Update web server with new data (invalid data clears its valid flag)
+  if (webServer != nullptr) {
+    webServer->updateSensorData(result);
+  }
+
+  if (!result.valid) {
+    if (report) {
+      Serial.println("========================================");
+      Serial.println("ERROR: Failed to read sensor!");
+    }
+    return;
+  }
 
-  return (error == 0);  // 0 = success
+  // Convert to engineering units
+  float temp_C = result.temp_mC / 1000.0;
+  float orp_mV = result.orp_uV / 1000.0;
+  float ugs_mV = result.ugs_uV / 1000.0;
+  float pH = calibrationManager.calculatePH(ugs_mV);
+  float ec_mS_cm = calibrationManager.calculateEC(result.ec_nA, result.ec_uV, temp_C);
+
+  // Update OLED display with sensor data
+  displayManager.updateSensorData(temp_C, orp_mV, pH, ec_mS_cm, result.valid);
+
+  // Calculate derived metrics
+  TankSettings& settings = tankSettingsManager.getSettings();
+  float tds_ppm = DerivedMetrics::calculateTDS(ec_mS_cm, settings.tds_conversion_factor);
+  float co2_ppm = DerivedMetrics::calculateCO2(pH, settings.manual_kh_dkh);
+  float toxic_ammonia_ratio = DerivedMetrics::calculateToxicAmmoniaRatio(temp_C, pH);
+  float nh3_ppm = DerivedMetrics::calculateActualNH3(settings.manual_tan_ppm, toxic_ammonia_ratio);
+  float max_do_mg_l = DerivedMetrics::calculateMaxDO(temp_C);
+
+  float total_fish_length = tankSettingsManager.getTotalStockingLength();
+  float tank_volume = settings.calculated_volume_liters;
+  if (tank_volume <= 0.0 && settings.manual_volume_liters > 0.0) {
+    tank_volume = settings.manual_volume_liters;
+  }
+  float stocking_density = DerivedMetrics::calculateStockingDensity(total_fish_length, tank_volume);
+
+  // Publish to MQTT if connected
+  SensorData sensorData;
+  sensorData.temp_c = temp_C;
+  sensorData.orp_mv = orp_mV;
+  sensorData.ph = pH;
+  sensorData.ec_ms_cm = ec_mS_cm;
+  sensorData.tds_ppm = tds_ppm;
+  sensorData.co2_ppm = co2_ppm;
+  sensorData.nh3_ratio = toxic_ammonia_ratio;
+  sensorData.nh3_ppm = nh3_ppm;
+  sensorData.max_do_mg_l = max_do_mg_l;
+  sensorData.stocking_density = stocking_density;
+  sensorData.valid = result.valid;
+
+  // Add warning states
+  SensorWarningState warningStates = warningManager.getSensorState();
+  sensorData.temp_state = (uint8_t)warningStates.temperature.state;
+  sensorData.ph_state = (uint8_t)warningStates.ph.state;
+  sensorData.nh3_state = (uint8_t)warningStates.nh3.state;
+  sensorData.orp_state = (uint8_t)warningStates.orp.state;
+  sensorData.ec_state = (uint8_t)warningStates.conductivity.state;
+  sensorData.do_state = (uint8_t)warningStates.dissolved_oxygen.state;
+
+  bool mqttPublished = mqttManager.publishSensorData(sensorData);
+
+  if (report) {
+    printMeasurementReport(result, sensorData, mqttPublished);
+  }
 }
 
 /**
- * Perform measurement with POET sensor
- * @param command Bit mask of measurements to perform (CMD_TEMPERATURE, CMD_ORP, CMD_PH, CMD_EC)
- * @param result Reference to POETResult structure to store results
- * @return true if successful, false otherwise
+ * Print a human readable report of the latest measurement to the console
  */
-bool poetMeasure(uint8_t command, POETResult &result) {
-  result.valid = false;
-
-  // Send command byte to POET
-  Wire.beginTransmission(POET_I2C_ADDR);
-  Wire.write(command);
-  uint8_t error = Wire.endTransmission();
-
-  if (error != 0) {
-    Serial.print("I2C transmission error: ");
-    Serial.println(error);
-    return false;
-  }
-
-  // Calculate required delay based on requested measurements
-  uint16_t delay_ms = DELAY_BASE;
-  if (command & CMD_TEMPERATURE) delay_ms += DELAY_TEMP;
-  if (command & CMD_ORP)        delay_ms += DELAY_ORP;
-  if (command & CMD_PH)         delay_ms += DELAY_PH;
-  if (command & CMD_EC)         delay_ms += DELAY_EC;
-
-  Serial.print("Waiting ");
-  Serial.print(delay_ms);
-  Serial.println(" ms for measurement...");
-
-  // Note: This delay is required by the POET sensor hardware for measurement completion
-  // It cannot be made non-blocking without more complex state machine implementation
-  delay(delay_ms);
-
-  // Calculate expected number of bytes based on command
-  uint8_t expected_bytes = 0;
-  if (command & CMD_TEMPERATURE) expected_bytes += 4;
-  if (command & CMD_ORP)        expected_bytes += 4;
-  if (command & CMD_PH)         expected_bytes += 4;
-  if (command & CMD_EC)         expected_bytes += 8;
-
-  // Request data from POET
-  uint8_t bytes_received = Wire.requestFrom((uint16_t)POET_I2C_ADDR, (uint8_t)expected_bytes);
-
-  if (bytes_received != expected_bytes) {
-    Serial.print("ERROR: Expected ");
-    Serial.print(expected_bytes);
-    Serial.print(" bytes, received ");
-    Serial.println(bytes_received);
-    return false;
+void printMeasurementReport(const POETResult &result, const SensorData &data, bool mqttPublished) {
+  Serial.println("========================================");
+  printPOETResult(result);
+
+  // Calculate and display engineering units
+  Serial.println("\n--- Converted Values ---");
+
+  // Temperature
+  Serial.print("Temperature: ");
+  Serial.print(data.temp_c, 2);
+  Serial.println(" °C");
+
+  // ORP
+  Serial.print("ORP:         ");
+  Serial.print(data.orp_mv, 2);
+  Serial.println(" mV");
+
+  // pH (uses calibration if available)
+  Serial.print("pH:          ");
+  Serial.print(data.ph, 2);
+  if (!calibrationManager.hasValidPHCalibration()) {
+    Serial.println(" (uncalibrated - needs buffer calibration!)");
+  } else {
+    Serial.println(" (calibrated)");
   }
 
-  // Read results in order: Temperature, ORP, pH, EC
-  // All values are 32-bit signed integers in little-endian format
-
-  if (command & CMD_TEMPERATURE) {
-    result.temp_mC = readInt32LE();
+  // EC (uses calibration if available)
+  Serial.print("EC:          ");
+  Serial.print(data.ec_ms_cm, 3);
+  if (!calibrationManager.hasValidECCalibration()) {
+    Serial.println(" mS/cm (uncalibrated - needs known solution!)");
+  } else {
+    Serial.println(" mS/cm (calibrated)");
   }
 
-  if (command & CMD_ORP) {
-    result.orp_uV = readInt32LE();
+  if (mqttPublished) {
+    Serial.println("\nMQTT: Sensor data published (including derived metrics)");
+  } else if (mqttManager.isConnected()) {
+    Serial.println("\nMQTT: Failed to publish (will retry)");
   }
 
-  if (command & CMD_PH) {
-    result.ugs_uV = readInt32LE();
+  // Calculate resistance for EC measurement
+  if (result.ec_nA != 0) {
+    float resistance_ohm = (float)result.ec_uV / (float)result.ec_nA;
+    Serial.print("EC Resistance: ");
+    Serial.print(resistance_ohm, 1);
+    Serial.println(" Ohm");
   }
 
-  if (command & CMD_EC) {
-    result.ec_nA = readInt32LE();
-    result.ec_uV = readInt32LE();
+  // Display WiFi status
+  if (wifiManager.isConnected()) {
+    Serial.print("\nWiFi: Connected (");
+    Serial.print(WiFi.RSSI());
+    Serial.println(" dBm)");
+  } else if (wifiManager.isAPMode()) {
+    Serial.print("\nWiFi: AP Mode - Clients: ");
+    Serial.println(WiFi.softAPgetStationNum());
   }
-
-  result.valid = true;
-  return true;
-}
-
-/**
- * Read 32-bit signed integer in little-endian format from I2C
- */
-int32_t readInt32LE() {
-  uint8_t b0 = Wire.read();
-  uint8_t b1 = Wire.read();
-  uint8_t b2 = Wire.read();
-  uint8_t b3 = Wire.read();
-
-  // Combine bytes in little-endian order
-  int32_t value = (int32_t)b0 |
-                  ((int32_t)b1 << 8) |
-                  ((int32_t)b2 << 16) |
-                  ((int32_t)b3 << 24);
-
-  return value;
 }
 
 /**
@@ -416,14 +326,14 @@ int32_t readInt32LE() {
  */
 void printPOETResult(const POETResult &result) {
   Serial.println("\n--- Raw Sensor Values ---");
-  Serial.print("temp_mC:  ");
-  Serial.println(result.temp_mC);
-  Serial.print("orp_uV:   ");
-  Serial.println(result.orp_uV);
-  Serial.print("ugs_uV:   ");
-  Serial.println(result.ugs_uV);
-  Serial.print("ec_nA:    ");
-  Serial.println(result.ec_nA);
+  Serial.printf("temp_mC:  %ld (age %lu ms)\n", (long)result.temp_mC,
+                POETSensor::getChannelAge(result, POET_CH_TEMPERATURE));
+  Serial.printf("orp_uV:   %ld (age %lu ms)\n", (long)result.orp_uV,
+                POETSensor::getChannelAge(result, POET_CH_ORP));
+  Serial.printf("ugs_uV:   %ld (age %lu ms)\n", (long)result.ugs_uV,
+                POETSensor::getChannelAge(result, POET_CH_PH));
+  Serial.printf("ec_nA:    %ld (age %lu ms)\n", (long)result.ec_nA,
+                POETSensor::getChannelAge(result, POET_CH_EC));
   Serial.print("ec_uV:    ");
   Serial.println(result.ec_uV);
 }
@@ -514,9 +424,8 @@ void dumpDataCSV() {
     return;
   }
 
-  int historyCount = webServer->getHistoryCount();
-  int historyHead = webServer->getHistoryHead();
-  const DataPoint* history = webServer->getHistory();
+  const HistoryStore& history = webServer->getHistory();
+  int historyCount = history.getCount();
 
   Serial.println("\n=== Data Dump (CSV Format) ===");
   Serial.println("# Aquarium Monitor Data Export");
@@ -545,17 +454,16 @@ void dumpDataCSV() {
   Serial.println("Timestamp,Unix_Time,Temperature_C,ORP_mV,pH,EC_mS_cm,Temp_State,pH_State,ORP_State,EC_State,Valid");
 
   // Output data in chronological order
-  int startIdx = historyCount < HISTORY_SIZE ? 0 : historyHead;
   int validCount = 0;
 
   for (int i = 0; i < historyCount; i++) {
-    int idx = (startIdx + i) % HISTORY_SIZE;
+    DataPoint dp = history.at(i);
 
-    if (history[idx].valid) {
+    if (dp.valid) {
       validCount++;
 
       // Format timestamp
-      time_t ts = history[idx].timestamp;
+      time_t ts = dp.timestamp;
       if (ts > 100000) {
         // Convert timestamp to readable format
         struct tm* timeinfo = localtime(&ts);
@@ -568,33 +476,33 @@ void dumpDataCSV() {
       Serial.print(",");
 
       // Unix timestamp
-      Serial.print(history[idx].timestamp);
+      Serial.print(dp.timestamp);
       Serial.print(",");
 
       // Temperature
-      Serial.print(history[idx].temp_c, 2);
+      Serial.print(dp.temp_c, 2);
       Serial.print(",");
 
       // ORP
-      Serial.print(history[idx].orp_mv, 2);
+      Serial.print(dp.orp_mv, 2);
       Serial.print(",");
 
       // pH
-      Serial.print(history[idx].ph, 2);
+      Serial.print(dp.ph, 2);
       Serial.print(",");
 
       // EC
-      Serial.print(history[idx].ec_ms_cm, 3);
+      Serial.print(dp.ec_ms_cm, 3);
       Serial.print(",");
 
       // Warning states
-      Serial.print(history[idx].temp_state);
+      Serial.print(dp.temp_state);
       Serial.print(",");
-      Serial.print(history[idx].ph_state);
+      Serial.print(dp.ph_state);
       Serial.print(",");
-      Serial.print(history[idx].orp_state);
+      Serial.print(dp.orp_state);
       Serial.print(",");
-      Serial.print(history[idx].ec_state);
+      Serial.print(dp.ec_state);
       Serial.print(",");
 
       // Valid flag
@@ -617,9 +525,8 @@ void dumpDataJSON() {
     return;
   }
 
-  int historyCount = webServer->getHistoryCount();
-  int historyHead = webServer->getHistoryHead();
-  const DataPoint* history = webServer->getHistory();
+  const HistoryStore& history = webServer->getHistory();
+  int historyCount = history.getCount();
 
   Serial.println("\n=== Data Dump (JSON Format) ===");
 
@@ -658,13 +565,12 @@ void dumpDataJSON() {
   Serial.println("  \"data\": [");
 
   // Output data in chronological order
-  int startIdx = historyCount < HISTORY_SIZE ? 0 : historyHead;
   int validCount = 0;
 
   for (int i = 0; i < historyCount; i++) {
-    int idx = (startIdx + i) % HISTORY_SIZE;
+    DataPoint dp = history.at(i);
 
-    if (history[idx].valid) {
+    if (dp.valid) {
       if (validCount > 0) {
         Serial.println(",");
       }
@@ -672,19 +578,19 @@ void dumpDataJSON() {
 
       Serial.println("    {");
       Serial.print("      \"timestamp\": ");
-      Serial.print(history[idx].timestamp);
+      Serial.print(dp.timestamp);
       Serial.println(",");
       Serial.print("      \"temp_c\": ");
-      Serial.print(history[idx].temp_c, 2);
+      Serial.print(dp.temp_c, 2);
       Serial.println(",");
       Serial.print("      \"orp_mv\": ");
-      Serial.print(history[idx].orp_mv, 2);
+      Serial.print(dp.orp_mv, 2);
       Serial.println(",");
       Serial.print("      \"ph\": ");
-      Serial.print(history[idx].ph, 2);
+      Serial.print(dp.ph, 2);
       Serial.println(",");
       Serial.print("      \"ec_ms_cm\": ");
-      Serial.print(history[idx].ec_ms_cm, 3);
+      Serial.print(dp.ec_ms_cm, 3);
       Serial.println(",");
       Serial.println("      \"valid\": true");
       Serial.print("    }");
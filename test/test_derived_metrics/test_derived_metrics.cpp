@@ -1,6 +1,6 @@
 #include <Arduino.h>
 #include <unity.h>
-#include "../lib/DerivedMetrics/DerivedMetrics.h"
+#include "DerivedMetrics.h"
 
 // Test helper to check if value is within expected range
 void assertInRange(float value, float min, float max, const char* message) {
@@ -101,8 +101,7 @@ void test_nh3_ppm_zero_tan() {
     TEST_ASSERT_EQUAL_FLOAT_MESSAGE(0.0, nh3_ppm, "Zero TAN should give zero NH3");
 }
 
-void setup() {
-    delay(2000);  // Wait for serial
+int runUnityTests() {
     UNITY_BEGIN();
 
     RUN_TEST(test_ammonia_calculation_reference);
@@ -114,9 +113,20 @@ void setup() {
     RUN_TEST(test_nh3_ppm_calculation);
     RUN_TEST(test_nh3_ppm_zero_tan);
 
-    UNITY_END();
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
 }
 
 void loop() {
     // Tests run once in setup()
 }
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,221 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "HistoryBinary.h"
+
+static HistoryStore store;
+
+DataPoint makePoint(time_t timestamp, float temp_c) {
+    DataPoint dp;
+    memset(&dp, 0, sizeof(dp));
+    dp.timestamp = timestamp;
+    dp.temp_c = temp_c;
+    dp.orp_mv = 250.0;
+    dp.ph = 7.2;
+    dp.ec_ms_cm = 0.4;
+    dp.stocking_density = 1.5;
+    dp.valid = true;
+    return dp;
+}
+
+uint32_t readU32(const uint8_t* in) {
+    return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+}
+
+float readF32(const uint8_t* in) {
+    uint32_t bits = readU32(in);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint16_t readU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | in[1] << 8);
+}
+
+// Drain a stream with a fixed chunk size (as the TCP buffer would)
+std::vector<uint8_t> readAll(HistoryExportStream& stream, size_t chunkSize) {
+    std::vector<uint8_t> output;
+    uint8_t buffer[512];
+    size_t bytes;
+    while ((bytes = stream.read(buffer, chunkSize)) > 0) {
+        output.insert(output.end(), buffer, buffer + bytes);
+    }
+    return output;
+}
+
+void setUp() {
+    store.clear();
+}
+
+void tearDown() {
+}
+
+// Test: Little-endian writers are independent of host byte order
+void test_little_endian() {
+    uint8_t out[4];
+    HistoryBinary::putU32(out, 0x12345678);
+    TEST_ASSERT_EQUAL_UINT8(0x78, out[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x56, out[1]);
+    TEST_ASSERT_EQUAL_UINT8(0x34, out[2]);
+    TEST_ASSERT_EQUAL_UINT8(0x12, out[3]);
+
+    HistoryBinary::putU16(out, 0xBEEF);
+    TEST_ASSERT_EQUAL_UINT8(0xEF, out[0]);
+    TEST_ASSERT_EQUAL_UINT8(0xBE, out[1]);
+
+    HistoryBinary::putF32(out, 1.0f);  // 0x3F800000
+    TEST_ASSERT_EQUAL_UINT32(0x3F800000, readU32(out));
+}
+
+// Test: Point frame header and values land at their documented offsets
+void test_point_frame_layout() {
+    DataPoint dp = makePoint(1736294400, 25.5);
+    dp.ph_state = 2;
+
+    uint8_t frame[HISTORY_POINT_FRAME_SIZE];
+    TEST_ASSERT_EQUAL_UINT32(52, HISTORY_POINT_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(52, HistoryBinary::encodePointFrame(dp, 0xCAFE0001, frame, sizeof(frame)));
+
+    TEST_ASSERT_EQUAL_UINT8(HISTORY_BINARY_VERSION, frame[0]);
+    TEST_ASSERT_EQUAL_UINT8(HISTORY_FRAME_POINT, frame[1]);
+    TEST_ASSERT_EQUAL_UINT16(HistoryStore::packFlags(dp), frame[2] | frame[3] << 8);
+    TEST_ASSERT_EQUAL_UINT32(0xCAFE0001, readU32(frame + 4));
+    TEST_ASSERT_EQUAL_UINT32(1736294400, readU32(frame + 8));
+
+    const uint8_t* values = frame + HISTORY_POINT_HEADER_SIZE;
+    TEST_ASSERT_EQUAL_FLOAT(25.5, readF32(values + 4 * HISTORY_FIELD_TEMP));
+    TEST_ASSERT_EQUAL_FLOAT(7.2, readF32(values + 4 * HISTORY_FIELD_PH));
+    TEST_ASSERT_EQUAL_FLOAT(0.4, readF32(values + 4 * HISTORY_FIELD_EC));
+    TEST_ASSERT_EQUAL_FLOAT(1.5, readF32(values + 4 * HISTORY_FIELD_STOCKING));
+}
+
+// Test: Missing readings stay NaN, short buffers are rejected
+void test_point_frame_edge_cases() {
+    DataPoint dp = makePoint(1000, NAN);
+    uint8_t frame[HISTORY_POINT_FRAME_SIZE];
+    HistoryBinary::encodePointFrame(dp, 1, frame, sizeof(frame));
+    TEST_ASSERT_TRUE(isnan(readF32(frame + HISTORY_POINT_HEADER_SIZE)));
+
+    TEST_ASSERT_EQUAL_UINT32(0, HistoryBinary::encodePointFrame(dp, 1, frame, sizeof(frame) - 1));
+}
+
+// Test: Column header, aligned columns and values identical to decoded points
+void test_columns_layout() {
+    HistoryDerivedContext context = { 0.64, 4.0, 1.0, 1.5 };
+    store.setDerivedContext(context);
+    for (int i = 0; i < 3; i++) {
+        store.add(makePoint(1000 + i * 5, 25.0 + i));
+    }
+
+    HistoryColumnStream stream(store, store.sequenceAt(0), HISTORY_FIELDS_ALL, 100, HISTORY_COLUMNS_NTP_SYNCED);
+    std::vector<uint8_t> data = readAll(stream, 512);
+    const uint8_t* in = data.data();
+    TEST_ASSERT_EQUAL_UINT32(16 + 3 * 4 + 4 * 2 + 3 * 4 * HISTORY_FIELD_COUNT, data.size());
+    TEST_ASSERT_EQUAL_UINT32(stream.getLength(), data.size());
+
+    TEST_ASSERT_EQUAL_UINT8(HISTORY_BINARY_VERSION, in[0]);
+    TEST_ASSERT_EQUAL_UINT8(HISTORY_FRAME_COLUMNS, in[1]);
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_FIELDS_ALL, readU16(in + 2));
+    TEST_ASSERT_EQUAL_UINT32(3, readU32(in + 4));
+    TEST_ASSERT_EQUAL_UINT32(100 + store.getSequence(), readU32(in + 8));
+    TEST_ASSERT_EQUAL_UINT8(HISTORY_COLUMNS_NTP_SYNCED, in[12]);
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_INTERVAL_MS / 1000, readU16(in + 14));
+
+    const uint8_t* times = in + HISTORY_COLUMNS_HEADER_SIZE;
+    const uint8_t* flags = times + 3 * 4;
+    const uint8_t* values = flags + 4 * 2;  // 3 flags + padding
+    TEST_ASSERT_EQUAL_UINT32(1010, readU32(times + 8));
+    TEST_ASSERT_EQUAL_UINT16(0, readU16(flags + 6));
+    for (int i = 0; i < 3; i++) {
+        DataPoint dp = store.at(i);
+        TEST_ASSERT_EQUAL_UINT16(HistoryStore::packFlags(dp), readU16(flags + 2 * i));
+        for (int field = 0; field < HISTORY_FIELD_COUNT; field++) {
+            float expected = HistoryBinary::getFieldValue(dp, (HistoryField)field);
+            TEST_ASSERT_EQUAL_FLOAT(expected, readF32(values + 4 * (field * 3 + i)));
+        }
+    }
+}
+
+// Test: Field selection, since-style start index, chunking and gaps
+void test_columns_fields_and_chunks() {
+    for (int i = 0; i < 200; i++) {
+        DataPoint dp = makePoint(1000 + i * 5, 20.0 + i * 0.1);
+        dp.valid = (i % 7) != 0;
+        store.add(dp);
+    }
+
+    uint16_t fields = (1 << HISTORY_FIELD_PH) | (1 << HISTORY_FIELD_STOCKING);
+    HistoryColumnStream whole(store, store.sequenceAt(150), fields, 0, HISTORY_COLUMNS_DELTA);
+    HistoryColumnStream chunked(store, store.sequenceAt(150), fields, 0, HISTORY_COLUMNS_DELTA);
+    std::vector<uint8_t> data = readAll(whole, 512);
+    TEST_ASSERT_TRUE(data == readAll(chunked, 7));
+
+    TEST_ASSERT_EQUAL_UINT32(50, whole.getRowCount());
+    TEST_ASSERT_EQUAL_UINT32(16 + 50 * 4 + 50 * 2 + 2 * 50 * 4, data.size());
+    TEST_ASSERT_EQUAL_UINT32(store.getSequence(), readU32(data.data() + 8));
+
+    const uint8_t* times = data.data() + HISTORY_COLUMNS_HEADER_SIZE;
+    const uint8_t* flags = times + 50 * 4;
+    const uint8_t* ph = flags + 50 * 2;
+    TEST_ASSERT_EQUAL_UINT32(1000 + 150 * 5, readU32(times));
+    TEST_ASSERT_EQUAL_UINT16(0, readU16(flags + 2 * 4) & HISTORY_FLAG_VALID);  // Point 154 is a gap
+    TEST_ASSERT_TRUE(isnan(readF32(ph + 4 * 4)));
+    TEST_ASSERT_EQUAL_FLOAT(7.2, readF32(ph));
+    TEST_ASSERT_EQUAL_FLOAT(1.5, readF32(ph + 50 * 4 + 4));
+}
+
+// Test: Rows evicted mid-stream keep their place, points appended mid-stream are left out
+void test_columns_concurrent_changes() {
+    for (int i = 0; i < HISTORY_SIZE; i++) {
+        store.add(makePoint(1000 + i * 5, 25.0));
+    }
+
+    HistoryColumnStream stream(store, store.sequenceAt(0), 1 << HISTORY_FIELD_TEMP, 0, 0);
+    size_t length = stream.getLength();
+    std::vector<uint8_t> data(length);
+    size_t first = stream.read(data.data(), HISTORY_COLUMNS_HEADER_SIZE + HISTORY_SIZE * 4);
+    for (int i = 0; i < HISTORY_BLOCK_SIZE; i++) {
+        store.add(makePoint(1000 + (HISTORY_SIZE + i) * 5, 30.0));
+    }
+    size_t rest = stream.read(data.data() + first, length - first);
+    TEST_ASSERT_EQUAL_UINT32(length, first + rest);
+    TEST_ASSERT_EQUAL_UINT32(0, stream.read(data.data(), 16));
+
+    const uint8_t* times = data.data() + HISTORY_COLUMNS_HEADER_SIZE;
+    const uint8_t* flags = times + HISTORY_SIZE * 4;
+    const uint8_t* temps = flags + HISTORY_SIZE * 2;
+    TEST_ASSERT_EQUAL_UINT32(1000, readU32(times));  // Sent before the eviction
+    TEST_ASSERT_EQUAL_UINT16(0, readU16(flags));
+    TEST_ASSERT_TRUE(isnan(readF32(temps)));
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_FLAG_VALID, readU16(flags + 2 * HISTORY_BLOCK_SIZE));
+    TEST_ASSERT_EQUAL_FLOAT(25.0, readF32(temps + 4 * (HISTORY_SIZE - 1)));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_little_endian);
+    RUN_TEST(test_point_frame_layout);
+    RUN_TEST(test_point_frame_edge_cases);
+    RUN_TEST(test_columns_layout);
+    RUN_TEST(test_columns_fields_and_chunks);
+    RUN_TEST(test_columns_concurrent_changes);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,204 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include "HistoryExport.h"
+
+static HistoryStore store;
+
+DataPoint makePoint(time_t timestamp, float temp_c) {
+    DataPoint dp;
+    memset(&dp, 0, sizeof(dp));
+    dp.timestamp = timestamp;
+    dp.temp_c = temp_c;
+    dp.orp_mv = 250.0;
+    dp.ph = 7.2;
+    dp.ec_ms_cm = 0.4;
+    dp.valid = true;
+    return dp;
+}
+
+// Drain a stream with a fixed chunk size (as the TCP buffer would)
+std::string readAll(HistoryExportStream& stream, size_t chunkSize) {
+    std::string output;
+    uint8_t buffer[512];
+    size_t bytes;
+    while ((bytes = stream.read(buffer, chunkSize)) > 0) {
+        output.append((const char*)buffer, bytes);
+    }
+    return output;
+}
+
+int countLines(const std::string& text) {
+    int lines = 0;
+    for (char c : text) {
+        if (c == '\n') {
+            lines++;
+        }
+    }
+    return lines;
+}
+
+void setUp() {
+    store.clear();
+}
+
+void tearDown() {
+}
+
+// Test: Metadata, column header and one formatted row per point
+void test_csv_layout() {
+    for (int i = 0; i < 3; i++) {
+        store.add(makePoint(1000 + i * 5, 25.0 + i));
+    }
+
+    HistoryCsvStream stream(store, "# Test\r\n");
+    std::string csv = readAll(stream, 512);
+
+    TEST_ASSERT_EQUAL_INT(5, countLines(csv));
+    TEST_ASSERT_EQUAL_INT(0, (int)csv.find("# Test\r\nTimestamp,Unix_Time,Temperature_C,"));
+    TEST_ASSERT_TRUE(csv.find("N/A,1000,25.00,250.00,7.20,0.400,") != std::string::npos);
+    TEST_ASSERT_TRUE(csv.find("N/A,1010,27.00,") != std::string::npos);
+    TEST_ASSERT_EQUAL_INT(0, (int)csv.compare(csv.size() - 7, 7, ",true\r\n"));
+    TEST_ASSERT_EQUAL_UINT32(3, stream.getPointCount());
+}
+
+// Test: Tiny send buffers produce exactly the same bytes as one large read
+void test_csv_small_chunks() {
+    for (int i = 0; i < 100; i++) {
+        store.add(makePoint(1000 + i * 5, 20.0 + i * 0.1));
+    }
+
+    HistoryCsvStream whole(store, "# Test\r\n");
+    HistoryCsvStream chunked(store, "# Test\r\n");
+    std::string expected = readAll(whole, 512);
+    TEST_ASSERT_TRUE(expected == readAll(chunked, 7));
+    TEST_ASSERT_EQUAL_INT(102, countLines(expected));
+}
+
+// Test: Metadata longer than the line buffer is passed through intact
+void test_csv_long_header() {
+    store.add(makePoint(1000, 25.0));
+
+    std::string header;
+    for (int i = 0; i < 20; i++) {
+        header += "# Metadata line that is long enough to span several line buffers\r\n";
+    }
+    HistoryCsvStream stream(store, String(header.c_str()));
+    std::string csv = readAll(stream, 100);
+    TEST_ASSERT_EQUAL_INT(0, (int)csv.find(header + "Timestamp,"));
+    TEST_ASSERT_EQUAL_INT(22, countLines(csv));
+}
+
+// Test: Invalid points are skipped
+void test_csv_skips_invalid() {
+    store.add(makePoint(1000, 25.0));
+    DataPoint invalid = makePoint(1005, 0.0);
+    invalid.valid = false;
+    store.add(invalid);
+    store.add(makePoint(1010, 26.0));
+
+    HistoryCsvStream stream(store, "");
+    std::string csv = readAll(stream, 512);
+    TEST_ASSERT_EQUAL_INT(3, countLines(csv));
+    TEST_ASSERT_TRUE(csv.find(",1005,") == std::string::npos);
+}
+
+// Test: Points appended mid-export are left out, evicted ones are skipped without repeats
+void test_csv_concurrent_appends() {
+    for (int i = 0; i < HISTORY_SIZE; i++) {
+        store.add(makePoint(1000 + i * 5, 25.0));
+    }
+
+    HistoryCsvStream stream(store, "");
+    uint8_t buffer[256];
+    stream.read(buffer, sizeof(buffer));  // Column header and the first row
+    int lastTime = 0;
+    for (int i = 0; i < 2 * HISTORY_BLOCK_SIZE; i++) {
+        store.add(makePoint(1000 + (HISTORY_SIZE + i) * 5, 30.0));
+    }
+
+    std::string rest = readAll(stream, 512);
+    size_t pos = 0;
+    int rows = 0;
+    while ((pos = rest.find("N/A,", pos)) != std::string::npos) {
+        int timestamp = atoi(rest.c_str() + pos + 4);
+        TEST_ASSERT_TRUE(timestamp > lastTime);
+        TEST_ASSERT_TRUE(timestamp < 1000 + HISTORY_SIZE * 5);
+        lastTime = timestamp;
+        pos += 4;
+        rows++;
+    }
+    TEST_ASSERT_EQUAL_INT(HISTORY_SIZE - 2 * HISTORY_BLOCK_SIZE, rows);
+}
+
+// Test: JSON sections are written in order with one object per valid point
+void test_json_layout() {
+    for (int i = 0; i < 3; i++) {
+        store.add(makePoint(1000 + i * 5, 25.0 + i));
+    }
+
+    HistoryJsonStream stream(store, "{\"name\":\"Tank\"}");
+    std::string json = readAll(stream, 512);
+
+    TEST_ASSERT_EQUAL_INT(0, (int)json.find("{\"device\":{\"name\":\"Tank\"},\"data\":[{\"timestamp\":1000,"
+                                            "\"temp_c\":25.00,\"orp_mv\":250.00,\"ph\":7.20,\"ec_ms_cm\":0.400,"));
+    TEST_ASSERT_TRUE(json.find("\"valid\":true},{\"timestamp\":1005,") != std::string::npos);
+    std::string tail = "\"valid\":true}],\"summary\":{\"total_points\":3}}";
+    TEST_ASSERT_EQUAL_INT(0, (int)json.compare(json.size() - tail.size(), tail.size(), tail));
+}
+
+// Test: An empty history is still a valid document, chunking does not change the bytes
+void test_json_empty_and_chunked() {
+    HistoryJsonStream empty(store, "{}");
+    TEST_ASSERT_TRUE(readAll(empty, 3) == "{\"device\":{},\"data\":[],\"summary\":{\"total_points\":0}}");
+
+    for (int i = 0; i < 50; i++) {
+        store.add(makePoint(1000 + i * 5, 20.0 + i * 0.1));
+    }
+    HistoryJsonStream whole(store, "{}");
+    HistoryJsonStream chunked(store, "{}");
+    TEST_ASSERT_TRUE(readAll(whole, 512) == readAll(chunked, 5));
+}
+
+// Test: Values that JSON cannot represent become null
+void test_json_non_finite_values() {
+    DataPoint dp = makePoint(1000, 25.0);
+    dp.ph = NAN;  // Missing reading, also makes the pH-derived metrics NaN
+    store.add(dp);
+
+    HistoryJsonStream stream(store, "{}");
+    std::string json = readAll(stream, 512);
+    TEST_ASSERT_TRUE(json.find("\"ph\":null,") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("\"co2_ppm\":null,") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("nan") == std::string::npos);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_csv_layout);
+    RUN_TEST(test_csv_small_chunks);
+    RUN_TEST(test_csv_long_header);
+    RUN_TEST(test_csv_skips_invalid);
+    RUN_TEST(test_csv_concurrent_appends);
+    RUN_TEST(test_json_layout);
+    RUN_TEST(test_json_empty_and_chunked);
+    RUN_TEST(test_json_non_finite_values);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,292 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <unity.h>
+#include "HistoryLog.h"
+#include "TieredHistory.h"
+
+// First synced minute used by the tests
+static const uint32_t T0 = HISTORY_TIME_VALID_MIN + 86400;
+
+HistoryRow makeRow(uint32_t timestamp, int16_t value, uint16_t samples = 12) {
+    HistoryRow row;
+    row.timestamp = timestamp;
+    row.samples = samples;
+    row.flags = HISTORY_FLAG_VALID | (2 << 3);  // pH warning
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        row.mean[ch] = value;
+        row.min[ch] = value - 5;
+        row.max[ch] = value + 5;
+    }
+    return row;
+}
+
+DataPoint makePoint(time_t timestamp, float temp_c) {
+    DataPoint dp;
+    memset(&dp, 0, sizeof(dp));
+    dp.timestamp = timestamp;
+    dp.temp_c = temp_c;
+    dp.orp_mv = 250.0;
+    dp.ph = 7.2;
+    dp.ec_ms_cm = 0.4;
+    dp.valid = true;
+    return dp;
+}
+
+struct Collected {
+    uint32_t count;
+    uint32_t firstTimestamp;
+    uint32_t lastTimestamp;
+    int16_t lastValue;
+};
+
+void collect(const HistoryRow& row, void* context) {
+    Collected* collected = static_cast<Collected*>(context);
+    if (collected->count == 0) {
+        collected->firstTimestamp = row.timestamp;
+    }
+    collected->count++;
+    collected->lastTimestamp = row.timestamp;
+    collected->lastValue = row.mean[HISTORY_CH_TEMP];
+}
+
+size_t segmentSize(uint32_t sequence) {
+    char path[32];
+    snprintf(path, sizeof(path), HISTORY_LOG_DIR "/%08lx.log", (unsigned long)sequence);
+    File file = LittleFS.open(path, FILE_READ);
+    size_t size = file ? file.size() : 0;
+    file.close();
+    return size;
+}
+
+void setUp() {
+    LittleFS.begin(true);
+    LittleFS.format();
+}
+
+void tearDown() {
+}
+
+// Test: Records round-trip through the 32-byte encoding and reject corruption
+void test_record_roundtrip() {
+    HistoryRow row = makeRow(T0 + 120, 2450, 12);
+    row.mean[HISTORY_CH_ORP] = HISTORY_VALUE_NONE;
+
+    HistoryLogRecord record;
+    HistoryLog::encodeRecord(row, record);
+
+    HistoryRow out;
+    TEST_ASSERT_TRUE(HistoryLog::decodeRecord(record, out));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 120, out.timestamp);
+    TEST_ASSERT_EQUAL_UINT16(12, out.samples);
+    TEST_ASSERT_EQUAL_UINT16(row.flags, out.flags);
+    TEST_ASSERT_EQUAL_INT(2450, out.mean[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_INT(2445, out.min[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_INT(2455, out.max[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_INT(HISTORY_VALUE_NONE, out.mean[HISTORY_CH_ORP]);
+
+    record.mean[HISTORY_CH_PH] ^= 0x10;
+    TEST_ASSERT_FALSE(HistoryLog::decodeRecord(record, out));
+
+    // Erased flash never decodes
+    memset(&record, 0xFF, sizeof(record));
+    TEST_ASSERT_FALSE(HistoryLog::decodeRecord(record, out));
+}
+
+// Test: Appends are buffered and written a page at a time
+void test_append_writes_pages() {
+    HistoryLog log;
+    TEST_ASSERT_TRUE(log.begin(LittleFS));
+
+    for (uint32_t i = 0; i < HISTORY_LOG_PAGE_RECORDS - 1; i++) {
+        TEST_ASSERT_TRUE(log.append(makeRow(T0 + i * 60, 2400 + i)));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, segmentSize(0));
+
+    log.append(makeRow(T0 + (HISTORY_LOG_PAGE_RECORDS - 1) * 60, 2500));
+    TEST_ASSERT_EQUAL_UINT32(HISTORY_LOG_PAGE_SIZE, segmentSize(0));
+
+    // flush() writes a partial page
+    log.append(makeRow(T0 + HISTORY_LOG_PAGE_RECORDS * 60, 2500));
+    TEST_ASSERT_TRUE(log.flush());
+    TEST_ASSERT_EQUAL_UINT32(HISTORY_LOG_PAGE_SIZE + sizeof(HistoryLogRecord), segmentSize(0));
+}
+
+// Test: Unsynced, empty and already logged buckets are not appended
+void test_append_filters_rows() {
+    HistoryLog log;
+    log.begin(LittleFS);
+
+    TEST_ASSERT_FALSE(log.append(makeRow(3600, 2400)));         // Boot-relative time
+    TEST_ASSERT_FALSE(log.append(makeRow(T0, 2400, 0)));        // Gap
+    TEST_ASSERT_TRUE(log.append(makeRow(T0 + 60, 2400)));
+    TEST_ASSERT_FALSE(log.append(makeRow(T0 + 60, 2400)));      // Duplicate
+    TEST_ASSERT_FALSE(log.append(makeRow(T0, 2400)));           // Older
+}
+
+// Test: A new log instance replays everything written before the "reboot"
+void test_replay_after_reboot() {
+    {
+        HistoryLog log;
+        log.begin(LittleFS);
+        for (uint32_t i = 0; i < 100; i++) {
+            log.append(makeRow(T0 + i * 60, 2000 + i));
+        }
+        log.flush();
+    }
+
+    HistoryLog log;
+    TEST_ASSERT_TRUE(log.begin(LittleFS));
+    Collected collected = {0, 0, 0, 0};
+    TEST_ASSERT_EQUAL_UINT32(100, log.replay(collect, &collected));
+    TEST_ASSERT_EQUAL_UINT32(T0, collected.firstTimestamp);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 99 * 60, collected.lastTimestamp);
+    TEST_ASSERT_EQUAL_INT(2099, collected.lastValue);
+
+    // Buckets replayed are not logged twice
+    TEST_ASSERT_FALSE(log.append(makeRow(T0 + 99 * 60, 2099)));
+    TEST_ASSERT_TRUE(log.append(makeRow(T0 + 100 * 60, 2100)));
+}
+
+// Test: Corrupt and torn records are skipped, appends continue in a new segment
+void test_replay_skips_torn_writes() {
+    {
+        HistoryLog log;
+        log.begin(LittleFS);
+        for (uint32_t i = 0; i < HISTORY_LOG_PAGE_RECORDS; i++) {
+            log.append(makeRow(T0 + i * 60, 2000 + i));
+        }
+    }
+
+    // Flip a byte in the third record and leave half a record at the end
+    File file = LittleFS.open(HISTORY_LOG_DIR "/00000000.log", "r+");
+    TEST_ASSERT_TRUE(file);
+    file.seek(2 * sizeof(HistoryLogRecord) + 8);
+    file.write(0xA5);
+    file.close();
+    file = LittleFS.open(HISTORY_LOG_DIR "/00000000.log", FILE_APPEND);
+    uint8_t partial[sizeof(HistoryLogRecord) / 2];
+    memset(partial, 0x42, sizeof(partial));
+    file.write(partial, sizeof(partial));
+    file.close();
+
+    {
+        HistoryLog log;
+        log.begin(LittleFS);
+        Collected collected = {0, 0, 0, 0};
+        TEST_ASSERT_EQUAL_UINT32(HISTORY_LOG_PAGE_RECORDS - 1, log.replay(collect, &collected));
+        TEST_ASSERT_EQUAL_UINT32(1, log.getCorruptCount());
+
+        log.append(makeRow(T0 + 3600, 2222));
+        log.flush();
+        TEST_ASSERT_EQUAL_UINT32(2, log.getSegmentCount());
+    }
+
+    HistoryLog log;
+    log.begin(LittleFS);
+    Collected collected = {0, 0, 0, 0};
+    TEST_ASSERT_EQUAL_UINT32(HISTORY_LOG_PAGE_RECORDS, log.replay(collect, &collected));
+    TEST_ASSERT_EQUAL_INT(2222, collected.lastValue);
+}
+
+// Test: Segments rotate and the oldest is deleted beyond the limit
+void test_segment_rotation() {
+    const uint32_t total = HISTORY_LOG_SEGMENT_RECORDS * (HISTORY_LOG_MAX_SEGMENTS + 2);
+    {
+        HistoryLog log;
+        log.begin(LittleFS);
+        for (uint32_t i = 0; i < total; i++) {
+            log.append(makeRow(T0 + i * 60, (int16_t)(i % 10000)));
+        }
+        log.flush();
+        TEST_ASSERT_EQUAL_UINT32(HISTORY_LOG_MAX_SEGMENTS, log.getSegmentCount());
+    }
+
+    TEST_ASSERT_FALSE(LittleFS.exists(HISTORY_LOG_DIR "/00000000.log"));
+    TEST_ASSERT_FALSE(LittleFS.exists(HISTORY_LOG_DIR "/00000001.log"));
+
+    HistoryLog log;
+    log.begin(LittleFS);
+    Collected collected = {0, 0, 0, 0};
+    uint32_t kept = HISTORY_LOG_SEGMENT_RECORDS * HISTORY_LOG_MAX_SEGMENTS;
+    TEST_ASSERT_EQUAL_UINT32(kept, log.replay(collect, &collected));
+    TEST_ASSERT_EQUAL_UINT32(T0 + (total - kept) * 60, collected.firstTimestamp);
+    TEST_ASSERT_EQUAL_UINT32(T0 + (total - 1) * 60, collected.lastTimestamp);
+}
+
+// Test: Rollup tiers are rebuilt from the log after a reboot
+void test_tiered_history_restores_rollups() {
+    static TieredHistory before;
+    static TieredHistory after;
+    before.clear();
+    after.clear();
+
+    HistoryLog log;
+    log.begin(LittleFS);
+    before.attachLog(log);
+    for (uint32_t t = T0; t < T0 + 3 * 3600; t += HISTORY_INTERVAL_MS / 1000) {
+        before.add(makePoint(t, 25.0));
+    }
+    before.flushLog();
+
+    HistoryLog reopened;
+    reopened.begin(LittleFS);
+    TEST_ASSERT_EQUAL_UINT32(3 * 60 - 1, after.attachLog(reopened));  // Open minute not logged
+    TEST_ASSERT_EQUAL_INT(0, after.getRaw().getCount());
+    TEST_ASSERT_EQUAL_INT(3 * 60 - 1, after.getRowCount(1));
+    TEST_ASSERT_EQUAL_INT(12, after.getRowCount(2));
+    TEST_ASSERT_EQUAL_INT(3, after.getRowCount(3));
+
+    HistoryRow row;
+    after.getRow(1, 0, row);
+    TEST_ASSERT_EQUAL_UINT32(T0, row.timestamp);
+    TEST_ASSERT_EQUAL_UINT16(12, row.samples);
+    TEST_ASSERT_EQUAL_INT(2500, row.mean[HISTORY_CH_TEMP]);
+
+    // Raw tier is empty after the reboot, so short ranges use the minute tier
+    TEST_ASSERT_EQUAL_INT(1, after.selectTier(3600));
+}
+
+// Test: Points logged before NTP sync are dropped from the raw tier once synced (bug #12)
+void test_unsynced_points_dropped_on_sync() {
+    static TieredHistory history;
+    history.clear();
+
+    for (uint32_t t = 5; t <= 60; t += 5) {
+        history.add(makePoint(t, 25.0));
+    }
+    TEST_ASSERT_EQUAL_INT(12, history.getRaw().getCount());
+
+    history.add(makePoint(T0, 25.0));
+    TEST_ASSERT_EQUAL_INT(1, history.getRaw().getCount());
+    TEST_ASSERT_EQUAL_UINT32(T0, history.getRaw().timeAt(0));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_record_roundtrip);
+    RUN_TEST(test_append_writes_pages);
+    RUN_TEST(test_append_filters_rows);
+    RUN_TEST(test_replay_after_reboot);
+    RUN_TEST(test_replay_skips_torn_writes);
+    RUN_TEST(test_segment_rotation);
+    RUN_TEST(test_tiered_history_restores_rollups);
+    RUN_TEST(test_unsynced_points_dropped_on_sync);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,153 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "HistoryLttb.h"
+
+// First synced time used by the tests (midnight, so every tier is aligned)
+static const uint32_t T0 = HISTORY_TIME_VALID_MIN + 86400;
+
+static TieredHistory history;
+static HistoryLttb lttb(history);
+static HistoryDerivedContext derived = { 0.64, 4.0, 1.0, 1.5 };
+
+DataPoint makePoint(int index, float temp_c) {
+    DataPoint dp;
+    memset(&dp, 0, sizeof(dp));
+    dp.timestamp = T0 + index * (HISTORY_INTERVAL_MS / 1000);
+    dp.temp_c = temp_c;
+    dp.orp_mv = 250.0;
+    dp.ph = 7.2;
+    dp.ec_ms_cm = 0.4;
+    dp.valid = true;
+    return dp;
+}
+
+// Gentle temperature wave so every bucket has a distinct best candidate
+float wave(int index) {
+    return 25.0 + 0.5 * sinf(index * 0.05);
+}
+
+struct Picked {
+    int count;
+    int perField[HISTORY_FIELD_COUNT];
+    uint16_t fieldsAt[HISTORY_SIZE];  // Picked fields per point index
+};
+
+static Picked picked;
+
+void collect(const HistoryRow& row, uint16_t fields, void* context) {
+    Picked* result = static_cast<Picked*>(context);
+    int index = (row.timestamp - T0) / (HISTORY_INTERVAL_MS / 1000);
+    if (index >= 0 && index < HISTORY_SIZE) {
+        result->fieldsAt[index] = fields;
+    }
+    for (int field = 0; field < HISTORY_FIELD_COUNT; field++) {
+        if (fields & (1 << field)) {
+            result->perField[field]++;
+        }
+    }
+    result->count++;
+}
+
+// Pick over every raw row currently stored
+uint32_t selectAll(uint16_t fields, uint16_t maxPoints) {
+    uint32_t first, end;
+    history.getSequenceRange(0, first, end);
+    return lttb.select(0, first, end, fields, maxPoints, derived);
+}
+
+void runPicks() {
+    memset(&picked, 0, sizeof(picked));
+    lttb.run(collect, &picked);
+}
+
+void setUp() {
+    history.clear();
+}
+
+void tearDown() {
+}
+
+// Test: A window that already fits is returned whole, minus rows without values
+void test_small_window_kept() {
+    for (int i = 0; i < 10; i++) {
+        DataPoint dp = makePoint(i, wave(i));
+        dp.valid = i != 4;
+        history.add(dp);
+    }
+
+    uint16_t fields = (1 << HISTORY_FIELD_TEMP) | (1 << HISTORY_FIELD_PH);
+    TEST_ASSERT_EQUAL_UINT32(9, selectAll(fields, 50));
+    runPicks();
+    TEST_ASSERT_EQUAL_INT(9, picked.count);
+    TEST_ASSERT_EQUAL_UINT16(0, picked.fieldsAt[4]);
+    TEST_ASSERT_EQUAL_UINT16(fields, picked.fieldsAt[5]);
+}
+
+// Test: Each field gets at most maxPoints rows, including the first, the last and its own extremes
+void test_peaks_preserved_per_field() {
+    for (int i = 0; i < 700; i++) {
+        DataPoint dp = makePoint(i, i == 333 ? 30.0 : wave(i));
+        dp.ph = i == 501 ? 6.0 : 7.2;
+        history.add(dp);
+    }
+
+    uint16_t fields = (1 << HISTORY_FIELD_TEMP) | (1 << HISTORY_FIELD_PH);
+    uint32_t rows = selectAll(fields, 40);
+    runPicks();
+
+    TEST_ASSERT_EQUAL_UINT32(rows, picked.count);
+    TEST_ASSERT_TRUE(picked.count <= 2 * 40);
+    TEST_ASSERT_EQUAL_INT(40, picked.perField[HISTORY_FIELD_TEMP]);
+    TEST_ASSERT_EQUAL_INT(40, picked.perField[HISTORY_FIELD_PH]);
+    TEST_ASSERT_EQUAL_INT(0, picked.perField[HISTORY_FIELD_ORP]);
+
+    TEST_ASSERT_EQUAL_UINT16(fields, picked.fieldsAt[0]);
+    TEST_ASSERT_EQUAL_UINT16(fields, picked.fieldsAt[699]);
+    TEST_ASSERT_TRUE(picked.fieldsAt[333] & (1 << HISTORY_FIELD_TEMP));
+    TEST_ASSERT_TRUE(picked.fieldsAt[501] & (1 << HISTORY_FIELD_PH));
+}
+
+// Test: Derived fields follow their source and rows without values are never picked
+void test_derived_and_gaps() {
+    for (int i = 0; i < 300; i++) {
+        DataPoint dp = makePoint(i, wave(i));
+        dp.ec_ms_cm = i == 150 ? 1.2 : 0.4;
+        dp.valid = (i % 10) != 7;
+        history.add(dp);
+    }
+
+    uint16_t fields = (1 << HISTORY_FIELD_EC) | (1 << HISTORY_FIELD_TDS);
+    selectAll(fields, 30);
+    runPicks();
+
+    TEST_ASSERT_EQUAL_UINT16(fields, picked.fieldsAt[150]);  // TDS is EC scaled, same picks
+    TEST_ASSERT_EQUAL_INT(picked.perField[HISTORY_FIELD_EC], picked.perField[HISTORY_FIELD_TDS]);
+    for (int i = 7; i < 300; i += 10) {
+        TEST_ASSERT_EQUAL_UINT16(0, picked.fieldsAt[i]);
+    }
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_small_window_kept);
+    RUN_TEST(test_peaks_preserved_per_field);
+    RUN_TEST(test_derived_and_gaps);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,229 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "HistoryQuery.h"
+
+// First synced time used by the tests (midnight, so every tier is aligned)
+static const uint32_t T0 = HISTORY_TIME_VALID_MIN + 86400;
+
+static TieredHistory history;
+
+DataPoint makePoint(time_t timestamp, float temp_c) {
+    DataPoint dp;
+    memset(&dp, 0, sizeof(dp));
+    dp.timestamp = timestamp;
+    dp.temp_c = temp_c;
+    dp.orp_mv = 250.0;
+    dp.ph = 7.2;
+    dp.ec_ms_cm = 0.4;
+    dp.valid = true;
+    return dp;
+}
+
+// Fill history with 5 s points; temperature encodes the point index (0.01 °C per point)
+void fill(uint32_t seconds) {
+    for (uint32_t t = 0; t < seconds; t += HISTORY_INTERVAL_MS / 1000) {
+        history.add(makePoint(T0 + t, 20.0 + (t / 5) * 0.01));
+    }
+}
+
+struct Collected {
+    uint32_t count;
+    HistoryRow first;
+    HistoryRow last;
+};
+
+void collect(const HistoryRow& row, void* context) {
+    Collected* collected = static_cast<Collected*>(context);
+    if (collected->count == 0) {
+        collected->first = row;
+    }
+    collected->last = row;
+    collected->count++;
+}
+
+void setUp() {
+    history.clear();
+}
+
+void tearDown() {
+}
+
+// Test: Field lists parse to masks, unknown names are rejected
+void test_parse_fields() {
+    TEST_ASSERT_EQUAL_UINT16((1 << HISTORY_FIELD_TEMP) | (1 << HISTORY_FIELD_PH),
+                             HistoryQuery::parseFields("temp,ph"));
+    TEST_ASSERT_EQUAL_UINT16(1 << HISTORY_FIELD_NH3_PPM, HistoryQuery::parseFields("nh3_ppm"));
+    TEST_ASSERT_EQUAL_UINT16(0, HistoryQuery::parseFields("temp,bogus"));
+    TEST_ASSERT_EQUAL_UINT16(0, HistoryQuery::parseFields("temp,"));
+    TEST_ASSERT_EQUAL_UINT16(0, HistoryQuery::parseFields(""));
+    TEST_ASSERT_EQUAL_STRING("max_do", HistoryQuery::getFieldName(HISTORY_FIELD_MAX_DO));
+}
+
+// Test: Window bounds are found by binary search on the tier timestamps
+void test_bounds() {
+    fill(600);  // 120 points
+    TEST_ASSERT_EQUAL_INT(0, HistoryQuery::lowerBound(history, 0, 0));
+    TEST_ASSERT_EQUAL_INT(10, HistoryQuery::lowerBound(history, 0, T0 + 50));
+    TEST_ASSERT_EQUAL_INT(11, HistoryQuery::lowerBound(history, 0, T0 + 51));
+    TEST_ASSERT_EQUAL_INT(11, HistoryQuery::upperBound(history, 0, T0 + 50));
+    TEST_ASSERT_EQUAL_INT(120, HistoryQuery::upperBound(history, 0, T0 + 10000));
+}
+
+// Test: A raw window without step returns the stored points unchanged
+void test_raw_window() {
+    fill(600);
+    HistoryQuery query(history);
+    query.setWindow(T0 + 100, T0 + 149);
+    TEST_ASSERT_TRUE(query.prepare());
+    TEST_ASSERT_EQUAL_INT(0, query.getTier());
+    TEST_ASSERT_EQUAL_UINT32(5, query.getStep());
+    TEST_ASSERT_FALSE(query.isAggregated());
+    TEST_ASSERT_EQUAL_INT(10, query.getRowCount());
+
+    Collected collected = {};
+    TEST_ASSERT_EQUAL_UINT32(10, query.run(collect, &collected));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 100, collected.first.timestamp);
+    TEST_ASSERT_EQUAL_INT(2020, collected.first.mean[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 145, collected.last.timestamp);
+}
+
+// Test: Step buckets are aligned and carry min/max/mean
+void test_step_aggregation() {
+    fill(600);
+    HistoryQuery query(history);
+    query.setWindow(T0 + 25, T0 + 599);
+    query.setStep(30);
+    query.prepare();
+    TEST_ASSERT_EQUAL_INT(0, query.getTier());
+    TEST_ASSERT_TRUE(query.isAggregated());
+
+    Collected collected = {};
+    TEST_ASSERT_EQUAL_UINT32(20, query.run(collect, &collected));
+    // First bucket is partial: only point 5 (T0 + 25) of bucket T0..T0 + 29
+    TEST_ASSERT_EQUAL_UINT32(T0, collected.first.timestamp);
+    TEST_ASSERT_EQUAL_UINT16(1, collected.first.samples);
+    TEST_ASSERT_EQUAL_INT(2005, collected.first.min[HISTORY_CH_TEMP]);
+    // Last bucket: points 114-119
+    TEST_ASSERT_EQUAL_UINT32(T0 + 570, collected.last.timestamp);
+    TEST_ASSERT_EQUAL_UINT16(6, collected.last.samples);
+    TEST_ASSERT_EQUAL_INT(2114, collected.last.min[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_INT(2119, collected.last.max[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_INT(2117, collected.last.mean[HISTORY_CH_TEMP]);  // 2116.5 rounded
+}
+
+// Test: A step that is a multiple of a rollup period is served from that tier
+void test_step_uses_rollup() {
+    fill(600);
+    HistoryQuery query(history);
+    query.setWindow(T0, T0 + 599);
+    query.setStep(60);
+    query.prepare();
+    TEST_ASSERT_EQUAL_INT(1, query.getTier());
+    TEST_ASSERT_EQUAL_INT(10, query.getRowCount());
+
+    Collected collected = {};
+    TEST_ASSERT_EQUAL_UINT32(10, query.run(collect, &collected));
+    TEST_ASSERT_EQUAL_UINT16(12, collected.first.samples);
+    TEST_ASSERT_EQUAL_INT(2000, collected.first.min[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_INT(2011, collected.first.max[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 540, collected.last.timestamp);
+    TEST_ASSERT_EQUAL_INT(2114, collected.last.mean[HISTORY_CH_TEMP]);  // 2113.5 rounded
+}
+
+// Test: The step is widened to respect the point limit
+void test_max_points() {
+    fill(3000);
+    HistoryQuery query(history);
+    query.setWindow(T0, T0 + 2999);
+    query.setMaxPoints(50);
+    query.prepare();
+    TEST_ASSERT_EQUAL_UINT32(0, query.getStep() % 5);
+    Collected collected = {};
+    TEST_ASSERT_TRUE(query.run(collect, &collected) <= 50);
+    TEST_ASSERT_TRUE(collected.count >= 40);
+}
+
+// Test: Coarser tiers serve windows the raw ring no longer holds, and large steps
+void test_tier_selection() {
+    fill(4 * 3600);
+
+    HistoryQuery query(history);
+    query.setWindow(T0 + 3600, T0 + 4 * 3600);
+    query.prepare();
+    TEST_ASSERT_EQUAL_INT(1, query.getTier());  // Raw only holds the last hour
+
+    query.setStep(3600);
+    query.prepare();
+    TEST_ASSERT_EQUAL_INT(3, query.getTier());  // Hourly buckets straight from the hour tier
+    Collected collected = {};
+    TEST_ASSERT_EQUAL_UINT32(3, query.run(collect, &collected));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 3600, collected.first.timestamp);
+    TEST_ASSERT_EQUAL_UINT16(720, collected.first.samples);
+
+    HistoryQuery recent(history);
+    recent.setWindow(T0 + 4 * 3600 - 600, T0 + 4 * 3600);
+    recent.prepare();
+    TEST_ASSERT_EQUAL_INT(0, recent.getTier());
+
+    // Forced tier (range= uses the span-based choice)
+    recent.setTier(2);
+    recent.prepare();
+    TEST_ASSERT_EQUAL_INT(2, recent.getTier());
+    TEST_ASSERT_EQUAL_UINT32(900, recent.getStep());
+}
+
+// Test: Right after boot every tier starts together and raw is preferred
+void test_fresh_boot_prefers_raw() {
+    for (uint32_t t = 1830; t < 1830 + 600; t += 5) {
+        history.add(makePoint(T0 + t, 25.0));
+    }
+    HistoryQuery query(history);
+    query.setWindow(T0, T0 + 3600);
+    query.prepare();
+    TEST_ASSERT_EQUAL_INT(0, query.getTier());
+}
+
+// Test: Empty and inverted windows
+void test_empty_window() {
+    HistoryQuery query(history);
+    query.setWindow(T0, T0 + 60);
+    TEST_ASSERT_TRUE(query.prepare());
+    Collected collected = {};
+    TEST_ASSERT_EQUAL_UINT32(0, query.run(collect, &collected));
+
+    fill(600);
+    query.setWindow(T0 + 100, T0 + 50);
+    TEST_ASSERT_FALSE(query.prepare());
+    TEST_ASSERT_EQUAL_UINT32(0, query.run(collect, &collected));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_parse_fields);
+    RUN_TEST(test_bounds);
+    RUN_TEST(test_raw_window);
+    RUN_TEST(test_step_aggregation);
+    RUN_TEST(test_step_uses_rollup);
+    RUN_TEST(test_max_points);
+    RUN_TEST(test_tier_selection);
+    RUN_TEST(test_fresh_boot_prefers_raw);
+    RUN_TEST(test_empty_window);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,244 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "TieredHistory.h"
+
+static TieredHistory tiered;
+
+HistoryRow makeRow(uint32_t timestamp, int16_t temp, uint16_t flags = HISTORY_FLAG_VALID) {
+    HistoryRow row;
+    row.timestamp = timestamp;
+    row.samples = (flags & HISTORY_FLAG_VALID) ? 1 : 0;
+    row.flags = flags;
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        row.mean[ch] = temp;
+        row.min[ch] = temp;
+        row.max[ch] = temp;
+    }
+    return row;
+}
+
+DataPoint makePoint(time_t timestamp, float temp_c) {
+    DataPoint dp;
+    memset(&dp, 0, sizeof(dp));
+    dp.timestamp = timestamp;
+    dp.temp_c = temp_c;
+    dp.orp_mv = 250.0;
+    dp.ph = 7.2;
+    dp.ec_ms_cm = 0.4;
+    dp.valid = true;
+    return dp;
+}
+
+void setUp() {
+    tiered.clear();
+}
+
+void tearDown() {
+}
+
+// Test: Accumulator means are weighted by sample count, min/max and worst state kept
+void test_accumulator_weighted_merge() {
+    HistoryAccumulator acc;
+    acc.reset(100);
+
+    HistoryRow a = makeRow(100, 2000, HISTORY_FLAG_VALID | (1 << 1));  // temp state normal
+    a.samples = 3;
+    HistoryRow b = makeRow(160, 2400, HISTORY_FLAG_VALID | (3 << 1));  // temp state critical
+    b.samples = 1;
+    b.min[HISTORY_CH_TEMP] = 2300;
+    b.max[HISTORY_CH_TEMP] = 2500;
+    acc.add(a);
+    acc.add(b);
+    acc.add(makeRow(200, 9999, 0));  // Gap row is ignored
+
+    HistoryRow out;
+    acc.get(out);
+    TEST_ASSERT_EQUAL_UINT32(100, out.timestamp);
+    TEST_ASSERT_EQUAL_UINT16(4, out.samples);
+    TEST_ASSERT_EQUAL_INT(2100, out.mean[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_INT(2000, out.min[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_INT(2500, out.max[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_INT(3, (out.flags >> 1) & 0x03);
+}
+
+// Test: Missing channel values do not drag the mean
+void test_accumulator_skips_missing_values() {
+    HistoryAccumulator acc;
+    acc.reset(0);
+    HistoryRow a = makeRow(0, 700);
+    HistoryRow b = makeRow(5, 900);
+    b.mean[HISTORY_CH_PH] = HISTORY_VALUE_NONE;
+    b.min[HISTORY_CH_PH] = HISTORY_VALUE_NONE;
+    b.max[HISTORY_CH_PH] = HISTORY_VALUE_NONE;
+    acc.add(a);
+    acc.add(b);
+
+    HistoryRow out;
+    acc.get(out);
+    TEST_ASSERT_EQUAL_INT(700, out.mean[HISTORY_CH_PH]);
+    TEST_ASSERT_EQUAL_INT(800, out.mean[HISTORY_CH_TEMP]);
+}
+
+// Test: Buckets are period-aligned and close when a later period starts
+void test_rollup_buckets_close_on_period() {
+    RollupTier tier(60, 10);
+    for (uint32_t t = 1200; t < 1200 + 180; t += 5) {
+        tier.add(makeRow(t, (int16_t)(t / 60)));  // Constant within each minute
+    }
+
+    TEST_ASSERT_EQUAL_INT(3, tier.getCount());  // 2 closed + open
+    HistoryRow row;
+    tier.at(0, row);
+    TEST_ASSERT_EQUAL_UINT32(1200, row.timestamp);
+    TEST_ASSERT_EQUAL_UINT16(12, row.samples);
+    TEST_ASSERT_EQUAL_INT(20, row.mean[HISTORY_CH_TEMP]);
+    tier.at(2, row);
+    TEST_ASSERT_EQUAL_UINT32(1320, row.timestamp);
+    TEST_ASSERT_EQUAL_INT(22, row.mean[HISTORY_CH_TEMP]);
+    TEST_ASSERT_EQUAL_UINT32(1260, tier.timeAt(1));
+}
+
+// Test: Skipped periods become empty buckets, a gap beyond the span clears the tier
+void test_rollup_gaps() {
+    RollupTier tier(60, 10);
+    tier.add(makeRow(0, 1));
+    tier.add(makeRow(240, 2));  // Minutes 1-3 missing
+
+    TEST_ASSERT_EQUAL_INT(5, tier.getCount());
+    HistoryRow row;
+    tier.at(2, row);
+    TEST_ASSERT_EQUAL_UINT16(0, row.samples);
+    TEST_ASSERT_EQUAL_UINT32(120, tier.timeAt(2));
+
+    tier.add(makeRow(240 + 60 * 20, 3));  // Longer than 10 buckets
+    TEST_ASSERT_EQUAL_INT(1, tier.getCount());
+    tier.at(0, row);
+    TEST_ASSERT_EQUAL_UINT32(1440, row.timestamp);
+}
+
+// Test: The ring keeps only the newest buckets
+void test_rollup_ring_wraps() {
+    RollupTier tier(60, 10);
+    for (uint32_t minute = 0; minute < 25; minute++) {
+        tier.add(makeRow(minute * 60, (int16_t)minute));
+    }
+
+    TEST_ASSERT_EQUAL_INT(11, tier.getCount());  // 10 closed + open
+    HistoryRow row;
+    tier.at(0, row);
+    TEST_ASSERT_EQUAL_UINT32(14 * 60, row.timestamp);
+    TEST_ASSERT_EQUAL_INT(14, row.mean[HISTORY_CH_TEMP]);
+}
+
+// Test: Sequence numbers stay with their bucket across closes, eviction and clear
+void test_rollup_sequences() {
+    RollupTier tier(60, 10);
+    for (uint32_t minute = 0; minute < 5; minute++) {
+        tier.add(makeRow(minute * 60, (int16_t)minute));
+    }
+
+    uint32_t first, end;
+    tier.getSequenceRange(first, end);
+    TEST_ASSERT_EQUAL_UINT32(0, first);
+    TEST_ASSERT_EQUAL_UINT32(5, end);
+    HistoryRow row;
+    TEST_ASSERT_TRUE(tier.readRow(4, row));  // Open bucket
+    TEST_ASSERT_EQUAL_UINT32(240, row.timestamp);
+    TEST_ASSERT_FALSE(tier.readRow(5, row));
+
+    // Closing the open bucket keeps its sequence number; the ring then evicts the oldest
+    for (uint32_t minute = 5; minute < 15; minute++) {
+        tier.add(makeRow(minute * 60, (int16_t)minute));
+    }
+    TEST_ASSERT_TRUE(tier.readRow(4, row));
+    TEST_ASSERT_EQUAL_UINT32(240, row.timestamp);
+    TEST_ASSERT_EQUAL_INT(4, row.mean[HISTORY_CH_TEMP]);
+    TEST_ASSERT_FALSE(tier.readRow(3, row));
+    tier.getSequenceRange(first, end);
+    TEST_ASSERT_EQUAL_UINT32(4, first);
+    TEST_ASSERT_EQUAL_UINT32(15, end);
+
+    // A cleared tier never hands out an old sequence number again
+    tier.clear();
+    tier.add(makeRow(3600, 1));
+    tier.getSequenceRange(first, end);
+    TEST_ASSERT_EQUAL_UINT32(end - 1, first);
+    TEST_ASSERT_TRUE(first >= 15);
+    TEST_ASSERT_FALSE(tier.readRow(14, row));
+    TEST_ASSERT_TRUE(tier.readRow(first, row));
+    TEST_ASSERT_EQUAL_UINT32(3600, row.timestamp);
+}
+
+// Test: Points fed to the tiered history reach every tier
+void test_tiered_history_feeds_all_tiers() {
+    uint32_t start = 1700000000 - 1700000000 % 3600;
+    for (int i = 0; i < 2 * 720; i++) {  // 2 hours at 5 s
+        tiered.add(makePoint(start + i * 5, 25.0));
+    }
+
+    TEST_ASSERT_EQUAL_INT(HISTORY_SIZE, tiered.getRowCount(0));
+    TEST_ASSERT_EQUAL_INT(120, tiered.getRowCount(1));
+    TEST_ASSERT_EQUAL_INT(8, tiered.getRowCount(2));
+    TEST_ASSERT_EQUAL_INT(2, tiered.getRowCount(3));
+
+    HistoryRow row;
+    tiered.getRow(3, 0, row);
+    TEST_ASSERT_EQUAL_UINT16(720, row.samples);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 25.0, HistoryStore::decodeChannel(HISTORY_CH_TEMP, row.mean[HISTORY_CH_TEMP]));
+}
+
+// Test: Finest covering tier is selected for a range
+void test_tiered_history_select_tier() {
+    TEST_ASSERT_EQUAL_INT(0, tiered.selectTier(600));
+    TEST_ASSERT_EQUAL_INT(0, tiered.selectTier(3600));
+    TEST_ASSERT_EQUAL_INT(1, tiered.selectTier(86400));
+    TEST_ASSERT_EQUAL_INT(2, tiered.selectTier(7 * 86400));
+    TEST_ASSERT_EQUAL_INT(3, tiered.selectTier(30 * 86400));
+    TEST_ASSERT_EQUAL_INT(3, tiered.selectTier(365 * 86400));
+}
+
+// Test: Duration strings
+void test_parse_duration() {
+    TEST_ASSERT_EQUAL_UINT32(90, TieredHistory::parseDuration("90"));
+    TEST_ASSERT_EQUAL_UINT32(90, TieredHistory::parseDuration("90s"));
+    TEST_ASSERT_EQUAL_UINT32(900, TieredHistory::parseDuration("15m"));
+    TEST_ASSERT_EQUAL_UINT32(86400, TieredHistory::parseDuration("24h"));
+    TEST_ASSERT_EQUAL_UINT32(604800, TieredHistory::parseDuration("7d"));
+    TEST_ASSERT_EQUAL_UINT32(0, TieredHistory::parseDuration(""));
+    TEST_ASSERT_EQUAL_UINT32(0, TieredHistory::parseDuration("0h"));
+    TEST_ASSERT_EQUAL_UINT32(0, TieredHistory::parseDuration("-1h"));
+    TEST_ASSERT_EQUAL_UINT32(0, TieredHistory::parseDuration("7w"));
+    TEST_ASSERT_EQUAL_UINT32(0, TieredHistory::parseDuration("7dd"));
+    TEST_ASSERT_EQUAL_UINT32(0, TieredHistory::parseDuration(nullptr));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_accumulator_weighted_merge);
+    RUN_TEST(test_accumulator_skips_missing_values);
+    RUN_TEST(test_rollup_buckets_close_on_period);
+    RUN_TEST(test_rollup_gaps);
+    RUN_TEST(test_rollup_ring_wraps);
+    RUN_TEST(test_rollup_sequences);
+    RUN_TEST(test_tiered_history_feeds_all_tiers);
+    RUN_TEST(test_tiered_history_select_tier);
+    RUN_TEST(test_parse_duration);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
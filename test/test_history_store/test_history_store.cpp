@@ -0,0 +1,277 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "HistoryStore.h"
+
+static HistoryStore store;
+
+DataPoint makePoint(time_t timestamp, float temp_c) {
+    DataPoint dp;
+    memset(&dp, 0, sizeof(dp));
+    dp.timestamp = timestamp;
+    dp.temp_c = temp_c;
+    dp.ph = 7.0;
+    dp.valid = true;
+    return dp;
+}
+
+void setUp() {
+    store.clear();
+}
+
+void tearDown() {
+}
+
+// Test: Empty store reports no points
+void test_history_empty() {
+    TEST_ASSERT_EQUAL_INT(0, store.getCount());
+    TEST_ASSERT_EQUAL_INT(HISTORY_SIZE, store.getCapacity());
+}
+
+// Test: Points are returned oldest first before the ring wraps
+void test_history_chronological_order() {
+    for (int i = 0; i < 10; i++) {
+        store.add(makePoint(1000 + i * 5, 20.0 + i));
+    }
+
+    TEST_ASSERT_EQUAL_INT(10, store.getCount());
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_INT(1000 + i * 5, (int)store.at(i).timestamp);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(29.0, store.latest().temp_c);
+}
+
+// Test: Once full, the oldest block is evicted and order is preserved
+void test_history_wraps_oldest_first() {
+    int total = HISTORY_SIZE + 25;
+    for (int i = 0; i < total; i++) {
+        store.add(makePoint(i, 20.0));
+    }
+
+    // Two blocks were evicted to make room for the 25 extra points
+    TEST_ASSERT_EQUAL_INT(HISTORY_SIZE - 2 * HISTORY_BLOCK_SIZE + 25, store.getCount());
+    TEST_ASSERT_EQUAL_INT(2 * HISTORY_BLOCK_SIZE, (int)store.at(0).timestamp);
+    TEST_ASSERT_EQUAL_INT(total - 1, (int)store.latest().timestamp);
+    for (int i = 1; i < store.getCount(); i++) {
+        TEST_ASSERT_EQUAL_INT((int)store.at(i - 1).timestamp + 1, (int)store.at(i).timestamp);
+    }
+}
+
+// Test: Fixed-point channels round-trip within their resolution
+void test_history_fixed_point_round_trip() {
+    DataPoint dp = makePoint(1700000000, 24.567);
+    dp.orp_mv = -123.45;
+    dp.ph = 7.8234;
+    dp.ec_ms_cm = 1.2345;
+    store.add(dp);
+
+    DataPoint out = store.at(0);
+    TEST_ASSERT_EQUAL_INT(1700000000, (int)out.timestamp);
+    TEST_ASSERT_FLOAT_WITHIN(0.005, 24.567, out.temp_c);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, -123.45, out.orp_mv);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005, 7.8234, out.ph);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1.2345, out.ec_ms_cm);
+}
+
+// Test: Missing or out-of-range values read back as NaN
+void test_history_unrepresentable_values() {
+    DataPoint dp = makePoint(1, 20.0);
+    dp.ph = NAN;
+    dp.orp_mv = 99999.0;
+    dp.ec_ms_cm = 100.0;
+    store.add(dp);
+
+    DataPoint out = store.at(0);
+    TEST_ASSERT_TRUE(isnan(out.ph));
+    TEST_ASSERT_TRUE(isnan(out.orp_mv));
+    TEST_ASSERT_TRUE(isnan(out.ec_ms_cm));
+    TEST_ASSERT_FLOAT_WITHIN(0.005, 20.0, out.temp_c);
+}
+
+// Test: All six 2-bit warning states are packed independently
+void test_history_warning_states() {
+    DataPoint dp = makePoint(1, 20.0);
+    dp.temp_state = 1;
+    dp.ph_state = 2;
+    dp.nh3_state = 3;
+    dp.orp_state = 0;
+    dp.ec_state = 3;
+    dp.do_state = 2;
+    store.add(dp);
+
+    DataPoint out = store.at(0);
+    TEST_ASSERT_TRUE(out.valid);
+    TEST_ASSERT_EQUAL_UINT8(1, out.temp_state);
+    TEST_ASSERT_EQUAL_UINT8(2, out.ph_state);
+    TEST_ASSERT_EQUAL_UINT8(3, out.nh3_state);
+    TEST_ASSERT_EQUAL_UINT8(0, out.orp_state);
+    TEST_ASSERT_EQUAL_UINT8(3, out.ec_state);
+    TEST_ASSERT_EQUAL_UINT8(2, out.do_state);
+}
+
+// Test: Derived metrics are recomputed from the stored channels and context
+void test_history_derived_on_read() {
+    DataPoint dp = makePoint(1, 22.28);
+    dp.ph = 7.52;
+    dp.ec_ms_cm = 0.5;
+    store.add(dp);
+
+    HistoryDerivedContext context;
+    context.tds_factor = 0.5;
+    context.kh_dkh = 4.0;
+    context.tan_ppm = 1.0;
+    context.stocking_density = 0.75;
+    store.setDerivedContext(context);
+
+    DataPoint out = store.at(0);
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 250.0, out.tds_ppm);
+    TEST_ASSERT_FLOAT_WITHIN(0.0004, 0.0152, out.toxic_ammonia_ratio);
+    TEST_ASSERT_FLOAT_WITHIN(0.0004, 0.0152, out.nh3_ppm);
+    TEST_ASSERT_TRUE(out.co2_ppm > 0.0);
+    TEST_ASSERT_TRUE(out.max_do_mg_l > 8.0);
+    TEST_ASSERT_EQUAL_FLOAT(0.75, out.stocking_density);
+}
+
+// Test: A clock step closes the current block with invalid slots
+void test_history_clock_step_pads_block() {
+    store.add(makePoint(100, 20.0));
+    store.add(makePoint(105, 20.0));
+    store.add(makePoint(1700000000, 21.0));  // NTP sync
+
+    TEST_ASSERT_EQUAL_INT(HISTORY_BLOCK_SIZE + 1, store.getCount());
+    TEST_ASSERT_EQUAL_INT(105, (int)store.at(1).timestamp);
+    TEST_ASSERT_FALSE(store.at(2).valid);
+    TEST_ASSERT_EQUAL_INT(1700000000, (int)store.latest().timestamp);
+    TEST_ASSERT_TRUE(store.latest().valid);
+    // Timestamps never go backwards, padding included
+    for (int i = 1; i < store.getCount(); i++) {
+        TEST_ASSERT_TRUE(store.at(i).timestamp >= store.at(i - 1).timestamp);
+    }
+}
+
+// Test: Invalid points are retained so gaps stay visible to readers
+void test_history_keeps_invalid_points() {
+    store.add(makePoint(1, 20.0));
+    DataPoint gap = makePoint(2, 0.0);
+    gap.valid = false;
+    store.add(gap);
+
+    TEST_ASSERT_EQUAL_INT(2, store.getCount());
+    TEST_ASSERT_TRUE(store.at(0).valid);
+    TEST_ASSERT_FALSE(store.at(1).valid);
+}
+
+// Test: clear() empties a wrapped store
+void test_history_clear() {
+    for (int i = 0; i < HISTORY_SIZE + 3; i++) {
+        store.add(makePoint(i, 20.0));
+    }
+    store.clear();
+
+    TEST_ASSERT_EQUAL_INT(0, store.getCount());
+    store.add(makePoint(42, 21.0));
+    TEST_ASSERT_EQUAL_INT(42, (int)store.at(0).timestamp);
+}
+
+// Test: Sequence cursors address appended points across wraps and clear()
+void test_history_sequence_cursor() {
+    uint32_t start = store.getSequence();
+    TEST_ASSERT_EQUAL_INT(0, store.indexOfSequence(start));  // Nothing new yet
+
+    store.add(makePoint(10, 20.0));
+    store.add(makePoint(15, 21.0));
+    TEST_ASSERT_EQUAL_UINT32(start + 2, store.getSequence());
+    TEST_ASSERT_EQUAL_UINT32(start + 1, store.sequenceAt(1));
+    TEST_ASSERT_EQUAL_INT(1, store.indexOfSequence(start + 1));
+    TEST_ASSERT_EQUAL_INT(2, store.indexOfSequence(start + 2));
+    TEST_ASSERT_EQUAL_INT(-1, store.indexOfSequence(start + 3));  // Never issued
+
+    // Evicted points are no longer addressable
+    for (int i = 0; i < HISTORY_SIZE; i++) {
+        store.add(makePoint(20 + i * 5, 20.0));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, store.indexOfSequence(start));
+    int newest = store.getCount() - 1;
+    TEST_ASSERT_EQUAL_INT(newest, store.indexOfSequence(store.sequenceAt(newest)));
+
+    // clear() keeps counting, so old cursors do not match new points
+    uint32_t beforeClear = store.getSequence();
+    store.clear();
+    store.add(makePoint(5000, 20.0));
+    TEST_ASSERT_EQUAL_INT(-1, store.indexOfSequence(beforeClear - 1));
+    TEST_ASSERT_EQUAL_INT(0, store.indexOfSequence(beforeClear));
+}
+
+// Test: A reader on another task gets whole rows at the right sequence while points are added
+void test_history_concurrent_reader() {
+    uint32_t base = store.getSequence();
+    std::atomic<bool> done(false);
+    std::thread writer([&done]() {
+        for (int i = 0; i < 20 * HISTORY_SIZE; i++) {
+            DataPoint dp = makePoint(1000 + i * 5, (i % 1000) * 0.01);
+            dp.ph = (i % 1000) * 0.001;
+            store.add(dp);
+        }
+        done = true;
+    });
+
+    int reads = 0;
+    int mismatched = 0;
+    HistoryRow row;
+    bool finished;
+    do {
+        finished = done;
+        uint32_t first, end;
+        store.getSequenceRange(first, end);
+        for (uint32_t sequence = first; sequence != end; sequence++) {
+            if (!store.readRow(sequence, row)) {
+                continue;  // Evicted meanwhile
+            }
+            int i = (int)(sequence - base);
+            if (row.timestamp != (uint32_t)(1000 + i * 5) ||
+                row.mean[HISTORY_CH_TEMP] != i % 1000 || row.mean[HISTORY_CH_PH] != i % 1000) {
+                mismatched++;
+            }
+            reads++;
+        }
+    } while (!finished);
+    writer.join();
+
+    TEST_ASSERT_EQUAL_INT(0, mismatched);
+    TEST_ASSERT_TRUE(reads >= HISTORY_SIZE - HISTORY_BLOCK_SIZE);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_history_empty);
+    RUN_TEST(test_history_chronological_order);
+    RUN_TEST(test_history_wraps_oldest_first);
+    RUN_TEST(test_history_fixed_point_round_trip);
+    RUN_TEST(test_history_unrepresentable_values);
+    RUN_TEST(test_history_warning_states);
+    RUN_TEST(test_history_derived_on_read);
+    RUN_TEST(test_history_clock_step_pads_block);
+    RUN_TEST(test_history_keeps_invalid_points);
+    RUN_TEST(test_history_clear);
+    RUN_TEST(test_history_sequence_cursor);
+    RUN_TEST(test_history_concurrent_reader);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,253 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <unity.h>
+#include "MQTTOutbox.h"
+
+// First synced time used by the tests
+static const uint32_t T0 = 1704067200UL + 86400;
+
+MQTTOutboxRecord makeRecord(uint32_t index) {
+    MQTTOutboxRecord record;
+    memset(&record, 0, sizeof(record));
+    record.timestamp = T0 + index * 5;
+    for (int i = 0; i < MQTT_OUTBOX_VALUES; i++) {
+        record.values[i] = index + i * 0.5f;
+    }
+    record.states[0] = index % 4;
+    return record;
+}
+
+// Drain everything in batches of batchSize and check the samples come out in order
+void drainInOrder(MQTTOutbox& outbox, uint32_t firstIndex, uint32_t count, size_t batchSize) {
+    MQTTOutboxRecord batch[16];
+    uint32_t expected = firstIndex;
+    while (!outbox.isEmpty()) {
+        size_t got = outbox.peek(batch, batchSize);
+        TEST_ASSERT_GREATER_THAN(0, got);
+        for (size_t i = 0; i < got; i++) {
+            TEST_ASSERT_EQUAL_UINT32(T0 + expected * 5, batch[i].timestamp);
+            TEST_ASSERT_EQUAL_FLOAT(expected + 0.5f, batch[i].values[1]);
+            expected++;
+        }
+        outbox.pop(got);
+    }
+    TEST_ASSERT_EQUAL_UINT32(firstIndex + count, expected);
+}
+
+void setUp() {
+    LittleFS.begin(true);
+    LittleFS.format();
+    shimSetFsWriteBudget(-1);
+}
+
+void tearDown() {
+}
+
+void test_ram_ring_order() {
+    MQTTOutbox outbox;
+    for (uint32_t i = 0; i < 10; i++) {
+        outbox.push(makeRecord(i));
+    }
+    TEST_ASSERT_EQUAL_UINT32(10, outbox.getCount());
+
+    // Peek does not consume
+    MQTTOutboxRecord batch[4];
+    TEST_ASSERT_EQUAL(4, outbox.peek(batch, 4));
+    TEST_ASSERT_EQUAL(4, outbox.peek(batch, 4));
+    TEST_ASSERT_EQUAL_UINT32(T0, batch[0].timestamp);
+
+    drainInOrder(outbox, 0, 10, 4);
+    TEST_ASSERT_EQUAL_UINT32(0, outbox.getDropped());
+}
+
+void test_ram_only_drops_oldest() {
+    MQTTOutbox outbox;
+    uint32_t pushed = MQTT_OUTBOX_RAM_RECORDS + 10;
+    for (uint32_t i = 0; i < pushed; i++) {
+        outbox.push(makeRecord(i));
+    }
+    TEST_ASSERT_EQUAL_UINT32(MQTT_OUTBOX_RAM_RECORDS, outbox.getCount());
+    TEST_ASSERT_EQUAL_UINT32(10, outbox.getDropped());
+    drainInOrder(outbox, 10, MQTT_OUTBOX_RAM_RECORDS, 7);
+}
+
+void test_spill_keeps_order() {
+    MQTTOutbox outbox;
+    outbox.begin(LittleFS);
+
+    // Two full rings spilled, then a partial ring in RAM; pop some first so the ring wraps
+    for (uint32_t i = 0; i < 5; i++) {
+        outbox.push(makeRecord(i));
+    }
+    MQTTOutboxRecord batch[16];
+    outbox.pop(outbox.peek(batch, 3));
+    uint32_t pushed = 5 + 2 * MQTT_OUTBOX_RAM_RECORDS + 7;
+    for (uint32_t i = 5; i < pushed; i++) {
+        outbox.push(makeRecord(i));
+    }
+    TEST_ASSERT_TRUE(LittleFS.exists(MQTT_OUTBOX_SPILL_PATH));
+    TEST_ASSERT_EQUAL_UINT32(pushed - 3, outbox.getCount());
+    TEST_ASSERT_EQUAL_UINT32(0, outbox.getDropped());
+
+    drainInOrder(outbox, 3, pushed - 3, 16);
+    TEST_ASSERT_FALSE(LittleFS.exists(MQTT_OUTBOX_SPILL_PATH));
+}
+
+void test_spill_survives_reboot() {
+    uint32_t spilled = 2 * MQTT_OUTBOX_RAM_RECORDS;
+    {
+        MQTTOutbox outbox;
+        outbox.begin(LittleFS);
+        for (uint32_t i = 0; i < spilled + 5; i++) {
+            outbox.push(makeRecord(i));
+        }
+        // Part of the spill sent before the reboot; the RAM ring is lost
+        MQTTOutboxRecord batch[16];
+        outbox.pop(outbox.peek(batch, 10));
+    }
+
+    // The whole spill is sent again after the reboot (duplicates, never gaps)
+    MQTTOutbox outbox;
+    TEST_ASSERT_EQUAL_UINT32(spilled, outbox.begin(LittleFS));
+    outbox.push(makeRecord(spilled));
+    drainInOrder(outbox, 0, spilled + 1, 16);
+}
+
+void test_spill_ignores_torn_record() {
+    {
+        MQTTOutbox outbox;
+        outbox.begin(LittleFS);
+        for (uint32_t i = 0; i < MQTT_OUTBOX_RAM_RECORDS + 1; i++) {
+            outbox.push(makeRecord(i));
+        }
+    }
+    File file = LittleFS.open(MQTT_OUTBOX_SPILL_PATH, FILE_APPEND);
+    uint8_t partial[20] = {};
+    file.write(partial, sizeof(partial));
+    file.close();
+
+    MQTTOutbox outbox;
+    TEST_ASSERT_EQUAL_UINT32(MQTT_OUTBOX_RAM_RECORDS, outbox.begin(LittleFS));
+    drainInOrder(outbox, 0, MQTT_OUTBOX_RAM_RECORDS, 16);
+    TEST_ASSERT_FALSE(LittleFS.exists(MQTT_OUTBOX_SPILL_PATH));
+}
+
+void test_full_spill_drops_from_ram() {
+    MQTTOutbox outbox;
+    outbox.begin(LittleFS);
+    uint32_t capacity = MQTT_OUTBOX_SPILL_MAX_RECORDS + MQTT_OUTBOX_RAM_RECORDS;
+    for (uint32_t i = 0; i < capacity + 3; i++) {
+        outbox.push(makeRecord(i));
+    }
+    TEST_ASSERT_EQUAL_UINT32(capacity, outbox.getCount());
+    TEST_ASSERT_EQUAL_UINT32(3, outbox.getDropped());
+
+    // The spill is intact; the ring lost its three oldest samples
+    MQTTOutboxRecord batch[16];
+    while (outbox.getCount() > MQTT_OUTBOX_RAM_RECORDS) {
+        outbox.pop(outbox.peek(batch, 16));
+    }
+    drainInOrder(outbox, MQTT_OUTBOX_SPILL_MAX_RECORDS + 3, MQTT_OUTBOX_RAM_RECORDS, 16);
+}
+
+void test_short_spill_write_pauses_spilling() {
+    MQTTOutbox outbox;
+    outbox.begin(LittleFS);
+    uint32_t pushed = 2 * MQTT_OUTBOX_RAM_RECORDS;
+    for (uint32_t i = 0; i < pushed; i++) {
+        outbox.push(makeRecord(i));
+    }
+
+    // Flash fills up in the middle of the second spill: ten records and a torn one make it
+    shimSetFsWriteBudget(10 * sizeof(MQTTOutboxRecord) + 20);
+    outbox.push(makeRecord(pushed++));
+    shimSetFsWriteBudget(-1);
+    outbox.push(makeRecord(pushed++));  // No further append to the torn file
+    TEST_ASSERT_EQUAL_UINT32(2 * MQTT_OUTBOX_RAM_RECORDS, outbox.getCount());
+    TEST_ASSERT_EQUAL_UINT32(2, outbox.getDropped());
+
+    // The spill is read up to the torn write only, then the ring follows
+    MQTTOutboxRecord batch[16];
+    uint32_t expected = 0;
+    while (outbox.getCount() > MQTT_OUTBOX_RAM_RECORDS) {
+        size_t got = outbox.peek(batch, 16);
+        for (size_t i = 0; i < got; i++) {
+            TEST_ASSERT_EQUAL_UINT32(T0 + expected++ * 5, batch[i].timestamp);
+        }
+        outbox.pop(got);
+    }
+    TEST_ASSERT_EQUAL_UINT32(MQTT_OUTBOX_RAM_RECORDS, expected);
+    TEST_ASSERT_FALSE(LittleFS.exists(MQTT_OUTBOX_SPILL_PATH));
+    drainInOrder(outbox, MQTT_OUTBOX_RAM_RECORDS + 2, MQTT_OUTBOX_RAM_RECORDS, 16);
+
+    // Spilling resumes once the torn file is gone
+    for (uint32_t i = 0; i < MQTT_OUTBOX_RAM_RECORDS + 1; i++) {
+        outbox.push(makeRecord(i));
+    }
+    TEST_ASSERT_TRUE(LittleFS.exists(MQTT_OUTBOX_SPILL_PATH));
+    TEST_ASSERT_EQUAL_UINT32(2, outbox.getDropped());
+    drainInOrder(outbox, 0, MQTT_OUTBOX_RAM_RECORDS + 1, 16);
+}
+
+void test_short_first_spill_abandons_file() {
+    MQTTOutbox outbox;
+    outbox.begin(LittleFS);
+    for (uint32_t i = 0; i < MQTT_OUTBOX_RAM_RECORDS; i++) {
+        outbox.push(makeRecord(i));
+    }
+
+    // Not even one whole record fits: the file is removed and the ring keeps its samples
+    shimSetFsWriteBudget(20);
+    outbox.push(makeRecord(MQTT_OUTBOX_RAM_RECORDS));
+    shimSetFsWriteBudget(-1);
+    TEST_ASSERT_FALSE(LittleFS.exists(MQTT_OUTBOX_SPILL_PATH));
+    TEST_ASSERT_EQUAL_UINT32(MQTT_OUTBOX_RAM_RECORDS, outbox.getCount());
+    TEST_ASSERT_EQUAL_UINT32(1, outbox.getDropped());
+
+    // The next full ring spills normally
+    outbox.push(makeRecord(MQTT_OUTBOX_RAM_RECORDS + 1));
+    TEST_ASSERT_TRUE(LittleFS.exists(MQTT_OUTBOX_SPILL_PATH));
+    drainInOrder(outbox, 1, MQTT_OUTBOX_RAM_RECORDS + 1, 16);
+}
+
+void test_clear_removes_spill() {
+    MQTTOutbox outbox;
+    outbox.begin(LittleFS);
+    for (uint32_t i = 0; i < MQTT_OUTBOX_RAM_RECORDS + 2; i++) {
+        outbox.push(makeRecord(i));
+    }
+    outbox.clear();
+    TEST_ASSERT_TRUE(outbox.isEmpty());
+    TEST_ASSERT_FALSE(LittleFS.exists(MQTT_OUTBOX_SPILL_PATH));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ram_ring_order);
+    RUN_TEST(test_ram_only_drops_oldest);
+    RUN_TEST(test_spill_keeps_order);
+    RUN_TEST(test_spill_survives_reboot);
+    RUN_TEST(test_spill_ignores_torn_record);
+    RUN_TEST(test_full_spill_drops_from_ram);
+    RUN_TEST(test_short_spill_write_pauses_spilling);
+    RUN_TEST(test_short_first_spill_abandons_file);
+    RUN_TEST(test_clear_removes_spill);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
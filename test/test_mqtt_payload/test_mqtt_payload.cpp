@@ -0,0 +1,216 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include <unity.h>
+#include <string>
+#include "MQTTManager.h"
+
+// Values with the longest %.9g form, so a batch fills the payload buffer
+static const float LONG_VALUES[] = {-3.40282347e+38f, -1.23456789e-05f, -1.17549435e-38f};
+
+static const char* const VALUE_FIELDS[] = {
+    "temperature_c", "orp_mv", "ph", "ec_ms_cm",
+    "tds_ppm", "co2_ppm", "nh3_ratio", "nh3_ppm", "max_do_mg_l", "stocking_density"
+};
+
+// Sample with every value set to value and every warning state critical
+SensorData makeData(float value) {
+    SensorData data;
+    memset(&data, 0, sizeof(data));
+    data.temp_c = value;
+    data.orp_mv = value;
+    data.ph = value;
+    data.ec_ms_cm = value;
+    data.tds_ppm = value;
+    data.co2_ppm = value;
+    data.nh3_ratio = value;
+    data.nh3_ppm = value;
+    data.max_do_mg_l = value;
+    data.stocking_density = value;
+    data.valid = true;
+    data.temp_state = 3;
+    data.ph_state = 3;
+    data.nh3_state = 3;
+    data.orp_state = 3;
+    data.ec_state = 3;
+    data.do_state = 3;
+    return data;
+}
+
+// Enable publishing in compact mode (combined JSON topic only) and connect
+void configure(MQTTManager& manager) {
+    TEST_ASSERT_TRUE(manager.begin());
+    manager.setOutboxStorage(LittleFS);
+    MQTTConfiguration config = manager.getMQTTConfig();
+    config.enabled = true;
+    strcpy(config.broker_host, "broker");
+    strcpy(config.device_id, "Tank");
+    config.discovery_enabled = false;
+    config.compact_mode = true;
+    config.publish_interval_ms = 5000;
+    TEST_ASSERT_TRUE(manager.saveMQTTConfig(config));
+    TEST_ASSERT_TRUE(manager.isConnected() || manager.connect());
+}
+
+// Payloads published on topics ending in suffix
+std::vector<PubSubMessage> publishedTo(const char* suffix) {
+    std::vector<PubSubMessage> messages;
+    size_t suffixLength = strlen(suffix);
+    for (const PubSubMessage& message : PubSubClient::published()) {
+        if (message.topic.size() >= suffixLength &&
+            message.topic.compare(message.topic.size() - suffixLength, suffixLength, suffix) == 0) {
+            messages.push_back(message);
+        }
+    }
+    return messages;
+}
+
+void setUp() {
+    LittleFS.begin(true);
+    LittleFS.format();
+    Preferences::eraseAll();
+    PubSubClient::setBrokerAvailable(true);
+    PubSubClient::published().clear();
+}
+
+void tearDown() {
+}
+
+// Test: The combined payload parses and carries every value at full float precision
+void test_combined_payload_is_valid_json() {
+    MQTTManager manager;
+    configure(manager);
+
+    SensorData data = makeData(0);
+    data.temp_c = 24.3750019f;
+    data.ph = 6.99999952f;
+    data.ec_ms_cm = -1.23456789e-05f;
+    data.stocking_density = 3.40282347e+38f;
+    shimAdvanceMillis(6000);
+    TEST_ASSERT_TRUE(manager.publishSensorData(data));
+
+    std::vector<PubSubMessage> sensors = publishedTo("/telemetry/sensors");
+    TEST_ASSERT_EQUAL(1, sensors.size());
+    TEST_ASSERT_TRUE(sensors[0].retained);
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, sensors[0].payload);
+    TEST_ASSERT_FALSE_MESSAGE(error, sensors[0].payload.c_str());
+    TEST_ASSERT_TRUE(doc["temperature_c"].as<float>() == data.temp_c);
+    TEST_ASSERT_TRUE(doc["ph"].as<float>() == data.ph);
+    TEST_ASSERT_TRUE(doc["ec_ms_cm"].as<float>() == data.ec_ms_cm);
+    TEST_ASSERT_TRUE(doc["stocking_density"].as<float>() == data.stocking_density);
+    TEST_ASSERT_EQUAL_INT(3, doc["do_state"].as<int>());
+    TEST_ASSERT_TRUE(doc["valid"].as<bool>());
+    TEST_ASSERT_FALSE(doc["timestamp"].isNull());
+}
+
+// Test: Values that are not finite are published as null, not as nan or inf
+void test_non_finite_values_become_null() {
+    MQTTManager manager;
+    configure(manager);
+
+    SensorData data = makeData(1.5f);
+    data.co2_ppm = NAN;
+    data.nh3_ppm = INFINITY;
+    data.max_do_mg_l = -INFINITY;
+    shimAdvanceMillis(6000);
+    TEST_ASSERT_TRUE(manager.publishSensorData(data));
+
+    std::vector<PubSubMessage> sensors = publishedTo("/telemetry/sensors");
+    TEST_ASSERT_EQUAL(1, sensors.size());
+    const std::string& payload = sensors[0].payload;
+    TEST_ASSERT_TRUE(payload.find("\"co2_ppm\":null") != std::string::npos);
+    TEST_ASSERT_TRUE(payload.find("\"nh3_ppm\":null") != std::string::npos);
+    TEST_ASSERT_TRUE(payload.find("\"max_do_mg_l\":null") != std::string::npos);
+    TEST_ASSERT_TRUE(payload.find("nan") == std::string::npos);
+    TEST_ASSERT_TRUE(payload.find("inf") == std::string::npos);
+
+    JsonDocument doc;
+    TEST_ASSERT_FALSE_MESSAGE(deserializeJson(doc, payload), payload.c_str());
+    TEST_ASSERT_TRUE(doc["co2_ppm"].isNull());
+    TEST_ASSERT_TRUE(doc["nh3_ppm"].isNull());
+    TEST_ASSERT_TRUE(doc["max_do_mg_l"].isNull());
+    TEST_ASSERT_TRUE(doc["tds_ppm"].as<float>() == 1.5f);
+}
+
+// Test: Backfill batches of the longest samples fill the buffer with whole samples only
+void test_backfill_batches_never_truncated() {
+    MQTTManager manager;
+    configure(manager);
+
+    // Queue samples while the broker is down
+    PubSubClient::setBrokerAvailable(false);
+    manager.disconnect();
+    const int queued = 24;
+    for (int i = 0; i < queued; i++) {
+        shimAdvanceMillis(5000);
+        manager.publishSensorData(makeData(LONG_VALUES[i % 3]));
+    }
+    TEST_ASSERT_EQUAL_UINT32(queued, manager.getBackfillPending());
+
+    // Reconnect and drain one batch per interval
+    PubSubClient::setBrokerAvailable(true);
+    for (int i = 0; i < 1000 && (manager.getBackfillPending() > 0 || !manager.isConnected()); i++) {
+        shimAdvanceMillis(MQTT_BACKFILL_INTERVAL_MS);
+        manager.loop();
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, manager.getBackfillPending());
+    TEST_ASSERT_EQUAL_UINT32(0, manager.getBackfillDropped());
+
+    std::vector<PubSubMessage> batches = publishedTo("/backfill");
+    TEST_ASSERT_GREATER_THAN(0, batches.size());
+    int samples = 0;
+    bool partialBatch = false;
+    for (const PubSubMessage& batch : batches) {
+        // Every accepted message fits the client buffer (header, topic and payload)
+        TEST_ASSERT_TRUE(7 + batch.topic.size() + batch.payload.size() <= MQTT_BUFFER_SIZE);
+        TEST_ASSERT_TRUE(batch.payload.size() < MQTT_BACKFILL_PAYLOAD_SIZE);
+        TEST_ASSERT_FALSE(batch.retained);
+
+        JsonDocument doc;
+        TEST_ASSERT_FALSE_MESSAGE(deserializeJson(doc, batch.payload), batch.payload.c_str());
+        JsonArray array = doc.as<JsonArray>();
+        TEST_ASSERT_GREATER_THAN(0, array.size());
+        partialBatch |= array.size() < MQTT_BACKFILL_BATCH_RECORDS;
+
+        // Every number reads back exactly as queued: none was cut short
+        for (size_t i = 0; i < array.size(); i++) {
+            JsonVariant sample = array[i];
+            TEST_ASSERT_FALSE(sample["time"].isNull());
+            float expected = LONG_VALUES[samples % 3];
+            for (const char* field : VALUE_FIELDS) {
+                TEST_ASSERT_TRUE(sample[field].as<float>() == expected);
+            }
+            TEST_ASSERT_EQUAL_INT(3, sample["do_state"].as<int>());
+            samples++;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(queued, samples);
+    TEST_ASSERT_TRUE(partialBatch);  // The buffer, not the record count, limited some batches
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_combined_payload_is_valid_json);
+    RUN_TEST(test_non_finite_values_become_null);
+    RUN_TEST(test_backfill_batches_never_truncated);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,166 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "POETSensor.h"
+#include "SimulatedSensorBackend.h"
+
+// millis() advance per update() call; the sampler never blocks, so this is the only clock
+#define STEP_MS 5
+
+// Simulated sensor whose reads can be made to fail for some channels
+class FlakyBackend : public SimulatedSensorBackend {
+public:
+    uint8_t failing = 0;  // CMD_* bits whose results never arrive
+
+    bool readMeasurement(uint8_t command, POETResult& out) override {
+        if (command & failing) {
+            return false;
+        }
+        return SimulatedSensorBackend::readMeasurement(command, out);
+    }
+};
+
+static FlakyBackend backend;
+
+/**
+ * Step the sampler with a controlled clock until it publishes
+ * @return The published sample (its updated bits name the converted channel)
+ */
+POETResult measureNext(POETSensor& sensor) {
+    POETResult sample;
+    memset(&sample, 0, sizeof(sample));
+    for (int i = 0; i < 10000; i++) {
+        shimAdvanceMillis(STEP_MS);
+        if (sensor.update()) {
+            sensor.getLatest(sample);
+            return sample;
+        }
+    }
+    TEST_FAIL_MESSAGE("Sampler did not publish");
+    return sample;
+}
+
+// Run the first round, in which every channel is converted once
+void measureAllChannels(POETSensor& sensor) {
+    for (int i = 0; i < POET_CHANNEL_COUNT; i++) {
+        measureNext(sensor);
+    }
+}
+
+void setUp() {
+    backend = FlakyBackend();
+    backend.setSeed(1);
+    backend.begin();
+}
+
+void tearDown() {
+}
+
+// Test: Channels never measured go first, one command per channel, in channel order
+void test_first_round_converts_each_channel() {
+    POETSensor sensor(backend);
+    TEST_ASSERT_EQUAL_UINT8(CMD_TEMPERATURE, measureNext(sensor).updated);
+    TEST_ASSERT_EQUAL_UINT8(CMD_ORP, measureNext(sensor).updated);
+    TEST_ASSERT_EQUAL_UINT8(CMD_PH, measureNext(sensor).updated);
+    POETResult sample = measureNext(sensor);
+    TEST_ASSERT_EQUAL_UINT8(CMD_EC, sample.updated);
+    TEST_ASSERT_TRUE(sample.valid);
+}
+
+// Test: After a pause the channel furthest past its period is converted first
+void test_most_overdue_channel_first() {
+    POETSensor sensor(backend);
+    sensor.setChannelInterval(POET_CH_TEMPERATURE, 5000);
+    measureAllChannels(sensor);
+
+    // pH is ~5 s late, temperature and EC ~1 s, ORP is not due
+    shimAdvanceMillis(6000);
+    TEST_ASSERT_EQUAL_UINT8(CMD_PH, measureNext(sensor).updated);
+    TEST_ASSERT_EQUAL_UINT8(CMD_TEMPERATURE, measureNext(sensor).updated);  // Commanded before EC in round one
+}
+
+// Test: pH and temperature keep their own periods while ORP waits for its 30 s slot
+void test_fast_channels_not_gated_by_orp() {
+    POETSensor sensor(backend);
+    measureAllChannels(sensor);
+
+    int conversions[POET_CHANNEL_COUNT] = {};
+    unsigned long started = millis();
+    while (millis() - started < 20000) {
+        POETResult sample = measureNext(sensor);
+        for (int ch = 0; ch < POET_CHANNEL_COUNT; ch++) {
+            if (sample.updated & (1 << ch)) {
+                conversions[ch]++;
+            }
+        }
+        TEST_ASSERT_TRUE(sample.valid);
+        // Worst case a pH conversion waits for one other conversion after its period
+        TEST_ASSERT_TRUE(POETSensor::getChannelAge(sample, POET_CH_PH) <=
+                         POET_PH_INTERVAL_MS + 2UL * POETSensor::getConversionTime(CMD_PH));
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, conversions[POET_CH_ORP]);
+    TEST_ASSERT_TRUE(conversions[POET_CH_PH] >= 15);
+    TEST_ASSERT_TRUE(conversions[POET_CH_TEMPERATURE] >= 8);
+    TEST_ASSERT_TRUE(conversions[POET_CH_EC] >= 3);
+}
+
+// Test: A sample turns invalid once a channel is older than its stale limit, not before
+void test_stale_channel_invalidates_sample() {
+    POETSensor sensor(backend);
+    measureAllChannels(sensor);
+
+    // EC results stop arriving; the other channels keep refreshing
+    backend.failing = CMD_EC;
+    unsigned long maxAge = POET_EC_INTERVAL_MS * POET_STALE_PERIODS + DELAY_ALL_TOTAL;
+    unsigned long oldestValid = 0;
+    bool invalid = false;
+    while (!invalid) {
+        POETResult sample = measureNext(sensor);
+        unsigned long age = POETSensor::getChannelAge(sample, POET_CH_EC);
+        TEST_ASSERT_TRUE(age < maxAge + 2 * DELAY_ALL_TOTAL);  // Invalid soon after the limit
+        if (sample.valid) {
+            TEST_ASSERT_TRUE(age <= maxAge + 1);
+            oldestValid = age;
+        } else {
+            TEST_ASSERT_TRUE(age > maxAge);
+            invalid = true;
+        }
+    }
+
+    // Valid samples were still published well past one EC period
+    TEST_ASSERT_TRUE(oldestValid > maxAge - DELAY_ALL_TOTAL);
+
+    // The next EC reading makes samples valid again
+    backend.failing = 0;
+    POETResult sample;
+    do {
+        sample = measureNext(sensor);
+    } while (!(sample.updated & CMD_EC));
+    TEST_ASSERT_TRUE(sample.valid);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_first_round_converts_each_channel);
+    RUN_TEST(test_most_overdue_channel_first);
+    RUN_TEST(test_fast_channels_not_gated_by_orp);
+    RUN_TEST(test_stale_channel_invalidates_sample);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
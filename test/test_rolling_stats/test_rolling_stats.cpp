@@ -0,0 +1,165 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <math.h>
+#include "RollingStats.h"
+
+// Midnight, so every window slot is aligned
+static const uint32_t T0 = HISTORY_TIME_VALID_MIN + 86400;
+
+static RollingStats stats;
+static RollingStatsSnapshot snapshot;
+
+// Single stored reading, as TieredHistory folds it into the rollups
+HistoryRow makeRow(uint32_t timestamp, float temp_c, float ph) {
+    HistoryRow row;
+    row.timestamp = timestamp;
+    row.samples = 1;
+    row.flags = HISTORY_FLAG_VALID;
+    const float values[HISTORY_CHANNEL_COUNT] = { temp_c, 250.0, ph, 0.4 };
+    for (int ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        int16_t encoded = HistoryStore::encodeChannel((HistoryChannel)ch, values[ch]);
+        row.mean[ch] = row.min[ch] = row.max[ch] = encoded;
+    }
+    return row;
+}
+
+const RollingStatsValue& value(int window, HistoryChannel channel) {
+    return snapshot.values[window][channel];
+}
+
+void setUp() {
+    stats.clear();
+}
+
+void tearDown() {
+}
+
+// Test: Mean and standard deviation match a direct computation over the window
+void test_mean_and_stddev() {
+    double sum = 0;
+    double squares = 0;
+    for (int i = 0; i < 600; i++) {
+        float temp = 24.0 + (i % 17) * 0.1;
+        stats.add(makeRow(T0 + i * 5, temp, 7.2));
+        float stored = HistoryStore::decodeChannel(HISTORY_CH_TEMP, HistoryStore::encodeChannel(HISTORY_CH_TEMP, temp));
+        sum += stored;
+        squares += (double)stored * stored;
+    }
+    stats.get(snapshot);
+
+    double mean = sum / 600;
+    double stddev = sqrt(squares / 600 - mean * mean);
+    for (int w = 0; w < ROLLING_STATS_WINDOW_COUNT; w++) {
+        TEST_ASSERT_EQUAL_UINT32(600, value(w, HISTORY_CH_TEMP).count);
+        TEST_ASSERT_FLOAT_WITHIN(0.001, mean, value(w, HISTORY_CH_TEMP).mean);
+        TEST_ASSERT_FLOAT_WITHIN(0.001, stddev, value(w, HISTORY_CH_TEMP).stddev);
+        TEST_ASSERT_FLOAT_WITHIN(0.001, 24.0, value(w, HISTORY_CH_TEMP).min);
+        TEST_ASSERT_FLOAT_WITHIN(0.001, 25.6, value(w, HISTORY_CH_TEMP).max);
+        TEST_ASSERT_FLOAT_WITHIN(0.0001, 0, value(w, HISTORY_CH_PH).stddev);
+    }
+    TEST_ASSERT_EQUAL_UINT32(T0 + 599 * 5, snapshot.updated);
+}
+
+// Test: Old slots leave the short window (totals and min/max deques) but stay in the longer ones
+void test_window_slides() {
+    stats.add(makeRow(T0, 30.0, 7.2));             // Spike in the first 5-minute slot
+    stats.add(makeRow(T0 + 60, 20.0, 7.2));        // Dip in the same slot
+    for (int i = 1; i <= 24; i++) {
+        stats.add(makeRow(T0 + i * 300, 25.0 + (i % 2) * 0.5, 7.2));
+    }
+    stats.get(snapshot);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 20.0, value(ROLLING_STATS_24H, HISTORY_CH_TEMP).min);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 30.0, value(ROLLING_STATS_24H, HISTORY_CH_TEMP).max);
+    TEST_ASSERT_EQUAL_UINT32(26, value(ROLLING_STATS_24H, HISTORY_CH_TEMP).count);
+
+    // 1 h window: 12 slots of 5 minutes, the newest open
+    const RollingStatsValue& hour = value(ROLLING_STATS_1H, HISTORY_CH_TEMP);
+    TEST_ASSERT_EQUAL_UINT32(12, hour.count);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 25.0, hour.min);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 25.5, hour.max);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 25.25, hour.mean);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.25, hour.stddev);
+
+    // A jump past the whole window leaves only the new reading
+    stats.add(makeRow(T0 + 86400 * 2, 22.0, 7.2));
+    stats.get(snapshot);
+    TEST_ASSERT_EQUAL_UINT32(1, value(ROLLING_STATS_1H, HISTORY_CH_TEMP).count);
+    TEST_ASSERT_EQUAL_UINT32(1, value(ROLLING_STATS_24H, HISTORY_CH_TEMP).count);
+    TEST_ASSERT_EQUAL_UINT32(27, value(ROLLING_STATS_7D, HISTORY_CH_TEMP).count);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 20.0, value(ROLLING_STATS_7D, HISTORY_CH_TEMP).min);
+}
+
+// Test: Missing readings and gaps are skipped, last change reported per window
+void test_gaps_and_last_change() {
+    HistoryRow gap = makeRow(T0, 25.0, 7.2);
+    gap.samples = 0;
+    stats.add(gap);
+    stats.get(snapshot);
+    TEST_ASSERT_EQUAL_UINT32(0, snapshot.updated);
+    TEST_ASSERT_TRUE(isnan(value(ROLLING_STATS_1H, HISTORY_CH_TEMP).mean));
+
+    stats.add(makeRow(T0, 25.0, 7.2));
+    stats.add(makeRow(T0 + 5, 25.0, NAN));
+    stats.add(makeRow(T0 + 10, 25.0, 7.3));
+    for (int i = 1; i <= 30; i++) {
+        stats.add(makeRow(T0 + 10 + i * 300, 25.0, 7.3));
+    }
+    stats.get(snapshot);
+
+    TEST_ASSERT_EQUAL_UINT32(32, value(ROLLING_STATS_24H, HISTORY_CH_PH).count);
+    TEST_ASSERT_EQUAL_UINT32(33, value(ROLLING_STATS_24H, HISTORY_CH_TEMP).count);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 10, value(ROLLING_STATS_24H, HISTORY_CH_PH).lastChange);
+    TEST_ASSERT_EQUAL_UINT32(T0, value(ROLLING_STATS_24H, HISTORY_CH_TEMP).lastChange);
+    TEST_ASSERT_EQUAL_UINT32(0, value(ROLLING_STATS_1H, HISTORY_CH_PH).lastChange);  // Over an hour ago
+}
+
+// Test: Restoring from the rollup tiers keeps counts, means and extremes
+void test_restore_from_tiers() {
+    static TieredHistory history;
+    history.clear();
+    for (int i = 0; i < 2000; i++) {
+        DataPoint dp;
+        memset(&dp, 0, sizeof(dp));
+        dp.timestamp = T0 + i * 5;
+        dp.temp_c = i == 1000 ? 28.0 : 25.0;
+        dp.orp_mv = 250.0;
+        dp.ph = 7.2;
+        dp.ec_ms_cm = 0.4;
+        dp.valid = true;
+        history.add(dp);
+    }
+
+    TEST_ASSERT_TRUE(stats.restore(history) > 0);
+    stats.get(snapshot);
+    const RollingStatsValue& day = value(ROLLING_STATS_24H, HISTORY_CH_TEMP);
+    TEST_ASSERT_EQUAL_UINT32(2000, day.count);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 28.0, day.max);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 25.0, day.min);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 25.0 + 3.0 / 2000, day.mean);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_mean_and_stddev);
+    RUN_TEST(test_window_slides);
+    RUN_TEST(test_gaps_and_last_change);
+    RUN_TEST(test_restore_from_tiers);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
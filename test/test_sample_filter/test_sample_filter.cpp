@@ -0,0 +1,169 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "SampleFilter.h"
+#include "POETSensor.h"
+
+// Feed the same raw value several times
+void feed(SampleFilter& filter, int32_t raw, int times) {
+    for (int i = 0; i < times; i++) {
+        filter.add(raw);
+    }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// Test: A single sample far from the output is dropped and the ring is left alone
+void test_single_outlier_rejected() {
+    SampleFilter filter;
+    filter.configure(5, 50);
+    filter.add(1000);
+    filter.add(1010);
+    filter.add(990);
+    TEST_ASSERT_EQUAL_INT32(1000, filter.value());
+
+    TEST_ASSERT_EQUAL_INT32(1000, filter.add(5000));  // 4000 > 4 noise floors
+    TEST_ASSERT_EQUAL_UINT8(3, filter.getCount());
+    TEST_ASSERT_EQUAL_UINT32(1, filter.getRejectedCount());
+
+    // Within the band: accepted as usual
+    TEST_ASSERT_EQUAL_INT32(1005, filter.add(1020));
+    TEST_ASSERT_EQUAL_UINT8(4, filter.getCount());
+    TEST_ASSERT_EQUAL_UINT32(1, filter.getRejectedCount());
+}
+
+// Test: Spike rejection waits for a settled output (more than half a window)
+void test_rejection_needs_settled_output() {
+    SampleFilter filter;
+    filter.configure(5, 50);
+    filter.add(1000);
+    TEST_ASSERT_EQUAL_INT32(3000, filter.add(5000));
+    TEST_ASSERT_EQUAL_INT32(5000, filter.add(5000));
+    TEST_ASSERT_EQUAL_UINT32(0, filter.getRejectedCount());
+}
+
+// Test: A deviation that persists is accepted on its third sample and restarts the ring
+void test_persistent_step_accepted() {
+    SampleFilter filter;
+    filter.configure(5, 50);
+    feed(filter, 1000, 5);
+
+    TEST_ASSERT_EQUAL_INT32(1000, filter.add(2000));
+    TEST_ASSERT_EQUAL_INT32(1000, filter.add(2000));
+    TEST_ASSERT_EQUAL_INT32(2000, filter.add(2000));
+    TEST_ASSERT_EQUAL_UINT8(1, filter.getCount());
+    TEST_ASSERT_EQUAL_UINT32(3, filter.getRejectedCount());
+
+    // The new level fills a fresh ring; the old samples no longer pull the median back
+    TEST_ASSERT_EQUAL_INT32(2005, filter.add(2010));
+    TEST_ASSERT_EQUAL_UINT8(2, filter.getCount());
+    TEST_ASSERT_EQUAL_UINT32(3, filter.getRejectedCount());
+}
+
+// Test: The median of an even count averages the middle pair and truncates toward zero
+void test_median_negative_values() {
+    SampleFilter filter;
+    filter.configure(4, 0);
+    TEST_ASSERT_EQUAL_INT32(-3, filter.add(-3));
+    TEST_ASSERT_EQUAL_INT32(-4, filter.add(-6));    // -4.5
+    TEST_ASSERT_EQUAL_INT32(-6, filter.add(-100));  // Odd count: middle sample
+    TEST_ASSERT_EQUAL_INT32(-4, filter.add(50));    // -6, -3 -> -4.5
+
+    filter.configure(4, 0);
+    feed(filter, -30, 1);
+    feed(filter, -21, 1);
+    TEST_ASSERT_EQUAL_INT32(-25, filter.value());   // -25.5
+}
+
+// Test: The trimmed mean drops min and max and rounds half away from zero
+void test_trimmed_mean_negative_values() {
+    SampleFilter filter;
+    filter.configure(5, 0, 0, FILTER_TRIMMED_MEAN);
+    filter.add(-100);
+    TEST_ASSERT_EQUAL_INT32(-50, filter.add(-1));    // Two samples: median, -50.5 truncated
+    filter.add(-2);
+    TEST_ASSERT_EQUAL_INT32(-2, filter.add(50));     // Mean of -2, -1 is -1.5
+    TEST_ASSERT_EQUAL_INT32(-2, filter.add(-4));     // Mean of -4, -2, -1 is -2.33
+
+    filter.configure(5, 0, 0, FILTER_TRIMMED_MEAN);
+    filter.add(100);
+    filter.add(1);
+    filter.add(2);
+    TEST_ASSERT_EQUAL_INT32(2, filter.add(-50));     // Mean of 1, 2 is 1.5
+}
+
+// Test: The EC relative floor widens the band in proportion to the output
+void test_relative_floor_scales_with_output() {
+    // 100 µA: the floor is 2% of the output (2000 nA), spikes start beyond 8000 nA
+    SampleFilter high;
+    high.configure(POET_FILTER_WINDOW_SLOW, POET_NOISE_EC_nA, POET_NOISE_EC_PERMILLE);
+    feed(high, 100000, 3);
+    high.add(107000);
+    TEST_ASSERT_EQUAL_UINT32(0, high.getRejectedCount());
+    high.add(109000);
+    TEST_ASSERT_EQUAL_UINT32(1, high.getRejectedCount());
+
+    // 1 µA: 2% is below the absolute floor, which takes over (spikes beyond 200 nA)
+    SampleFilter low;
+    low.configure(POET_FILTER_WINDOW_SLOW, POET_NOISE_EC_nA, POET_NOISE_EC_PERMILLE);
+    feed(low, 1000, 3);
+    low.add(1150);
+    TEST_ASSERT_EQUAL_UINT32(0, low.getRejectedCount());
+    low.add(1300);
+    TEST_ASSERT_EQUAL_UINT32(1, low.getRejectedCount());
+
+    // Negative outputs use their magnitude
+    SampleFilter negative;
+    negative.configure(POET_FILTER_WINDOW_SLOW, POET_NOISE_EC_nA, POET_NOISE_EC_PERMILLE);
+    feed(negative, -100000, 3);
+    negative.add(-107000);
+    TEST_ASSERT_EQUAL_UINT32(0, negative.getRejectedCount());
+    negative.add(-109000);
+    TEST_ASSERT_EQUAL_UINT32(1, negative.getRejectedCount());
+}
+
+// Test: A noise floor of 0 turns spike rejection off
+void test_zero_noise_floor_disables_rejection() {
+    SampleFilter filter;
+    filter.configure(1, 0);
+    filter.add(10);
+    TEST_ASSERT_EQUAL_INT32(1000000, filter.add(1000000));
+
+    filter.configure(3, 0);
+    feed(filter, 0, 3);
+    feed(filter, 1000000, 2);
+    TEST_ASSERT_EQUAL_INT32(1000000, filter.value());
+    TEST_ASSERT_EQUAL_UINT32(0, filter.getRejectedCount());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_single_outlier_rejected);
+    RUN_TEST(test_rejection_needs_settled_output);
+    RUN_TEST(test_persistent_step_accepted);
+    RUN_TEST(test_median_negative_values);
+    RUN_TEST(test_trimmed_mean_negative_values);
+    RUN_TEST(test_relative_floor_scales_with_output);
+    RUN_TEST(test_zero_noise_floor_disables_rejection);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,192 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <stdio.h>
+#include <string>
+#include "SimulatedSensorBackend.h"
+#include "CalibrationManager.h"
+#include "HistoryExport.h"
+
+// Replay file written by the tests (host path, removed after each test)
+static const char* CSV_PATH = "test_simulated_backend.csv";
+
+static HistoryStore store;
+
+DataPoint makePoint(time_t timestamp, float temp_c, float orp_mv, float ph, float ec_ms_cm) {
+    DataPoint dp;
+    memset(&dp, 0, sizeof(dp));
+    dp.timestamp = timestamp;
+    dp.temp_c = temp_c;
+    dp.orp_mv = orp_mv;
+    dp.ph = ph;
+    dp.ec_ms_cm = ec_ms_cm;
+    dp.valid = true;
+    return dp;
+}
+
+// Export the store with the same stream as /api/export/csv and write it to CSV_PATH
+void writeExport() {
+    HistoryCsvStream stream(store, "# Aquarium Sensor Data Export\r\n# Device: test\r\n");
+    std::string csv;
+    uint8_t buffer[256];
+    size_t bytes;
+    while ((bytes = stream.read(buffer, sizeof(buffer))) > 0) {
+        csv.append((const char*)buffer, bytes);
+    }
+
+    FILE* file = fopen(CSV_PATH, "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fwrite(csv.data(), 1, csv.size(), file);
+    fclose(file);
+}
+
+// Simulator profile without drift, so readings only depend on the seed
+SimulatedProfile steadyProfile() {
+    SimulatedProfile profile = SimulatedSensorBackend::getDefaultProfile();
+    profile.temp_drift_per_hr = 0;
+    profile.ph_drift_per_hr = 0;
+    profile.orp_drift_per_hr = 0;
+    profile.ec_drift_per_hr = 0;
+    profile.ph_spike_every = 7;
+    return profile;
+}
+
+void setUp() {
+    store.clear();
+}
+
+void tearDown() {
+    remove(CSV_PATH);
+}
+
+// Test: An export replays to raw values that the uncalibrated conversions turn back into the exported values
+void test_replay_round_trips_export() {
+    store.add(makePoint(1704067200, 24.37, 251.5, 6.84, 0.452));
+    store.add(makePoint(1704067205, 26.05, 310.0, 7.91, 1.250));
+    writeExport();
+
+    SimulatedSensorBackend backend;
+    TEST_ASSERT_TRUE(backend.loadCSV(CSV_PATH, false));
+    TEST_ASSERT_EQUAL(2, backend.getRowCount());
+    TEST_ASSERT_TRUE(backend.begin());
+
+    // Raw POET units: m°C, µV, Ugs µV at 52 mV/pH around pH 7, nA at 1 V excitation
+    POETResult raw;
+    memset(&raw, 0, sizeof(raw));
+    TEST_ASSERT_TRUE(backend.readMeasurement(CMD_ALL, raw));
+    TEST_ASSERT_EQUAL_INT32(24370, raw.temp_mC);
+    TEST_ASSERT_EQUAL_INT32(251500, raw.orp_uV);
+    TEST_ASSERT_EQUAL_INT32(-8320, raw.ugs_uV);
+    TEST_ASSERT_EQUAL_INT32(452, raw.ec_nA);
+    TEST_ASSERT_EQUAL_INT32(SIM_EC_EXCITATION_uV, raw.ec_uV);
+
+    // Back through the CalibrationManager defaults (pH 7.0 at 0 mV, 52 mV/pH, 1 /cm)
+    CalibrationManager calibration;
+    TEST_ASSERT_FALSE(calibration.hasValidPHCalibration());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 6.84, calibration.calculatePH(raw.ugs_uV / 1000.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.0005, 0.452, calibration.calculateEC(raw.ec_nA, raw.ec_uV));
+
+    TEST_ASSERT_TRUE(backend.readMeasurement(CMD_ALL, raw));
+    TEST_ASSERT_EQUAL_INT32(26050, raw.temp_mC);
+    TEST_ASSERT_EQUAL_INT32(310000, raw.orp_uV);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 7.91, calibration.calculatePH(raw.ugs_uV / 1000.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.0005, 1.25, calibration.calculateEC(raw.ec_nA, raw.ec_uV));
+
+    // Replay without looping ends after the last row
+    TEST_ASSERT_FALSE(backend.readMeasurement(CMD_ALL, raw));
+}
+
+// Test: Each channel walks the rows on its own and a looping replay wraps around
+void test_replay_channels_advance_independently() {
+    store.add(makePoint(1704067200, 20.0, 200.0, 7.0, 0.5));
+    store.add(makePoint(1704067205, 21.0, 210.0, 7.5, 0.6));
+    writeExport();
+
+    SimulatedSensorBackend backend;
+    TEST_ASSERT_TRUE(backend.loadCSV(CSV_PATH));
+    backend.begin();
+
+    POETResult raw;
+    memset(&raw, 0, sizeof(raw));
+    backend.readMeasurement(CMD_PH, raw);
+    TEST_ASSERT_EQUAL_INT32(0, raw.ugs_uV);
+    backend.readMeasurement(CMD_PH, raw);
+    TEST_ASSERT_EQUAL_INT32(26000, raw.ugs_uV);
+    backend.readMeasurement(CMD_PH, raw);
+    TEST_ASSERT_EQUAL_INT32(0, raw.ugs_uV);  // Wrapped to the first row
+
+    backend.readMeasurement(CMD_TEMPERATURE, raw);
+    TEST_ASSERT_EQUAL_INT32(20000, raw.temp_mC);  // Temperature still at its first row
+}
+
+// Test: A file without the export columns is refused
+void test_rejects_foreign_csv() {
+    FILE* file = fopen(CSV_PATH, "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs("time,value\r\n1,2\r\n", file);
+    fclose(file);
+
+    SimulatedSensorBackend backend;
+    TEST_ASSERT_FALSE(backend.loadCSV(CSV_PATH));
+    TEST_ASSERT_EQUAL(0, backend.getRowCount());
+}
+
+// Test: The same seed gives the same synthetic readings, another seed does not
+void test_same_seed_same_output() {
+    SimulatedSensorBackend first;
+    SimulatedSensorBackend second;
+    SimulatedSensorBackend other;
+    first.setProfile(steadyProfile());
+    second.setProfile(steadyProfile());
+    other.setProfile(steadyProfile());
+    first.setSeed(42);
+    second.setSeed(42);
+    other.setSeed(43);
+    first.begin();
+    second.begin();
+    other.begin();
+
+    bool differs = false;
+    for (int i = 0; i < 50; i++) {
+        POETResult a, b, c;
+        memset(&a, 0, sizeof(a));
+        memset(&b, 0, sizeof(b));
+        memset(&c, 0, sizeof(c));
+        TEST_ASSERT_TRUE(first.readMeasurement(CMD_ALL, a));
+        TEST_ASSERT_TRUE(second.readMeasurement(CMD_ALL, b));
+        TEST_ASSERT_TRUE(other.readMeasurement(CMD_ALL, c));
+
+        TEST_ASSERT_EQUAL_INT32(a.temp_mC, b.temp_mC);
+        TEST_ASSERT_EQUAL_INT32(a.orp_uV, b.orp_uV);
+        TEST_ASSERT_EQUAL_INT32(a.ugs_uV, b.ugs_uV);
+        TEST_ASSERT_EQUAL_INT32(a.ec_nA, b.ec_nA);
+        TEST_ASSERT_EQUAL_INT32(a.ec_uV, b.ec_uV);
+        differs |= a.temp_mC != c.temp_mC || a.ugs_uV != c.ugs_uV || a.orp_uV != c.orp_uV;
+    }
+    TEST_ASSERT_TRUE(differs);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_replay_round_trips_export);
+    RUN_TEST(test_replay_channels_advance_independently);
+    RUN_TEST(test_rejects_foreign_csv);
+    RUN_TEST(test_same_seed_same_output);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial
+    runUnityTests();
+}
+
+void loop() {
+    // Tests run once in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif